@@ -0,0 +1,323 @@
+# -*- coding: utf-8 -*-
+import os
+import sys
+import random
+import time
+import math
+import json
+
+#lrc编译器可执行文件名
+LRC_EXE_FILE='./lrc'
+
+#存放生成的测试程序的目录
+BENCHMARK_DIR='./benchmark_output'
+
+#比较语法分析表的速度的命令参数
+BENCHMARK_PARSER_TABLE_FLAG='-bench-parser-table'
+
+#测试语法分析速度的命令参数
+BENCHMARK_PARSER_FLAG='-bench-parser'
+
+#比较词法分析器读取方式的速度的命令参数
+BENCHMARK_LEXICAL_ANALYZER_FLAG='-bench-lexer'
+
+#统计编译各个阶段的耗时的命令参数
+TIME_REPORT_FLAG='-ftime-report'
+
+#编译统计报告的文件后缀
+TIME_REPORT_FILE_SUFFIX='.time.json'
+
+#吞吐量测试结果的文件
+THROUGHPUT_REPORT_FILE=os.path.join(BENCHMARK_DIR,'throughput.json')
+
+#规模每扩大一倍，耗时的增长超过这个幂次就认为是超线性的
+SUPER_LINEAR_EXPONENT=1.3
+
+#只有耗时超过这个值(ms)的阶段才检查是否超线性，避免计时误差
+SUPER_LINEAR_MIN_MS=2.0
+
+#每个程序编译的次数，各个阶段取最短的耗时，减少计时的波动
+THROUGHPUT_ROUNDS=3
+
+#耗时和源程序无关的阶段(建立语法制导翻译器)，不检查是否超线性
+FIXED_COST_STAGES=['translator init','grammer load','parser table load','LR(1) table build','parser table pack']
+
+#耗时和源程序的字节数(而不是token个数)成正比的阶段
+BYTE_BOUND_STAGES=['pre process','lexical analysis']
+
+#生成一个随机的算术表达式
+def generate_exp(rand,vars_name,depth):
+    if depth==0 or rand.random()<0.3:
+        if rand.random()<0.5:
+            return rand.choice(vars_name)
+        return str(rand.randint(0,100))
+    op=rand.choice(['+','-','*','/','%'])
+    right=generate_exp(rand,vars_name,depth-1)
+    if op=='/' or op=='%':
+        right='('+right+' * 0 + '+str(rand.randint(1,9))+')'
+    return '('+generate_exp(rand,vars_name,depth-1)+' '+op+' '+right+')'
+
+#生成一个函数，函数中包含stmt_num组语句
+def generate_func(rand,func_name,stmt_num):
+    vars_name=['a','b','x','y']
+    lines=[]
+    lines.append('int '+func_name+'(int a, int b) {')
+    lines.append('    int x = a + 1, y = b;')
+    lines.append('    int arr[8];')
+    lines.append('    int i = 0;')
+    for _ in range(stmt_num):
+        kind=rand.randint(0,2)
+        if kind==0:
+            lines.append('    '+rand.choice(['x','y'])+' = '+generate_exp(rand,vars_name,3)+';')
+        elif kind==1:
+            lines.append('    i = 0;')
+            lines.append('    while (i < 8) {')
+            lines.append('        arr[i] = '+generate_exp(rand,vars_name+['i'],2)+';')
+            lines.append('        i = i + 1;')
+            lines.append('    }')
+        else:
+            lines.append('    if ('+generate_exp(rand,vars_name,1)+' > '+generate_exp(rand,vars_name,1)+') {')
+            lines.append('        x = x - arr['+str(rand.randint(0,7))+'];')
+            lines.append('    } else {')
+            lines.append('        y = y + '+generate_exp(rand,vars_name,2)+';')
+            lines.append('    }')
+    lines.append('    return x + y;')
+    lines.append('}')
+    return '\n'.join(lines)
+
+#生成一个包含func_num个函数，每个函数包含stmt_num组语句的SysY程序
+def generate_sysy(func_num,stmt_num,seed=0):
+    rand=random.Random(seed)
+    funcs=[]
+    for i in range(func_num):
+        funcs.append(generate_func(rand,'func_'+str(i),stmt_num))
+    lines=['int main() {','    int sum = 0;']
+    for i in range(func_num):
+        lines.append('    sum = sum + func_'+str(i)+'(sum, '+str(i)+');')
+    lines.append('    putint(sum);')
+    lines.append('    return 0;')
+    lines.append('}')
+    funcs.append('\n'.join(lines))
+    return '\n\n'.join(funcs)+'\n'
+
+#生成一个深度为depth的嵌套表达式的程序
+def generate_deep_expression(depth,seed=0):
+    rand=random.Random(seed)
+    exp='a'
+    for _ in range(depth):
+        exp='('+exp+' '+rand.choice(['+','-','*'])+' '+str(rand.randint(1,9))+')'
+    return 'int main() {\n    int a = getint();\n    int x = '+exp+';\n    putint(x);\n    return 0;\n}\n'
+
+#生成一个包含func_num个函数的程序
+def generate_many_functions(func_num,seed=0):
+    return generate_sysy(func_num,2,seed)
+
+#生成一个全局常量数组和一个局部常量数组的初始值都有size个元素的程序
+def generate_const_array(size,seed=0):
+    rand=random.Random(seed)
+    global_values=', '.join(str(rand.randint(0,1000)) for _ in range(size))
+    local_values=', '.join(str(rand.randint(0,1000)) for _ in range(size))
+    lines=['const int g_table['+str(size)+'] = {'+global_values+'};']
+    lines.append('int main() {')
+    lines.append('    const int l_table['+str(size)+'] = {'+local_values+'};')
+    lines.append('    int i = 0, sum = 0;')
+    lines.append('    while (i < '+str(size)+') {')
+    lines.append('        sum = sum + g_table[i] * l_table[i];')
+    lines.append('        i = i + 1;')
+    lines.append('    }')
+    lines.append('    putint(sum);')
+    lines.append('    return 0;')
+    lines.append('}')
+    return '\n'.join(lines)+'\n'
+
+#生成一个只有一个基本块，其中包含stmt_num条语句的程序
+def generate_straight_line(stmt_num,seed=0):
+    rand=random.Random(seed)
+    vars_name=['a','b','c','d','e','f','g','h']
+    lines=['int main() {']
+    lines.append('    int '+', '.join(i+' = '+str(rand.randint(0,100)) for i in vars_name)+';')
+    for _ in range(stmt_num):
+        lines.append('    '+rand.choice(vars_name)+' = '+generate_exp(rand,vars_name,2)+';')
+    lines.append('    putint('+' + '.join(vars_name)+');')
+    lines.append('    return 0;')
+    lines.append('}')
+    return '\n'.join(lines)+'\n'
+
+#生成一个嵌套了depth层循环的程序
+def generate_loop_nest(depth,seed=0):
+    lines=['int main() {']
+    lines.append('    int sum = 0;')
+    for i in range(depth):
+        indent='    '*(i+1)
+        lines.append(indent+'int i'+str(i)+' = 0;')
+        lines.append(indent+'while (i'+str(i)+' < 2) {')
+    lines.append('    '*(depth+1)+'sum = sum + '+(' + '.join('i'+str(i) for i in range(depth)) if depth else '1')+';')
+    for i in reversed(range(depth)):
+        indent='    '*(i+1)
+        lines.append(indent+'    i'+str(i)+' = i'+str(i)+' + 1;')
+        lines.append(indent+'}')
+    lines.append('    putint(sum);')
+    lines.append('    return 0;')
+    lines.append('}')
+    return '\n'.join(lines)+'\n'
+
+#生成一个用带参数的宏展开出kernel_num个循环展开的函数的程序
+#每个函数都由同样的宏展开而来，预处理之后的程序的长度和kernel_num成正比
+def generate_macro_kernels(kernel_num,seed=0):
+    lines=['#define N 16']
+    lines.append('#define ZERO() (N-N)')
+    lines.append('#define CAT(a,b) a##b')
+    lines.append('#define AT(a,i) a[(i)]')
+    lines.append('#define MAC(acc,a,b,i) acc = acc + AT(a,i) * AT(b,i);')
+    lines.append('#define UNROLL2(acc,a,b,i) MAC(acc,a,b,i) MAC(acc,a,b,(i)+1)')
+    lines.append('#define UNROLL4(acc,a,b,i) UNROLL2(acc,a,b,i) UNROLL2(acc,a,b,(i)+2)')
+    lines.append('#define UNROLL8(acc,a,b,i) UNROLL4(acc,a,b,i) UNROLL4(acc,a,b,(i)+4)')
+    lines.append('#define UNROLL16(acc,a,b,i) UNROLL8(acc,a,b,i) UNROLL8(acc,a,b,(i)+8)')
+    lines.append('#define KERNEL(k,prev) int CAT(kernel_,k)(int a[], int b[]) { int acc = ZERO(); UNROLL16(acc,a,b,0) return acc + prev; }')
+    lines.append('KERNEL(0,0)')
+    for i in range(1,kernel_num):
+        lines.append('KERNEL('+str(i)+',CAT(kernel_,'+str(i-1)+')(a,b))')
+    lines.append('int main() {')
+    lines.append('    int a[N], b[N], i = 0;')
+    lines.append('    while (i < N) { a[i] = i; b[i] = N - i; i = i + 1; }')
+    lines.append('    putint(CAT(kernel_,'+str(kernel_num-1)+')(a,b));')
+    lines.append('    return 0;')
+    lines.append('}')
+    return '\n'.join(lines)+'\n'
+
+#吞吐量测试的程序种类：(种类名,生成程序的函数,从小到大的规模)
+#每一种程序的规模都是按照两倍增长的，这样可以直接看出耗时是否随规模超线性增长
+THROUGHPUT_KINDS=[
+    ('deep_expression',generate_deep_expression,[250,500,1000,2000]),
+    ('many_functions',generate_many_functions,[100,200,400,800]),
+    ('const_array',generate_const_array,[2500,5000,10000,20000]),
+    ('straight_line',generate_straight_line,[1000,2000,4000,8000]),
+    ('loop_nest',generate_loop_nest,[25,50,100,200]),
+    ('macro_kernels',generate_macro_kernels,[100,200,400,800]),
+]
+
+#把程序写到文件中，并返回文件名
+def write_sysy_file(file_name,source):
+    if not os.path.exists(BENCHMARK_DIR):
+        os.makedirs(BENCHMARK_DIR)
+    source_file=os.path.join(BENCHMARK_DIR,file_name+'.sy')
+    with open(source_file,'w') as f:
+        f.write(source)
+    return source_file
+
+#生成一个程序写到文件中，并返回文件名
+def generate_sysy_file(file_name,func_num,stmt_num,seed=0):
+    return write_sysy_file(file_name,generate_sysy(func_num,stmt_num,seed))
+
+#比较使用压缩前后的语法分析表进行语法分析的速度
+def benchmark_parser_table(func_num,stmt_num):
+    source_file=generate_sysy_file('parser_table',func_num,stmt_num)
+    return os.system(LRC_EXE_FILE+' '+BENCHMARK_PARSER_TABLE_FLAG+' '+source_file)==0
+
+#比较语法分析栈改成vector前后的语法分析速度
+def benchmark_parser(func_num,stmt_num):
+    source_file=generate_sysy_file('parser',func_num,stmt_num)
+    return os.system(LRC_EXE_FILE+' '+BENCHMARK_PARSER_FLAG+' '+source_file)==0
+
+#比较词法分析器使用双缓冲区和一次性读入整个源程序两种方式的速度
+def benchmark_lexical_analyzer(func_num,stmt_num):
+    source_file=generate_sysy_file('lexical_analyzer',func_num,stmt_num)
+    return os.system(LRC_EXE_FILE+' '+BENCHMARK_LEXICAL_ANALYZER_FLAG+' '+source_file)==0
+
+#编译一个源程序并读取编译统计报告，失败的时候返回None
+#重复编译rounds次，总耗时和每一个阶段的耗时都取最短的一次
+def compile_with_time_report(source_file,rounds=THROUGHPUT_ROUNDS):
+    target_file=os.path.splitext(source_file)[0]
+    res=None
+    for _ in range(rounds):
+        start=time.time()
+        return_value=os.system(LRC_EXE_FILE+' '+TIME_REPORT_FLAG+' '+source_file+' '+target_file+' > '+os.devnull)
+        seconds=time.time()-start
+        if return_value!=0:
+            return None
+        with open(target_file+TIME_REPORT_FILE_SUFFIX) as f:
+            report=json.load(f)
+        report['end_to_end_ms']=seconds*1000
+        if res is None:
+            res=report
+            continue
+        res['end_to_end_ms']=min(res['end_to_end_ms'],report['end_to_end_ms'])
+        res['total']['wall_ms']=min(res['total']['wall_ms'],report['total']['wall_ms'])
+        res['total']['cpu_ms']=min(res['total']['cpu_ms'],report['total']['cpu_ms'])
+        for i,j in zip(res['stages'],report['stages']):
+            i['wall_ms']=min(i['wall_ms'],j['wall_ms'])
+            i['cpu_ms']=min(i['cpu_ms'],j['cpu_ms'])
+    return res
+
+#两次测试之间某一项耗时随规模增长的幂次
+def growth_exponent(small_ms,large_ms,small_size,large_size):
+    if small_ms<=0 or large_ms<=0 or small_size<=0 or large_size<=small_size:
+        return 0.0
+    return math.log(large_ms/small_ms)/math.log(large_size/small_size)
+
+#检查从最小规模到最大规模哪些阶段的耗时是超线性增长的
+#规模相差越大，计时的波动对增长幂次的影响就越小，所以直接比较最小和最大的规模
+def find_super_linear_stages(small,large):
+    res=[]
+    small_stages={}
+    for i in small['stages']:
+        small_stages[i['name']]=small_stages.get(i['name'],0)+i['wall_ms']
+    large_stages={}
+    for i in large['stages']:
+        large_stages[i['name']]=large_stages.get(i['name'],0)+i['wall_ms']
+    #规模一般按照token个数计算(嵌套很深的程序中缩进占了大部分的字节数)，预处理和词法分析按照字节数计算
+    for name in large_stages:
+        if name not in small_stages or name in FIXED_COST_STAGES or large_stages[name]<SUPER_LINEAR_MIN_MS:
+            continue
+        size_counter='source bytes' if name in BYTE_BOUND_STAGES else 'tokens'
+        exponent=growth_exponent(small_stages[name],large_stages[name],small['counters'].get(size_counter,0),large['counters'].get(size_counter,0))
+        if exponent>SUPER_LINEAR_EXPONENT:
+            res.append((name,exponent))
+    return res
+
+#测试各种程序在不同规模下的编译吞吐量和各个阶段的耗时，并检查超线性增长
+def benchmark_throughput(kinds_name=None):
+    results=[]
+    super_linear_num=0
+    for kind,generator,sizes in THROUGHPUT_KINDS:
+        if kinds_name and kind not in kinds_name:
+            continue
+        reports=[]
+        for size in sizes:
+            source_file=write_sysy_file('throughput_'+kind+'_'+str(size),generator(size))
+            report=compile_with_time_report(source_file)
+            if report is None:
+                print(kind+'\t'+str(size)+'\tcompile error!')
+                continue
+            source_bytes=report['counters'].get('source bytes',0)
+            tokens=report['counters'].get('tokens',0)
+            total_ms=report['total']['wall_ms']
+            stages=sorted([i for i in report['stages'] if i['depth']>0 or i['name'] in ('pre process','lexical analysis','translate')],key=lambda i:-i['wall_ms'])
+            print('%-16s %6d %9d bytes %8d tokens %10.3f ms %10.3f ms(end to end) %10.1f KB/s %12.0f tokens/s  peak rss: %d KB' % (kind,size,source_bytes,tokens,total_ms,report['end_to_end_ms'],source_bytes/1024.0/(total_ms/1000) if total_ms>0 else 0,tokens/(total_ms/1000) if total_ms>0 else 0,report['total']['peak_rss_kb']))
+            print('    slowest stages: '+', '.join('%s %.3f ms' % (i['name'],i['wall_ms']) for i in stages[:3]))
+            reports.append({'size':size,'report':report})
+        result={'kind':kind,'sizes':reports,'super_linear_stages':[]}
+        if len(reports)>=2:
+            for name,exponent in find_super_linear_stages(reports[0]['report'],reports[-1]['report']):
+                print('    WARNING: '+name+' grows super-linearly (x^%.2f from size %d to %d)' % (exponent,reports[0]['size'],reports[-1]['size']))
+                result['super_linear_stages'].append({'name':name,'exponent':exponent})
+                super_linear_num+=1
+        results.append(result)
+    if not os.path.exists(BENCHMARK_DIR):
+        os.makedirs(BENCHMARK_DIR)
+    with open(THROUGHPUT_REPORT_FILE,'w') as f:
+        json.dump(results,f,indent=2)
+    print(str(super_linear_num)+' super-linear stages, results are saved in '+THROUGHPUT_REPORT_FILE)
+    return super_linear_num==0
+
+if __name__ == '__main__':
+    if len(sys.argv)>=2 and sys.argv[1]=='parser-table':
+        benchmark_parser_table(200,50)
+    elif len(sys.argv)>=2 and sys.argv[1]=='parser':
+        benchmark_parser(200,50)
+    elif len(sys.argv)>=2 and sys.argv[1]=='lexer':
+        benchmark_lexical_analyzer(400,50)
+    elif len(sys.argv)>=2 and sys.argv[1]=='throughput':
+        sys.exit(0 if benchmark_throughput(sys.argv[2:]) else 1)
+    else:
+        print('usage: python3 benchmark.py parser-table|parser|lexer|throughput [kind ...]')
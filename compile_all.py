@@ -16,6 +16,14 @@ def files_name_with_suffix(file_dir,suffix):
                 files_name.append(os.path.join(root, file))
     return files_name
 
+#批量编译时的命令参数
+BATCH_FLAG='--batch'
+OUT_DIR_FLAG='--out-dir'
+THREAD_NUM_FLAG='-j'
+
+#同时编译的线程个数(0表示和机器的线程个数相同)
+THREAD_NUM=0
+
 #编译某一个sy文件
 def complie_file(source_file,target_file):
     return_value=os.system(LRC_EXE_FILE+' '+source_file+' '+target_file)
@@ -25,16 +33,15 @@ def complie_file(source_file,target_file):
         return True
 
 #编译目录file_dir下的所有sy文件
+#lrc只启动一次，文法和语法分析表也只建立一次，目标文件和源文件放在同一个目录下
 def complier_dir(dir_name):
     error_num=0
-    files_name_with_suffix_sy=files_name_with_suffix(dir_name,SOURCE_FILE_SUFFIX)
-    for file in files_name_with_suffix_sy:
-        is_success=complie_file(file,os.path.splitext(file)[0])
-        if is_success:
-            print(file+"\t\t\t\t\t\tsuccess!")
-        else:
+    output=os.popen(LRC_EXE_FILE+' '+BATCH_FLAG+' '+dir_name+' '+OUT_DIR_FLAG+' '+dir_name+' '+THREAD_NUM_FLAG+' '+str(THREAD_NUM))
+    for line in output:
+        print(line,end='')
+        if line.split('\t')[0].endswith(SOURCE_FILE_SUFFIX) and 'error!' in line:
             error_num=error_num+1
-            print(file+"\t\t\t\t\t\terror!")
+    output.close()
     return error_num
 
 
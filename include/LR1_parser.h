@@ -13,7 +13,10 @@
 #include<queue>
 #include<vector>
 #include<map>
+#include<set>
+#include<unordered_map>
 #include<string>
+#include<stdint.h>
 
 #include "lexical_analyzer.h"
 #include "grammer.h"
@@ -50,6 +53,20 @@ struct LR1_item
     syntax_symbol_index lookahead_symbol;   //搜索符
 };
 
+//LR(1)项目集的哈希函数(用于以项目集的核为键查找项目集规范族中的项目集)
+struct LR1_item_set_hash
+{
+    size_t operator()(const set<struct LR1_item> & I) const
+    {
+        size_t res=I.size();
+        for(auto & i : I)
+        {
+            res^=((size_t)i.production*0x9e3779b1+(size_t)i.dot_position*0x85ebca6b+(size_t)i.lookahead_symbol)+0x9e3779b97f4a7c15ULL+(res<<6)+(res>>2);
+        }
+        return res;
+    }
+};
+
 //语法分析时的状态
 typedef canonical_LR1_index state;
 
@@ -72,19 +89,98 @@ struct action_entry
 //goto表的表项
 typedef state goto_entry;
 
+//语法分析表的构造方式
+enum class parser_table_type
+{
+    CANONICAL_LR1,      //规范LR(1)
+    LALR1,              //LALR(1)(合并所有的同心项目集，可能会引入新的归约-归约冲突)
+    MINIMAL_LR1,        //最小LR(1)(只合并同心并且动作相容的状态，语法分析的结果和规范LR(1)完全相同)
+};
+
+//压缩之后的action表项，最高两位是动作(action_movement)，低14位是产生式或者状态的索引
+typedef uint16_t packed_action_entry;
+
+//压缩之后的action表项中动作的偏移
+#define PACKED_ACTION_MOVEMENT_SHIFT 14
+
+//压缩之后的action表项中索引的掩码
+#define PACKED_ACTION_INDEX_MASK 0x3fff
+
+//压缩之后的分析表能够表示的最大的状态编号和产生式编号
+#define PACKED_TABLE_MAX_INDEX 0x3fff
+
+//压缩之后的分析表中不属于任何一行(列)的位置的标记
+#define PACKED_TABLE_EMPTY 0xffff
+
+//采用行偏移(row displacement)压缩之后的语法分析表
+//action表按照状态分行，每一行只保存和该状态的默认动作不同的表项，默认动作是这一行中出现次数最多的归约(没有归约的话就是ERROR)
+//goto表按照语法变量分列，每一列只保存和该语法变量的默认转移不同的表项，默认转移是这一列中出现次数最多的状态
+//所有行(列)错开之后叠放在同一个数组中，再用check数组记录每一个位置属于哪一行(列)
+struct packed_parser_table
+{
+    const int32_t * action_base;                    //每一个状态的action行在action_value中的起始位置
+    const int32_t * goto_base;                      //每一个语法变量的goto列在goto_value中的起始位置
+    const packed_action_entry * default_action;     //每一个状态的默认动作
+    const packed_action_entry * action_value;       //叠放之后的action表项
+    const uint16_t * action_check;                  //action_value中的每一个位置属于哪一个状态
+    const uint16_t * default_goto;                  //每一个语法变量的默认转移
+    const uint16_t * goto_value;                    //叠放之后的goto表项
+    const uint16_t * goto_check;                    //goto_value中的每一个位置属于哪一个语法变量
+    int32_t action_size;                            //action_value和action_check的长度
+    int32_t goto_size;                              //goto_value和goto_check的长度
+};
+
+//语法分析表文件的魔数
+#define LR1_TABLE_FILE_MAGIC "LRCTABLE"
+
+//语法分析表文件格式的版本号，文件格式发生改变时需要递增
+#define LR1_TABLE_FILE_VERSION 3
+
+//语法分析表文件的文件头
+//文件头之后依次是各个产生式的信息(左部,右部长度)和压缩之后的语法分析表
+struct LR1_table_file_header
+{
+    char magic[8];                          //魔数
+    uint32_t version;                       //文件格式的版本号
+    uint32_t sizeof_packed_action_entry;    //压缩之后的action表项的大小
+    uint64_t grammer_hash;                  //生成该分析表的文法的哈希值
+    int32_t table_type;                     //语法分析表的构造方式
+    int32_t state_num;                      //状态个数
+    int32_t terminator_num;                 //终结符个数
+    int32_t syntax_variable_num;            //语法变量个数
+    int32_t production_num;                 //产生式个数
+    int32_t packed_action_size;             //压缩之后的action表的长度
+    int32_t packed_goto_size;               //压缩之后的goto表的长度
+};
+
 //定义LR(1)型的自底向上的语法分析器
 class LR1_parser
 {
 
 protected:
     //从词法分析器中获得的token序列
-    list<struct token * > * tokens_;
+    struct token_stream * tokens_;
+
+    //下一个要读取的token在token序列中的位置
+    size_t next_token_index_;
+
+    //最近一次读取的token
+    struct token current_token_;
+
+    //边进行语法分析边从词法分析器中获取token的时候使用的词法分析器(此时tokens_为nullptr)
+    Lexical_analyzer * lexical_analyzer_;
 
-    //符号栈
-    stack<syntax_symbol_index> token_stack_;
+    //标识符和字符串常量所在的字符串表
+    struct string_table * strings_;
 
-    //状态栈
-    stack<state> state_stack_;
+    //符号栈(用连续的数组存放，归约的时候直接把栈顶下移产生式右部的长度)
+    vector<syntax_symbol_index> token_stack_;
+
+    //状态栈(同上)
+    vector<state> state_stack_;
+
+    //每一个产生式右部的长度(不包括空符号)，在文法建立之后就计算好
+    vector<unsigned int> production_right_sizes_;
 
     //action
     struct action_entry * action_;
@@ -95,15 +191,36 @@ protected:
     //要分析的文法
     Grammer * grammer_;
 
+    //共享文法和语法分析表的原型语法分析器(为nullptr表示文法和语法分析表是自己建立的，需要自己释放)
+    const LR1_parser * prototype_;
+
     //拓广文法的起始符号
     syntax_symbol_index augmented_grammer_start_symbol_;
 
     //LR(1)文法的项目集规范族
     vector<set<struct LR1_item> * > canonical_LR1_collection_;
 
+    //以项目集的核为键的项目集规范族的哈希索引
+    unordered_map<set<struct LR1_item>,canonical_LR1_index,LR1_item_set_hash> canonical_LR1_kernel_map_;
+
     //LR(1)分析表的状态个数
     int state_num_;
 
+    //语法分析表的构造方式
+    enum parser_table_type table_type_;
+
+    //压缩之后的语法分析表(语法分析时使用)
+    struct packed_parser_table packed_table_;
+
+    //新建的压缩之后的语法分析表所在的内存(如果语法分析表是从文件中映射进来的，那么就是nullptr)
+    void * packed_table_buf_;
+
+    //从文件中映射进来的语法分析表(如果语法分析表是新建的，那么就是nullptr)
+    void * table_file_map_;
+
+    //映射进来的语法分析表文件的大小
+    size_t table_file_map_size_;
+
     //存储LR(1)文法的各个项目集之间的转移关系的表
     map<canonical_LR1_index,map<syntax_symbol_index,canonical_LR1_index> > canonical_LR1_go_table_;
 
@@ -113,15 +230,42 @@ protected:
     //计算一个LR(1)项目集的闭包
     canonical_LR1_index closure(set<struct LR1_item> I);
 
-    //计算从一个LR(1)项目闭包经过某一个输入字符之后可以到达的项目闭包
-    canonical_LR1_index go(canonical_LR1_index I_index,syntax_symbol_index X);
+    //计算从一个LR(1)项目闭包经过各个输入字符之后可以到达的项目闭包
+    void go(canonical_LR1_index I_index);
 
     //构造LR(1)项目集规范族
     void build_canonical_LR1_collection();
 
+    //求出LR(1)项目集规范族中每一个项目集的核心的编号
+    vector<canonical_LR1_index> get_LR1_collection_cores();
+
+    //按照给定的编号合并LR(1)项目集规范族中的项目集
+    void merge_LR1_collection(const vector<canonical_LR1_index> & merged_index);
+
+    //合并规范LR(1)分析表中同心并且动作相容的状态
+    void merge_compatible_LR1_states();
+
     //构造LR(1)分析表
     bool build_LR1_table(bool print_warning);
 
+    //压缩LR(1)分析表
+    bool pack_LR1_table();
+
+    //设置压缩之后的语法分析表的各个数组的位置
+    void set_packed_table(void * buf,int32_t action_size,int32_t goto_size);
+
+    //计算文法的哈希值
+    uint64_t hash_grammer(const char * productions_filename,map<string,syntax_symbol_index> & terminators);
+
+    //从文件中加载LR(1)分析表
+    bool load_LR1_table(const char * parser_table_filename,uint64_t grammer_hash);
+
+    //检查压缩之后的分析表中的每一个表项是否都指向存在的状态或者产生式
+    bool check_packed_table_entries() const;
+
+    //将LR(1)分析表保存到文件中
+    bool save_LR1_table(const char * parser_table_filename,uint64_t grammer_hash);
+
     //打印LR(1)项目集
     void print_LR1_collection(state LR1_index);
 
@@ -143,6 +287,18 @@ protected:
     //从goto表中获取表项
     goto_entry get_goto_entry(state LR1_index,syntax_variable_index syn_var_index);
 
+    //从压缩之后的action表中获取表项
+    inline struct action_entry get_packed_action_entry(state LR1_index,terminator_index ter_index) const;
+
+    //从压缩之后的goto表中获取表项
+    inline goto_entry get_packed_goto_entry(state LR1_index,syntax_variable_index syn_var_index) const;
+
+    //只使用action表和goto表对tokens进行识别(不进行归约之外的任何操作)
+    bool recognize(bool use_packed_table);
+
+    //使用基于deque的栈并且逐个符号弹栈进行语法分析(测试语法分析速度时的比较基准)
+    queue<struct production * > * parse_with_deque_stack();
+
     //处理action表中产生的冲突
     bool handle_action_conflict(state LR1_index,terminator_index ter_index,struct action_entry entry,bool print_warning);
 
@@ -153,18 +309,30 @@ protected:
     void print_goto_conflict(state LR1_index,syntax_variable_index syn_var_index,goto_entry entry);
 
     //获取产生式右部的长度
-    unsigned int sizeof_production_right(vector<syntax_symbol_index> right);
+    unsigned int sizeof_production_right(const vector<syntax_symbol_index> & right);
 
 public:
     //构造函数
     LR1_parser();
 
     //初始化
-    bool init(const char * productions_filename,const char * parser_table_filename,list<struct token * > * tokens,bool print_warning);
+    bool init(const char * productions_filename,const char * parser_table_filename,struct token_stream * tokens,bool print_warning,enum parser_table_type table_type=parser_table_type::CANONICAL_LR1);
+
+    //初始化，语法分析的时候从词法分析器中逐个获取token
+    bool init(const char * productions_filename,const char * parser_table_filename,Lexical_analyzer * lexical_analyzer,bool print_warning,enum parser_table_type table_type=parser_table_type::CANONICAL_LR1);
+
+    //初始化，和一个已经初始化好的语法分析器共享文法和语法分析表
+    bool init(const LR1_parser & prototype);
 
     //析构函数
     virtual ~LR1_parser();
 
+    //更换要进行语法分析的token序列(文法和语法分析表保持不变)
+    void set_tokens(struct token_stream * tokens);
+
+    //更换语法分析时获取token的词法分析器(文法和语法分析表保持不变)
+    void set_tokens(Lexical_analyzer * lexical_analyzer);
+
     //判断语法分析器是否建立成功
     bool is_init_success();
 
@@ -173,7 +341,44 @@ public:
 
     //将语法分析得到的所有产生式输出到文件中
     void output_productions(const char * filename);
+
+    //比较使用压缩前后的语法分析表进行语法分析的速度
+    void benchmark_parser_table(int rounds);
+
+    //比较语法分析栈改成vector前后的语法分析速度
+    void benchmark_parse(int rounds);
     
 };
 
+/*
+从压缩之后的action表中获取表项
+
+Parameters
+----------
+LR1_index:项目集编号(也就是状态编号)
+ter_index:终结符编号
+*/
+struct action_entry LR1_parser::get_packed_action_entry(state LR1_index,terminator_index ter_index) const
+{
+    int32_t i=packed_table_.action_base[LR1_index]+ter_index;
+    packed_action_entry entry=(packed_table_.action_check[i]==LR1_index)?packed_table_.action_value[i]:packed_table_.default_action[LR1_index];
+    return {(enum action_movement)(entry>>PACKED_ACTION_MOVEMENT_SHIFT),(int)(entry&PACKED_ACTION_INDEX_MASK)};
+}
+
+/*
+从压缩之后的goto表中获取表项
+
+Parameters
+----------
+LR1_index:项目集编号(也就是状态编号)
+syn_var_index:语法变量编号
+*/
+goto_entry LR1_parser::get_packed_goto_entry(state LR1_index,syntax_variable_index syn_var_index) const
+{
+    int32_t column=syn_var_index-grammer_->terminator_num_;
+    int32_t i=packed_table_.goto_base[column]+LR1_index;
+    uint16_t entry=(packed_table_.goto_check[i]==column)?packed_table_.goto_value[i]:packed_table_.default_goto[column];
+    return (entry==PACKED_TABLE_EMPTY)?-1:entry;
+}
+
 #endif //__LR1_PARSER_H
\ No newline at end of file
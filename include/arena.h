@@ -0,0 +1,112 @@
+/*
+ *
+ *  arena.h
+ *  按块分配内存的分配器
+ *  Creator:Sichao Chen
+ *  Create time:2026/10/18
+ *
+*/
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include<string>
+#include<vector>
+#include<new>
+#include<utility>
+#include<type_traits>
+#include<stdint.h>
+
+using namespace std;
+
+//每一块内存的大小
+#define ARENA_BLOCK_SIZE 65536
+
+//超过这个大小的对象单独分配一块内存，避免浪费当前块剩余的空间
+#define ARENA_MAX_SMALL_SIZE (ARENA_BLOCK_SIZE/4)
+
+//需要在分配器销毁的时候析构的对象
+struct arena_destructor
+{
+    void (*destroy)(void * object);             //析构函数
+    void * object;                              //对象
+};
+
+//按块分配内存的分配器
+//对象从大块的内存中顺序分配，不能单独释放，分配器销毁的时候按照和分配相反的顺序析构所有对象，然后一次释放所有的内存
+//分配的时候只需要移动一个指针，同时一起创建的对象在内存中也是相邻的
+//不是线程安全的，多个线程同时分配的时候需要在外面加锁
+class Arena
+{
+
+protected:
+    //所有的内存块
+    vector<char * > blocks_;
+
+    //当前块中下一个可以分配的位置
+    char * pos_;
+
+    //当前块的结束位置
+    char * end_;
+
+    //需要析构的对象(按照分配的顺序)
+    vector<struct arena_destructor> destructors_;
+
+    //当前块的空间不够的时候分配内存
+    void * allocate_slow(size_t size,size_t align);
+
+    //调用一个对象的析构函数
+    template<typename T>
+    static void destroy(void * object)
+    {
+        ((T *)object)->~T();
+    };
+
+public:
+    //构造函数
+    Arena();
+
+    //析构函数，析构所有的对象并释放所有的内存
+    ~Arena();
+
+    //分配器独占它分配的内存，不应该有克隆构造函数
+    Arena(const Arena & other) = delete;
+
+    //分配器不应该重载赋值运算符
+    void operator=(const Arena &) = delete;
+
+    //分配一块按照align对齐的内存
+    inline void * allocate(size_t size,size_t align)
+    {
+        char * res;
+
+        if(pos_)
+        {
+            res=(char *)(((uintptr_t)pos_+align-1)&~(uintptr_t)(align-1));
+            if(res+size<=end_)
+            {
+                pos_=res+size;
+                return res;
+            }
+        }
+        return allocate_slow(size,align);
+    };
+
+    //创建一个对象，不是平凡析构的对象会在分配器销毁的时候被析构
+    template<typename T,typename... Args>
+    T * create(Args &&... args)
+    {
+        T * res=new(allocate(sizeof(T),alignof(T))) T(forward<Args>(args)...);
+
+        if(!is_trivially_destructible<T>::value)
+        {
+            destructors_.push_back({destroy<T>,res});
+        }
+        return res;
+    };
+
+    //复制一个字符串(以'\0'结尾)
+    const char * copy_string(const string & str);
+
+};
+
+#endif //__ARENA_H
@@ -19,6 +19,9 @@ class Arm_asm_generator:public Asm_generator
 {
 
 private:
+    //生成汇编代码时使用的符号表
+    Symbol_table * symbol_table_;
+
     //初始化arm汇编代码生成器
     bool init_instruction_generator(map<reg_index,string> regs_info);
 
@@ -33,7 +36,13 @@ public:
     struct event notify(Asm_generator_component *sender, struct event event) const;
 
     //初始化
-    bool init();
+    bool init(Symbol_table * symbol_table);
+
+    //只为中间代码流图中的一个函数生成arm汇编函数流图
+    struct arm_func_flow_graph * generate_func_arm_flow_graph(struct ic_flow_graph * intermediate_codes_flow_graph,list<struct ic_func_flow_graph * >::iterator func);
+
+    //按照函数并行生成最终的汇编代码文件
+    bool generate_asm_in_parallel_then_output(struct ic_flow_graph * intermediate_codes_flow_graph,const char * filename,size_t thread_num);
 };
 
 #endif //__ARM_ASM_GENERATOR_H
\ No newline at end of file
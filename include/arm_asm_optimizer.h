@@ -53,7 +53,7 @@ struct arm_basic_block
 //arm汇编函数的流图
 struct arm_func_flow_graph
 {
-    arm_func_flow_graph(struct ic_func * function):function(function)
+    arm_func_flow_graph(struct ic_func * function):function(function),current_arm_basic_block(nullptr)
     {
     };
 
@@ -68,7 +68,6 @@ struct arm_func_flow_graph
     //往汇编函数流图中添加一条arm汇编
     void add_arm_asm(Arm_asm_file_line * arm_asm,bool new_basic_block)
     {
-        static struct arm_basic_block * current_arm_basic_block=nullptr;
         if(new_basic_block)
         {
             current_arm_basic_block=new struct arm_basic_block;
@@ -108,12 +107,14 @@ struct arm_func_flow_graph
     struct ic_func * function;
     //函数流图中的所有基本块序列，顺序就是中间代码的书写顺序
     list<struct arm_basic_block * > basic_blocks;
+    //当前正在插入汇编的基本块
+    struct arm_basic_block * current_arm_basic_block;
 };
 
 //arm汇编的流图
 struct arm_flow_graph
 {
-    arm_flow_graph()
+    arm_flow_graph():current_arm_func_flow_graph(nullptr)
     {
         
     };
@@ -124,11 +125,10 @@ struct arm_flow_graph
     //参数new_basic_block如果不是false，就表示要新建一个基本块，将arm_asm插入到这个基本块中
     void add_arm_asm_to_current_func(Arm_asm_file_line * arm_asm,struct ic_func * new_func,bool new_basic_block)
     {
-        static struct arm_func_flow_graph * current_arm_func_flow_graph=nullptr;
         if(new_func!=nullptr)
         {
             current_arm_func_flow_graph=new struct arm_func_flow_graph(new_func);
-            func_flow_graphs.insert(current_arm_func_flow_graph);
+            func_flow_graphs.push_back(current_arm_func_flow_graph);
         }
         if(current_arm_func_flow_graph)
         {
@@ -177,10 +177,12 @@ struct arm_flow_graph
         return res;
     };
 
-    //所有函数的流图，这些流图之间相互独立
-    set<struct arm_func_flow_graph * > func_flow_graphs;
+    //所有函数的流图，这些流图之间相互独立，顺序就是函数在源程序中的顺序
+    list<struct arm_func_flow_graph * > func_flow_graphs;
     //全局定义域流图（里面的语句只能是变量定义语句）
     struct arm_basic_block global_basic_block;
+    //当前正在插入汇编的函数的流图
+    struct arm_func_flow_graph * current_arm_func_flow_graph;
 };
 
 class Arm_asm_optimizer
@@ -27,6 +27,9 @@ protected:
     //arm汇编的流图
     struct arm_flow_graph arm_flow_graph_;
 
+    //生成汇编代码时使用的符号表
+    Symbol_table * symbol_table_;
+
     //生成汇编文件序列,并将其赋值给父类Instruction_generator的asm_codes_成员
     void generate_asm_codes();
 
@@ -124,7 +127,7 @@ protected:
 
 public:
     //构造函数
-    Arm_instruction_generator(map<reg_index,string> regs_info);
+    Arm_instruction_generator(map<reg_index,string> regs_info,Symbol_table * symbol_table);
 
     //析构函数
     ~Arm_instruction_generator();
@@ -132,6 +135,12 @@ public:
     //事件处理函数(由中介者进行调用)
     struct event handler(struct event event);
 
+    //根据中间代码生成arm汇编的流图(不进行优化)，返回生成的流图
+    struct arm_flow_graph & build_arm_flow_graph();
+
+    //对已经生成的arm汇编的流图进行优化，然后生成汇编文件序列
+    list<string> & generate_asm_from_arm_flow_graph();
+
 };
 
 #endif //__ARM_INSTRUCTION_GENERATOR_H
\ No newline at end of file
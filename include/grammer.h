@@ -13,6 +13,7 @@
 #include<string>
 #include<map>
 #include<set>
+#include<bitset>
 
 #include "semantic_rules.h"
 
@@ -30,6 +31,12 @@ typedef int syntax_variable_index;
 //产生式编号
 typedef int production_index;
 
+//文法的终结符个数的上限(包括空符号和栈底符号)
+#define MAX_TERMINATOR_NUM 128
+
+//用位图表示的终结符集合
+typedef bitset<MAX_TERMINATOR_NUM> terminator_set;
+
 //文法的产生式
 struct production
 {
@@ -46,14 +53,23 @@ protected:
     //是否是拓广文法
     bool is_augmented_;
 
-    //所有的语法符号的FIRST集
-    set<syntax_symbol_index> ** firsts_;
+    //已经新生成的语法变量的个数
+    int new_syntax_variable_num_;
+
+    //所有的语法符号能否推导出空符号
+    vector<bool> derive_empty_;
+
+    //用位图表示的所有的语法符号的FIRST集(能推导出空符号的语法符号的FIRST集中包含空符号)
+    vector<terminator_set> first_sets_;
 
-    //所有的语法变量的FOLLOW集
-    set<syntax_symbol_index> ** follows_;
+    //用位图表示的所有的语法变量的FOLLOW集
+    vector<terminator_set> follow_sets_;
 
-    //能派生出空符号的语法变量的标志数组(1表示可以,0表示不行,-1表示还没有填入内容)
-    bool *syntax_variables_derive_empty_;
+    //所有的产生式右部的后缀的FIRST集(不包含空符号)，suffix_firsts_[i][j]是第i个产生式的右部从第j个符号开始的后缀的FIRST集
+    vector<vector<terminator_set> > suffix_firsts_;
+
+    //所有的产生式右部的后缀能否推导出空符号
+    vector<vector<bool> > suffix_derive_empty_;
 
     //获取所有的能够派生出空符号的语法变量
     void get_all_symbol_variables_derive_empty();
@@ -61,21 +77,12 @@ protected:
     //判断一个语法符号能不能派生出空符号
     bool derive_empty(syntax_symbol_index syn_sym);
 
-    //判断一个符号串能不能派生出空符号
-    bool string_derive_empty(vector<syntax_symbol_index> string);
-
-    //将一个语法符号集合去除空符号
-    set<syntax_symbol_index> set_difference_empty(set<syntax_symbol_index> syntax_symbol_set);
-
-    //获取语法符号的FIRST集
-    set<syntax_symbol_index> * first(syntax_symbol_index syn_sym);
-
-    //获取语法符号的FOLLOW集
-    set<syntax_symbol_index> * follow(syntax_symbol_index syn_var);
-
     //获取整个文法的所有语法符号的FIRST集
     void get_all_firsts();
 
+    //获取所有的产生式右部的后缀的FIRST集
+    void get_all_suffix_firsts();
+
     //获取整个文法的所有语法变量的FOLLOW集
     void get_all_follows();
 
@@ -113,6 +120,12 @@ public:
     //每一个产生式和语义动作函数的对应表
     vector<semantic_rule> production_semantic_rule_;
 
+    //每一个产生式对应的语义动作的描述（和production_semantic_rule_一一对应）
+    vector<struct semantic_rule_descriptor> production_semantic_rule_descriptors_;
+
+    //每一个语法变量作为左部的所有产生式(按照产生式编号从小到大排列)
+    vector<vector<production_index> > productions_by_left_;
+
     //构造函数
     Grammer(const char * filename,map<string,syntax_symbol_index> terminators,bool is_augmented);
 
@@ -124,7 +137,55 @@ public:
 
     //获取一个符号串的FIRST集
     set<syntax_symbol_index> string_first(vector<syntax_symbol_index> string);
+
+    //获取语法符号的FIRST集(位图)
+    inline const terminator_set & first_set(syntax_symbol_index syn_sym) const;
+
+    //获取语法变量的FOLLOW集(位图)
+    inline const terminator_set & follow_set(syntax_variable_index syn_var) const;
+
+    //获取产生式右部的某一个后缀后面接上一个搜索符集合中的搜索符之后的FIRST集
+    inline terminator_set suffix_first(production_index production,int position,const terminator_set & lookaheads) const;
     
 };
 
+/*
+获取语法符号的FIRST集(位图)
+
+Parameters
+----------
+syn_sym:要求FIRST集的语法符号的编号
+*/
+const terminator_set & Grammer::first_set(syntax_symbol_index syn_sym) const
+{
+    return first_sets_[syn_sym];
+}
+
+/*
+获取语法变量的FOLLOW集(位图)
+
+Parameters
+----------
+syn_var:要求FOLLOW集的语法变量的编号
+*/
+const terminator_set & Grammer::follow_set(syntax_variable_index syn_var) const
+{
+    return follow_sets_[syn_var-terminator_num_];
+}
+
+/*
+获取产生式右部的某一个后缀后面接上一个搜索符集合中的搜索符之后的FIRST集
+也就是所有的FIRST(βa)的并集，其中β是后缀，a是搜索符集合中的搜索符
+
+Parameters
+----------
+production:产生式编号
+position:后缀在产生式右部的起始位置
+lookaheads:搜索符集合
+*/
+terminator_set Grammer::suffix_first(production_index production,int position,const terminator_set & lookaheads) const
+{
+    return suffix_derive_empty_[production][position]?(suffix_firsts_[production][position]|lookaheads):suffix_firsts_[production][position];
+}
+
 #endif  //__GRAMMER_H
\ No newline at end of file
@@ -315,7 +315,7 @@ struct ic_basic_block
 //一个中间代码的函数的流图
 struct ic_func_flow_graph
 {
-    ic_func_flow_graph(struct ic_func * func)
+    ic_func_flow_graph(struct ic_func * func):current_basic_block(nullptr),previous_ic_is_jump(false)
     {
         this->func=func;
     };
@@ -364,9 +364,6 @@ struct ic_func_flow_graph
     //往当前的函数流图中加入一条中间代码
     void add_ic(struct quaternion ic)
     {
-        static map<struct ic_label *,struct ic_basic_block *> ic_label_basic_block_map;
-        static struct ic_basic_block * current_basic_block=nullptr;
-        static bool previous_ic_is_jump=false;
         struct quaternion_with_def_use_info current_ic_with_def_use_info;
         size_t current_ic_with_def_use_info_pos;
         unsigned short new_basic_block_tag=0;
@@ -487,6 +484,12 @@ struct ic_func_flow_graph
     struct ic_func * func;
     //函数流图中的所有基本块序列，顺序就是中间代码的书写顺序
     list<struct ic_basic_block * > basic_blocks;
+    //构造流图时使用：标签和它所在的基本块的对应关系
+    map<struct ic_label *,struct ic_basic_block *> ic_label_basic_block_map;
+    //构造流图时使用：当前正在加入中间代码的基本块
+    struct ic_basic_block * current_basic_block;
+    //构造流图时使用：上一条加入的中间代码是否是跳转语句
+    bool previous_ic_is_jump;
     /*//函数中明确定义的所有全局变量和数组形参
     set<struct ic_data * > globals_and_array_f_params_explicit_def;
     //函数中模糊定义的所有全局变量和数组形参
@@ -22,12 +22,27 @@ protected:
     //当前正在转换成汇编的中间代码所在函数
     list<struct ic_func_flow_graph * >::iterator current_func_;
 
+    //要转换成汇编的第一个函数
+    list<struct ic_func_flow_graph * >::iterator begin_func_;
+
+    //要转换成汇编的最后一个函数的下一个位置
+    list<struct ic_func_flow_graph * >::iterator end_func_;
+
     //当前正在转换成汇编的中间代码所在基本块
     list<struct ic_basic_block * >::iterator current_basic_block_;
 
     //当前正在转换成汇编的中间代码的位置
     vector<struct quaternion_with_def_use_info>::iterator current_ic_;
 
+    //下一个要转换成汇编的全局定义
+    list<struct quaternion>::iterator current_global_define_;
+
+    //是否还没有开始转换函数中的中间代码
+    bool first_tag_;
+
+    //是否所有的中间代码都已经转换完成
+    bool end_tag_;
+
     //事件处理函数
     struct event handle_NEXT_IC();
 
@@ -41,6 +56,9 @@ public:
     //初始化
     void init(struct ic_flow_graph * intermediate_codes_flow_graph);
 
+    //初始化，只转换流图中的一部分函数
+    void init(struct ic_flow_graph * intermediate_codes_flow_graph,list<struct ic_func_flow_graph * >::iterator begin_func,list<struct ic_func_flow_graph * >::iterator end_func,bool with_global_defines);
+
     //事件处理函数(由中介者进行调用)
     struct event handler(struct event event);
 
@@ -141,34 +141,35 @@ typedef union OAA
     long long_data;
     void * pointer_data;
 
-    OAA():int_data(0)
+    //比8个字节窄的成员只会写入低位的字节，所以先把整个联合体清零，之后把它当作指针读取的时候才是确定的值
+    OAA():long_data(0)
     {
         ;
     };
 
-    OAA(char char_data):char_data(char_data)
+    OAA(char char_data):long_data(0)
     {
-        ;
+        this->char_data=char_data;
     };
 
-    OAA(bool bool_data):bool_data(bool_data)
+    OAA(bool bool_data):long_data(0)
     {
-        ;
+        this->bool_data=bool_data;
     };
 
-    OAA(short short_data):short_data(short_data)
+    OAA(short short_data):long_data(0)
     {
-        ;
+        this->short_data=short_data;
     };
 
-    OAA(int int_data):int_data(int_data)
+    OAA(int int_data):long_data(0)
     {
-        ;
+        this->int_data=int_data;
     };
 
-    OAA(float float_data):float_data(float_data)
+    OAA(float float_data):long_data(0)
     {
-        ;
+        this->float_data=float_data;
     };
 
     OAA(double double_data):double_data(double_data)
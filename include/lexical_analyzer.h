@@ -15,6 +15,10 @@
 #include<list>
 #include<map>
 #include<stack>
+#include<vector>
+#include<deque>
+#include<unordered_map>
+#include<string_view>
 #include "my_error.h"
 #include "language.h"
 
@@ -34,11 +38,18 @@ enum class digit_type
     HEXADECIMAL,        //十六进制数字，包括数字0到9，字母a到f和A到F
 };
 
+//定义词法分析器读取源程序的方式
+enum class lexical_input_mode
+{
+    DOUBLE_BUF,         //使用两个BUF_SIZE大小的缓冲区轮流读取源程序
+    WHOLE_BUF,          //一次性读入整个源程序，以末尾的'\0'作为哨兵，直接移动指针进行扫描
+};
+
 //定义属性值
 union attribute_value
 {
     char char_value;
-    string * p_string_value;
+    int string_id;                  //标识符和字符串常量在字符串表中的编号
     int int_value;
     float float_value;
 };
@@ -46,16 +57,67 @@ union attribute_value
 //定义词法分析器要输出的token单词
 struct token
 {
-    ~token()
+    enum code_of_kind code_of_kind;         //种别码
+    union attribute_value attribute_value;  //属性值
+};
+
+//字符串表，用于保存标识符和字符串常量
+//相同的字符串只保存一份，并且在字符串表销毁之前字符串的地址不会改变
+struct string_table
+{
+    //将一个字符串加入字符串表，返回它的编号(如果已经存在就直接返回原来的编号)
+    int intern(const char * str,size_t length)
     {
-        if(code_of_kind==code_of_kind::ID)
+        unordered_map<string_view,int>::iterator iter=ids.find(string_view(str,length));
+        if(iter!=ids.end())
         {
-            delete attribute_value.p_string_value;
+            return iter->second;
         }
+        strings.emplace_back(str,length);
+        ids.emplace(string_view(strings.back()),(int)strings.size()-1);
+        return (int)strings.size()-1;
     };
 
-    enum code_of_kind code_of_kind;         //种别码
-    union attribute_value attribute_value;  //属性值
+    //根据编号获取字符串
+    string * get_string(int id)
+    {
+        return &strings[id];
+    };
+
+    deque<string> strings;                          //所有的字符串(deque在末尾插入的时候不会移动已有的元素)
+    unordered_map<string_view,int> ids;             //字符串对应的编号
+};
+
+//词法分析得到的token序列
+//种别码，行号和属性值分别连续存放，标识符和字符串常量只保存它们在字符串表中的编号
+struct token_stream
+{
+    //预留能够存放token_num个token的空间
+    void reserve(size_t token_num)
+    {
+        kinds.reserve(token_num);
+        lines.reserve(token_num);
+        values.reserve(token_num);
+    };
+
+    //在token序列的末尾加入一个token
+    void push_back(const struct token & t,int line)
+    {
+        kinds.push_back(t.code_of_kind);
+        lines.push_back(line);
+        values.push_back(t.attribute_value);
+    };
+
+    //token的个数
+    size_t size() const
+    {
+        return kinds.size();
+    };
+
+    vector<enum code_of_kind> kinds;                //种别码
+    vector<int> lines;                              //所在的行数
+    vector<union attribute_value> values;           //属性值
+    struct string_table strings;                    //字符串表
 };
 
 //括号匹配栈的结点
@@ -73,6 +135,34 @@ private:
     //源程序文件结构体
     FILE * source_program_;
 
+    //内存中的源程序(由预处理器直接提供，此时不需要读文件)
+    const char * source_program_buf_;
+
+    //内存中的源程序的长度
+    size_t source_program_buf_size_;
+
+    //内存中的源程序已经读入缓冲区的位置
+    size_t source_program_buf_pos_;
+
+    //读取源程序的方式
+    enum lexical_input_mode input_mode_;
+
+    //WHOLE_BUF模式下从文件中一次性读入的整个源程序
+    string whole_buf_;
+
+    //WHOLE_BUF模式下扫描单词的起始指针和结束指针
+    const char * lexeme_begining_ptr_;
+    const char * lexeme_ending_ptr_;
+
+    //最近一次识别出来的单词
+    struct token token_;
+
+    //词法分析得到的token序列(同时也保存了字符串表)
+    struct token_stream * token_stream_;
+
+    //字符串表中每一个字符串作为标识符时对应的种别码(保留字或者ID)
+    vector<enum code_of_kind> string_kinds_;
+
     //此时读取到的源程序文件的行数(用于错误分析的时候进行定位)
     int line_;
 
@@ -102,9 +192,18 @@ private:
     //上一次出现的错误
     enum my_error_code last_error_;
 
+    //从源程序文件或者内存中的源程序中读取最多length个字符
+    size_t read_source_program(char * buf,size_t length);
+
     //将源程序文件内容读入下一个缓冲区中
     bool write_buf();
 
+    //初始化缓冲区等词法分析的状态
+    void init_buf(enum lexical_input_mode input_mode);
+
+    //读入源程序中的下一个字符
+    bool read_char(char & ch);
+
     //将已读入的字符回退
     int retract(int num);
 
@@ -114,18 +213,27 @@ private:
     //跳过从lexmem_ending_开始的所有空白字符
     bool skip_all_blanks();
 
+    //获取当前结束指针指向的字符
+    char get_current_char();
+
     //将此时识别出来的符号加入string缓冲区的末尾
     void append_to_string_buf();
 
     //将此时识别出来的字符串作为单词token输出
     struct token * get_token(enum code_of_kind cok);
 
+    //将标识符加入字符串表，并且获取它的种别码
+    struct token * get_id_token(const char * str,size_t length);
+
     //把左括号压入栈中
     void left_br_push(enum code_of_kind l_br_cok);
 
     //根据右括号寻找栈中的匹配左括号然后出栈
     bool right_br_pop(enum code_of_kind r_br_cok);
 
+    //检查右括号是否能够匹配，不能匹配就报错
+    void right_br_check(enum code_of_kind r_br_cok);
+
     //错误处理
     void error_handle(enum my_error_code ec);
 
@@ -134,7 +242,10 @@ public:
     Lexical_analyzer();
 
     //将词法分析器进行初始化
-    bool init(const char * filename);
+    bool init(const char * filename,enum lexical_input_mode input_mode=lexical_input_mode::DOUBLE_BUF);
+
+    //使用内存中的源程序将词法分析器进行初始化
+    bool init_from_string(const string & source_program,enum lexical_input_mode input_mode=lexical_input_mode::DOUBLE_BUF);
 
     //析构函数
     ~Lexical_analyzer();
@@ -145,11 +256,17 @@ public:
     //词法分析一个单词
     struct token * token_scan();
 
+    //获取标识符和字符串常量所在的字符串表
+    struct string_table * get_string_table()
+    {
+        return &token_stream_->strings;
+    };
+
     //词法分析源程序中的所有单词
-    list<struct token * > * tokens_scan();
+    struct token_stream * tokens_scan();
 
     //词法分析源程序中的所有单词并将词法分析得到的所有token输出到文件中
-    list<struct token * > * tokens_scan_then_output(const char * filename);
+    struct token_stream * tokens_scan_then_output(const char * filename);
     
 };
 
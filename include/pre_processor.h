@@ -14,32 +14,207 @@
 #include<map>
 #include<string>
 #include<list>
+#include<deque>
 #include<utility>
-#include<stack>
+#include<vector>
+#include<memory>
+#include<mutex>
+#include<stdint.h>
+#include<sys/stat.h>
 
 using namespace std;
 
-//缓冲区大小
-#define READ_BUF_SIZE 1024
-#define WRITE_BUF_SIZE 1024
+//读取文件的时候每次读取的字符个数
+#define READ_BUF_SIZE 65536
 
-//宏函数
-struct macro_func
+//#include的最大嵌套深度(超过的时候认为头文件递归地包含了自己)
+#define MAX_INCLUDE_DEPTH 200
+
+//宏的种类
+enum class macro_kind
+{
+    VAR,                                    //宏变量
+    FUNC,                                   //宏函数
+    INNER_VAR,                              //内置宏变量(替换的内容在替换的时候才确定)
+};
+
+//预处理记号的种类
+enum class pp_token_kind
+{
+    IDENTIFIER,                             //标识符
+    NUMBER,                                 //数字
+    LITERAL,                                //字符串和字符常量
+    PUNCTUATOR,                             //标点符号
+    PARAM,                                  //宏函数的内容中的形参
+    STRINGIFY,                              //宏函数的内容中的#形参
+    PASTE,                                  //宏函数的内容中的##
+    PLACEMARKER,                            //##两边的空实参(替换完成之后会被删除)
+};
+
+//预处理记号
+//记号的内容不进行复制，直接指向源程序、宏的内容或者预处理器保存的拼接出来的字符串
+struct pp_token
 {
-    macro_func(string macro_fun_name,size_t f_param_num,list<size_t> f_params_in_content,list<string> content):macro_fun_name(macro_fun_name),f_param_num(f_param_num),f_params_in_content(f_params_in_content),content(content)
+    const char * str;                       //记号的内容
+    size_t len;                             //记号的长度
+    size_t param_index;                     //形参的编号(只有PARAM和STRINGIFY有)
+    enum pp_token_kind kind;                //记号的种类
+    bool space_before;                      //记号之前是否有空白符
+    bool no_expand;                         //记号是否不再进行宏替换(正在展开的宏的宏名)
+};
+
+struct macro;
+
+//一个正在展开的宏
+struct macro_expand_frame
+{
+    struct macro * m;                       //正在展开的宏(为nullptr表示只是需要重新扫描的记号)
+    vector<struct pp_token> tokens;         //替换之后的记号
+    const vector<struct pp_token> * memo;   //记忆的展开结果(不为nullptr的时候扫描它而不是tokens)
+    bool is_expanded;                       //记号是否已经完全展开过(只有最后一个记号还可能和后面的左括号组成宏函数的调用)
+    size_t pos;                             //下一个要扫描的记号的位置
+};
+
+//宏展开的上下文
+//正在展开的宏组成一个栈，栈下面是源程序或者一串记号(宏函数的实参)
+struct macro_expand_context
+{
+    vector<struct macro_expand_frame> frames;   //正在展开的宏
+    const struct pp_token * base;               //最下面的一串记号(为nullptr表示没有)
+    size_t base_num;                            //base中记号的个数
+    size_t base_pos;                            //base中下一个要扫描的记号的位置
+    const string * source;                      //最下面的源程序(为nullptr表示没有，只有在收集宏函数的实参的时候才会读取)
+    size_t source_pos;                          //source中下一个要扫描的字符的位置
+    size_t line_feed_num;                       //从source中读取的换行符的个数
+    bool space_pending;                         //下一个输出的记号之前是否需要空白符(被替换的宏名之前有空白符)
+    bool is_context_free;                       //展开过程中是否没有用到内置宏变量(用到的时候展开的结果和展开的位置有关，不能被记忆)
+    bool is_args_unterminated;                  //收集宏函数的实参的时候是否读完了所有记号(只会出现在没有实参的宏的内容中，实参在外面的上下文中)
+    vector<struct macro * > deps;               //展开过程中展开过的宏
+    vector<struct macro * > painted;            //展开过程中因为正在展开而没有被替换的宏
+};
+
+//宏
+struct macro
+{
+    macro(string name,uint64_t hash,enum macro_kind kind,size_t f_param_num,string content):name(name),hash(hash),kind(kind),f_param_num(f_param_num),is_variadic(false),content(content),is_expanding(false),memo_version(0)
     {
 
     };
 
-    /*string macro_relacement(list<string> r_params) const
+    string name;                            //宏名
+    uint64_t hash;                          //宏名的哈希值
+    enum macro_kind kind;                   //宏的种类
+    size_t f_param_num;                     //形参个数(只有宏函数有)
+    bool is_variadic;                       //最后一个形参是否是可变参数__VA_ARGS__
+    string content;                         //宏的内容，只保存一份
+    vector<struct pp_token> tokens;         //宏的内容的记号，直接指向content
+    bool is_expanding;                      //是否正在被展开(正在展开的宏不会再被替换，避免无限递归)
+    vector<struct pp_token> memo;           //没有实参的时候记忆的展开结果
+    vector<struct macro * > memo_deps;      //得到memo的过程中展开过的宏，它们正在展开的时候memo不能使用
+    size_t memo_version;                    //得到memo的时候宏表的版本(为0表示没有memo，增加或者重新定义了宏之后memo就失效了)
+};
+
+//宏表
+//使用开放定址的哈希表，宏名只在宏中保存一份
+//预处理的时候源程序中的每一个标识符都要查找宏表，而绝大多数标识符都不是宏，
+//所以额外用一个64位的过滤器记录所有宏名的哈希值的低6位，大部分不是宏的标识符不需要访问哈希表就能排除
+class Macro_table
+{
+
+private:
+    //哈希表的槽(为nullptr表示空槽)，个数总是2的幂
+    vector<struct macro * > slots_;
+
+    //所有的宏(按照定义的顺序)
+    vector<struct macro * > macros_;
+
+    //所有宏名的哈希值的低6位组成的过滤器
+    uint64_t filter_;
+
+    //宏表的版本，每次增加或者重新定义宏的时候加1
+    size_t version_;
+
+    //把一个宏放到哈希表的槽中
+    void insert_slot(struct macro * m);
+
+public:
+    //构造函数
+    Macro_table();
+
+    //析构函数
+    ~Macro_table();
+
+    //计算宏名的哈希值
+    static uint64_t hash(const char * name,size_t len);
+
+    //快速判断一个哈希值对应的标识符是否一定不是宏
+    inline bool is_definitely_not_macro(uint64_t hash) const
+    {
+        return !(filter_&(1ULL<<(hash&63)));
+    };
+
+    //查找一个宏，找不到返回nullptr
+    struct macro * find(const char * name,size_t len,uint64_t hash) const;
+
+    //增加一个宏，已经存在同名的宏的时候返回nullptr
+    struct macro * add(string name,enum macro_kind kind,size_t f_param_num,string content);
+
+    //把一个已经存在的宏重新定义成definition
+    void redefine(struct macro * m,const struct macro & definition);
+
+    //获取宏的个数
+    size_t size() const
+    {
+        return macros_.size();
+    };
+
+    //获取宏表的版本
+    size_t get_version() const
     {
-        
-    };*/
+        return version_;
+    };
+};
+
+//头文件中定义的一个宏(保存定义时的样子，可以在别的预处理器中重新定义一遍)
+struct macro_definition
+{
+    string name;                            //宏名
+    bool is_func;                           //是否是宏函数
+    list<string> f_params;                  //形参(只有宏函数有)
+    string content;                         //宏的内容
+};
+
+//缓存的头文件
+struct include_file
+{
+    struct timespec mtime;                  //读取的时候文件的修改时间
+    off_t size;                             //读取的时候文件的大小
+    string text;                            //删除注释之后的内容
+    bool is_macros_recorded;                //是否已经记录了其中定义的宏(只有内置头文件会记录)
+    vector<struct macro_definition> macros; //其中定义的宏(按照定义的顺序)
+};
+
+//头文件缓存
+//同一个进程编译多个源程序的时候，头文件只要没有被修改过(修改时间和大小都相同)就只读取和删除注释一次
+//内置头文件预处理的结果会被丢弃，只有其中定义的宏有用，所以还会记录这些宏，之后直接重新定义它们，不再对内置头文件进行预处理
+//批量编译的时候会被多个线程同时使用，所以用互斥锁保护
+class Include_cache
+{
+
+protected:
+    //保护files_的互斥锁
+    static mutex mutex_;
+
+    //所有缓存的头文件(文件名到头文件的映射)
+    static map<string,shared_ptr<const struct include_file> > files_;
+
+public:
+    //查找一个头文件，没有缓存或者文件已经被修改过的时候返回nullptr
+    static shared_ptr<const struct include_file> find(const string & filename,const struct stat & file_stat);
+
+    //缓存一个头文件，已经缓存的同名头文件会被替换
+    static void add(const string & filename,const shared_ptr<const struct include_file> & file);
 
-    string macro_fun_name;                  //宏函数名
-    size_t f_param_num;                     //形参个数
-    list<size_t> f_params_in_content;       //形参在宏函数内容中的顺序
-    list<string> content;                   //宏函数内容
 };
 
 //定义预处理器
@@ -47,8 +222,8 @@ class Pre_processor
 {
 
 private:
-    //源程序文件
-    ifstream source_program_;
+    //源程序文件名
+    string source_program_filename_;
 
     //预处理之后的源程序文件
     ofstream source_program_after_pre_proces_;
@@ -56,44 +231,49 @@ private:
     //处理的程序文件目前处理到的行数
     size_t current_line_;
 
-    //目前源程序是否在双引号中
-    bool double_quotation_mark_;
+    //读缓冲区(一次性读入的整个文件，每次读取的时候重复使用)
+    string read_buf_;
 
-    //目前源程序是否在单引号中
-    bool single_quotation_mark_;
+    //预处理之后的源程序(保存在内存中，直接交给词法分析器使用)
+    string source_program_after_pre_process_;
 
-    //读缓冲区
-    string read_buf_;
+    //所有的宏(包括内置宏变量)
+    Macro_table macros_;
+
+    //展开宏的时候拼接出来的字符串(内置宏变量、#和##的结果)，预处理器析构的时候才释放
+    deque<string> token_strs_;
 
-    //宏替换缓冲区
-    stack<pair<size_t,string> > macro_bufs_;
+    //展开源程序中的宏的上下文和结果(每次展开的时候重复使用，避免重新分配内存)
+    struct macro_expand_context source_expand_context_;
+    vector<struct pp_token> source_expand_result_;
 
-    //写缓冲区
-    string write_buf_;
+    //最近一次预处理中宏展开的次数和直接使用记忆的展开结果的次数
+    size_t macro_expansion_num_;
+    size_t macro_memo_hit_num_;
 
-    //内置宏变量
-    map<string,string> inner_macro_vars_;
+    //正在记录定义的宏的地方(为nullptr表示不记录)
+    vector<struct macro_definition> * recorded_macros_;
 
-    //宏变量
-    map<string,string> macro_vars_;
+    //目前#include的嵌套深度
+    size_t include_depth_;
 
-    //宏函数
-    map<string,struct macro_func> macro_funcs_;
+    //读取一个文件并删除其中的注释
+    bool remove_comments(const char * filename,string & result);
 
-    //获取源程序的下一个字符
-    char read_char();
+    //读取一个头文件删除注释之后的内容，优先使用缓存
+    shared_ptr<const struct include_file> load_include_file(const string & filename);
 
-    //尝试进行#define语句的识别
-    bool macro_define_distinguish_automata(char ch);
+    //对删除注释之后的源程序进行宏替换，结果追加到预处理之后的源程序中
+    void macro_replace(const string & source);
 
-    //尝试进行宏替换
-    size_t macro_replace_automata(char ch,bool do_macro_replace);
+    //识别一条#define语句
+    size_t macro_define(const string & source,size_t pos);
 
-    //向写缓冲区写入一个字符，如果写缓冲区满就将其写入预处理之后的文件
-    void write_char(char ch);
+    //识别一条#include语句
+    size_t macro_include(const string & source,size_t pos);
 
-    //将写缓冲区的内容写入文件
-    void write_buf_to_file();
+    //重新定义头文件中记录的宏
+    void define_macros(const vector<struct macro_definition> & macros);
 
     //增加一个宏变量
     bool add_macro_var(string macro_source,string macro_destination);
@@ -101,14 +281,53 @@ private:
     //增加一个宏函数
     bool add_macro_func(string macro_source,list<string> macro_func_f_params,string macro_destination);
 
-    //进行没有参数的宏函数的宏替换
-    void no_f_params_macro_func_replace(string macro_source);
+    //定义一个宏，已经存在同名的宏的时候重新定义它
+    bool define_macro(string name,enum macro_kind kind,const list<string> & f_params,string content);
+
+    //把宏的内容分成记号
+    void tokenize_macro_content(struct macro * m,const list<string> & f_params);
 
-    //进行宏变量的宏替换
-    void macro_var_replace(string macro_source);
+    //保存一个拼接出来的字符串，返回指向它的记号
+    struct pp_token make_token(string str,enum pp_token_kind kind,bool space_before);
 
     //进行内置宏变量的宏替换
-    void inner_macro_var_replace(string macro_source);
+    struct pp_token inner_macro_var_replace(struct macro * m);
+
+    //展开源程序中的一个宏
+    size_t macro_expand_from_source(const string & source,size_t start,size_t pos,struct macro * m);
+
+    //展开上下文中的所有宏，直到正在展开的宏的栈和最下面的记号都扫描完
+    void macro_expand(struct macro_expand_context & context,vector<struct pp_token> & result);
+
+    //从上下文中读取下一个记号
+    bool next_token(struct macro_expand_context & context,struct pp_token & token,struct macro * & m,bool read_source);
+
+    //判断上下文中下一个记号是否是左括号
+    bool is_next_left_parentheses(struct macro_expand_context & context);
+
+    //开始展开一个宏
+    bool push_macro_expansion(struct macro_expand_context & context,const struct pp_token & name,struct macro * m);
+
+    //收集宏函数调用的实参
+    bool collect_macro_args(struct macro_expand_context & context,struct macro * m,vector<struct pp_token> & tokens,vector<pair<size_t,size_t> > & args);
+
+    //把一串记号变成字符串常量(#形参)
+    struct pp_token macro_stringify(const struct pp_token * tokens,size_t token_num,bool space_before);
+
+    //把两个记号拼接成一个记号(##)
+    void macro_paste(struct pp_token & lhs,const struct pp_token & rhs,vector<struct pp_token> & result);
+
+    //判断一串记号中是否有可以替换的宏
+    bool has_macro(const struct pp_token * tokens,size_t token_num) const;
+
+    //用实参替换宏的内容中的形参，并处理#和##
+    void macro_substitute(struct macro_expand_context & context,struct macro * m,const vector<struct pp_token> & tokens,const vector<pair<size_t,size_t> > & args,vector<struct pp_token> & result);
+
+    //在一个单独的上下文中完全展开一串记号
+    bool macro_expand_isolated(struct macro_expand_context & context,struct macro * m,const struct pp_token * tokens,size_t token_num,vector<struct pp_token> & result);
+
+    //把记号写到预处理之后的源程序中
+    void output_tokens(const vector<struct pp_token> & tokens);
 
 public:
     //Pre_processor的构造函数
@@ -122,6 +341,12 @@ public:
 
     //进行预处理
     bool pre_process(const char * source_program_filename,const char * source_program_after_pre_processor_filename);
+
+    //获取最近一次预处理之后的源程序
+    const string & get_source_program_after_pre_process() const
+    {
+        return source_program_after_pre_process_;
+    };
 };
 
 #endif //__PRE_PROCESSOR_H
\ No newline at end of file
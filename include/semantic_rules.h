@@ -13,6 +13,8 @@
 #include <map>
 #include <string>
 #include <utility>
+#include <cstdint>
+#include <stdexcept>
 
 #include "symbol_table.h"
 
@@ -104,39 +106,216 @@ union semantic_stack_node_member
     void * pointer_value;
 };
 
+//语法符号的属性
+//每一个属性对应语义栈结点中的一个固定的槽位，新增属性的时候只需要在SEMANTIC_ATTRIBUTE_NUM之前添加
+enum class semantic_attribute
+{
+    value,
+    id_string,
+    int_value,
+    float_value,
+    char_value,
+    string_value,
+    b_type,
+    unary_op,
+    dimensions_len,
+    init_values,
+    const_init_values,
+    var_def,
+    var_defs,
+    const_def,
+    const_defs,
+    f_param,
+    f_params,
+    r_params,
+    block_scope,
+    loop_label,
+    backpatching_codes,
+    and_backpatching_codes,
+    or_backpatching_codes,
+    break_backpatching_codes,
+    continue_backpatching_codes,
+    void_return_func_result,
+    SEMANTIC_ATTRIBUTE_NUM,                 //属性的个数
+};
+
+//语义栈的结点
+//每一个属性占据一个槽位，用attribute_mask中对应的位来表示这个结点是否具有该属性
+struct semantic_stack_node
+{
+    semantic_stack_node():attribute_mask(0)
+    {
+
+    };
+
+    //查看是否有某一个属性
+    inline bool has_attribute(enum semantic_attribute attribute) const
+    {
+        return (attribute_mask & (1u<<(size_t)attribute))!=0;
+    };
+
+    //获取某一个属性，如果该属性不存在，那么就新建一个值为0的该属性（和map的operator[]的行为一致）
+    inline union semantic_stack_node_member & operator[](enum semantic_attribute attribute)
+    {
+        if(!has_attribute(attribute))
+        {
+            attribute_mask|=(1u<<(size_t)attribute);
+            attributes[(size_t)attribute].long_value=0;
+        }
+        return attributes[(size_t)attribute];
+    };
+
+    //删除某一个属性
+    inline void erase(enum semantic_attribute attribute)
+    {
+        attribute_mask&=~(1u<<(size_t)attribute);
+    };
+
+    //把另一个结点中的属性复制过来，已经存在的属性不会被覆盖（和map的insert的行为一致）
+    inline void insert(const struct semantic_stack_node & source)
+    {
+        uint32_t new_attributes=source.attribute_mask & (~attribute_mask);
+        size_t attribute;
+        while(new_attributes)
+        {
+            attribute=__builtin_ctz(new_attributes);
+            attributes[attribute]=source.attributes[attribute];
+            new_attributes&=new_attributes-1;
+        }
+        attribute_mask|=source.attribute_mask;
+    };
+
+    //清空所有属性
+    inline void clear()
+    {
+        attribute_mask=0;
+    };
+
+    uint32_t attribute_mask;                                                                //属性的存在位图
+    union semantic_stack_node_member attributes[(size_t)semantic_attribute::SEMANTIC_ATTRIBUTE_NUM];    //属性的槽位
+};
+
+//获取语义栈中某一个位置的结点的某一个属性
+//如果该结点没有这个属性，那么就到它的下面一个结点中获取（不存在的时候会新建一个值为0的属性）
+inline union semantic_stack_node_member & get_semantic_stack_node_attribute(vector<struct semantic_stack_node> * semantic_stack,stack_index stack_pos,enum semantic_attribute attribute)
+{
+    struct semantic_stack_node & node=semantic_stack->at(stack_pos);
+    if(node.has_attribute(attribute))
+    {
+        return node.attributes[(size_t)attribute];
+    }
+    return semantic_stack->at(stack_pos-1)[attribute];
+}
+
+//语义动作中会用到的语法符号
+//语义动作中通过语法符号的名字来访问语义栈，这里给每一个名字分配一个编号，在加载文法的时候就把名字转换成编号
+//因为有一些终结符的名字是C++的关键字（如while，else），所以统一加上symbol_前缀
+enum class semantic_symbol
+{
+    symbol_COMP_UNIT,
+    symbol_DECL_or_FUNC_DEF,
+    symbol_DECL,
+    symbol_B_TYPE,
+    symbol_CONST_DECL,
+    symbol_one_or_more_CONST_DEF_divided_with_comma,
+    symbol_CONST_DEF,
+    symbol_zero_or_more_CONST_EXP_surrounded_by_bracket,
+    symbol_CONST_INIT_VAL,
+    symbol_zero_or_more_CONST_INIT_VAL_divided_with_comma,
+    symbol_VAR_DECL,
+    symbol_one_or_more_VAR_DEF_divided_with_comma,
+    symbol_VAR_DEF,
+    symbol_INIT_VAL,
+    symbol_zero_or_more_INIT_VAL_divided_with_comma,
+    symbol_FUNC_DEF,
+    symbol_FUNC_F_PARAMS,
+    symbol_one_or_more_FUNC_F_PARAM_divided_with_comma,
+    symbol_FUNC_F_PARAM,
+    symbol_zero_or_more_EXP_surrounded_by_bracket,
+    symbol_BLOCK,
+    symbol_zero_or_more_BLOCK_ITEM,
+    symbol_BLOCK_ITEM,
+    symbol_STMT,
+    symbol_JMP_STMT,
+    symbol_WHILE_STMT,
+    symbol_IF_STMT,
+    symbol_EXP,
+    symbol_COND,
+    symbol_L_VAL,
+    symbol_PRIMARY_EXP,
+    symbol_NUMBER,
+    symbol_UNARY_EXP,
+    symbol_UNARY_OP,
+    symbol_FUNC_R_PARAMS,
+    symbol_MUL_EXP,
+    symbol_ADD_EXP,
+    symbol_REL_EXP,
+    symbol_EQ_EXP,
+    symbol_L_AND_EXP,
+    symbol_L_OR_EXP,
+    symbol_CONST_EXP,
+    symbol_id,
+    symbol_const_int,
+    symbol_const_float,
+    symbol_while,
+    symbol_else,
+    SEMANTIC_SYMBOL_NUM,                    //语法符号的个数
+};
+
+//每一个产生式的语义动作的描述
+//在文法的构造函数中注册语义动作的时候生成，语义动作执行的时候直接按照编号获取语法符号在语义栈中的位置
+struct semantic_rule_descriptor
+{
+    semantic_rule_descriptor():stack_top_offset_between_before_and_after_reduce(0)
+    {
+
+    };
+
+    //规约完成之前和之后，栈顶的指针的差值+1（规约前栈顶指针减去规约后栈顶指针+1）
+    stack_index stack_top_offset_between_before_and_after_reduce;
+
+    //该语义动作用到的语法符号所在的语义栈中的位置距离栈顶的偏移量
+    //同一个语法符号在产生式中可能出现多次，按照出现的顺序（左部在前）依次存放
+    vector<stack_index> syntax_symbol_offsets_from_stack_top[(size_t)semantic_symbol::SEMANTIC_SYMBOL_NUM];
+};
+
+//语法分析时的全局信息(每一次语义翻译各自有一份)
+struct semantic_global_info
+{
+    semantic_global_info():data_type(language_data_type::VOID)
+    {
+
+    };
+
+    enum language_data_type data_type;
+};
+
 //语义动作
-typedef map<string,union semantic_stack_node_member> (*semantic_rule)(list<struct quaternion> * intermediate_codes,vector<map<string,union semantic_stack_node_member> > * semantic_stack,stack_index stack_top,Symbol_table * symbol_table);
+//语义动作的结果直接写入result中
+typedef void (*semantic_rule)(const struct semantic_rule_descriptor * descriptor,list<struct quaternion> * intermediate_codes,vector<struct semantic_stack_node> * semantic_stack,stack_index stack_top,Symbol_table * symbol_table,struct semantic_global_info * global_info,struct semantic_stack_node * result);
+
+//注册语义动作，生成该语义动作对应的产生式的描述
+void register_semantic_rule(struct semantic_rule_descriptor * descriptor,const string & left_string,const vector<string> & right_string,const string & right_next_string,const map<string,int> & terminators);
 
-//语义动作注册函数
-typedef void (*semantic_rule_register)(string left_string,vector<string> right_string,string right_next_string);
+//获取语义动作中的某一个语法符号在语义栈中的位置距离栈顶的偏移量
+//该语法符号不在语义动作对应的产生式中(或者出现的次数不够)的时候抛出异常，而不是越界访问
+inline stack_index get_syntax_symbol_offset_from_stack_top(const struct semantic_rule_descriptor * descriptor,enum semantic_symbol syntax_symbol,size_t index,const char * semantic_rule_name,const char * syntax_symbol_name)
+{
+    const vector<stack_index> & offsets=descriptor->syntax_symbol_offsets_from_stack_top[(size_t)syntax_symbol];
+    if(index>=offsets.size())
+    {
+        throw out_of_range(string("Semantic rule ")+semantic_rule_name+" uses syntax symbol "+syntax_symbol_name+" which is not in its production");
+    }
+    return offsets[index];
+}
 
 //定义语义动作函数
 #define define_semantic_rule(semantic_rule) \
-void semantic_rule##register(string left_string,vector<string> right_string,string right_next_string)\
-{\
-    string semantic_rule_name=#semantic_rule;\
-    if(right_next_string=="")\
-    {\
-        syntax_symbol_offset_from_stack_top_map[semantic_rule_name][left_string].push_back(right_string.size());\
-        stack_top_offset_between_before_and_after_reduce_map[semantic_rule_name]=right_string.size();\
-    }\
-    else\
-    {\
-        syntax_symbol_offset_from_stack_top_map[semantic_rule_name][left_string].push_back(right_string.size()+1);\
-        syntax_symbol_offset_from_stack_top_map[semantic_rule_name][right_next_string].push_back(0);\
-        stack_top_offset_between_before_and_after_reduce_map[semantic_rule_name]=0;\
-    }\
-    for(vector<string>::iterator i=right_string.begin();i!=right_string.end();i++)\
-    {\
-        syntax_symbol_offset_from_stack_top_map[semantic_rule_name][(*i)].push_back(right_string.end()-i);\
-    }\
-}\
-map<string,union semantic_stack_node_member> semantic_rule(list<struct quaternion> * intermediate_codes,vector<map<string,union semantic_stack_node_member> > * semantic_stack,stack_index stack_top,Symbol_table * symbol_table)\
+void semantic_rule(const struct semantic_rule_descriptor * descriptor,list<struct quaternion> * intermediate_codes,vector<struct semantic_stack_node> * semantic_stack,stack_index stack_top,Symbol_table * symbol_table,struct semantic_global_info * global_info,struct semantic_stack_node * result)\
 {\
-    string semantic_rule_name=#semantic_rule;\
+    const char * semantic_rule_name=#semantic_rule;\
     stack_index stack_pos,offset_from_stack_top;\
     union semantic_stack_node_member semantic_stack_node_member_tmp;\
-    map<string,union semantic_stack_node_member> result,semantic_stack_node_source;\
     bool error_tag=false;
 
 //结束语义动作函数的定义
@@ -146,25 +325,21 @@ error_out:\
     {\
         cout<<"Error while executing semantic rule "<<semantic_rule_name<<"!"<<endl;\
     }\
-    return result;\
 }
 
 //定义语义动作表的表项
 #define semantic_rules_entry(semantic_rule) {#semantic_rule,semantic_rule}
 
-//定义注册语义动作表的表项
-#define semantic_rule_registers_entry(semantic_rule) {#semantic_rule,semantic_rule##register}
+//定义语法符号表的表项
+#define semantic_symbols_entry(syntax_symbol) {#syntax_symbol,semantic_symbol::symbol_##syntax_symbol}
+
+//获取语义动作中的某一个语法符号在语义栈中的位置距离栈顶的偏移量
+#define syntax_symbol_offset_from_stack_top(syntax_symbol,index) \
+get_syntax_symbol_offset_from_stack_top(descriptor,semantic_symbol::symbol_##syntax_symbol,index,semantic_rule_name,#syntax_symbol)
 
 //获取语义栈中的某一个语法符号的某一个属性的值
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wunsequenced"
 #define get_syntax_symbol_attribute_by_index(syntax_symbol,attribute,type,index) \
-((semantic_stack->at(stack_pos=(stack_top-syntax_symbol_offset_from_stack_top_map[semantic_rule_name][#syntax_symbol][index])).find(#attribute)!=semantic_stack->at(stack_pos).end())?\
-((semantic_stack->at(stack_pos)[#attribute]).type##_value):\
-((semantic_stack->at(stack_pos-1).find(#attribute)!=semantic_stack->at(stack_pos-1).end())?\
-((semantic_stack->at(stack_pos-1)[#attribute]).type##_value):\
-(((semantic_stack->at(stack_pos-1)[#attribute]).type##_value))))
-#pragma clang diagnostic pop
+(get_semantic_stack_node_attribute(semantic_stack,stack_top-syntax_symbol_offset_from_stack_top(syntax_symbol,index),semantic_attribute::attribute).type##_value)
 
 //获取语义栈中的某一个语法符号的某一个属性的值
 #define get_syntax_symbol_attribute(syntax_symbol,attribute,type) \
@@ -173,13 +348,13 @@ get_syntax_symbol_attribute_by_index(syntax_symbol,attribute,type,0)
 //给语义栈中的某一个语法符号的某一个属性赋值
 #define set_syntax_symbol_attribute_by_index(syntax_symbol,attribute,type,index,value) \
 semantic_stack_node_member_tmp.type##_value=(value);\
-offset_from_stack_top=syntax_symbol_offset_from_stack_top_map[semantic_rule_name][#syntax_symbol][index];\
+offset_from_stack_top=syntax_symbol_offset_from_stack_top(syntax_symbol,index);\
 stack_pos=stack_top-offset_from_stack_top;\
-if(offset_from_stack_top==stack_top_offset_between_before_and_after_reduce_map[semantic_rule_name])\
+if(offset_from_stack_top==descriptor->stack_top_offset_between_before_and_after_reduce)\
 {\
-    result[#attribute]=semantic_stack_node_member_tmp;\
+    (*result)[semantic_attribute::attribute]=semantic_stack_node_member_tmp;\
 }\
-(semantic_stack->at(stack_pos)[#attribute])=semantic_stack_node_member_tmp
+(semantic_stack->at(stack_pos)[semantic_attribute::attribute])=semantic_stack_node_member_tmp
 
 //给语义栈中的某一个语法符号的某一个属性赋值
 #define set_syntax_symbol_attribute(syntax_symbol,attribute,type,value) \
@@ -187,14 +362,13 @@ set_syntax_symbol_attribute_by_index(syntax_symbol,attribute,type,0,value)
 
 //给语义栈中的某一个语法符号的所有属性复制一份给另一个语法符号
 #define copy_syntax_symbol_attribute_by_index(syntax_symbol_target,target_index,syntax_symbol_source,source_index) \
-semantic_stack_node_source=semantic_stack->at(stack_top-syntax_symbol_offset_from_stack_top_map[semantic_rule_name][#syntax_symbol_source][source_index]);\
-offset_from_stack_top=syntax_symbol_offset_from_stack_top_map[semantic_rule_name][#syntax_symbol_target][target_index];\
-stack_pos=stack_top-offset_from_stack_top;\
-if(offset_from_stack_top==stack_top_offset_between_before_and_after_reduce_map[semantic_rule_name])\
+stack_pos=stack_top-syntax_symbol_offset_from_stack_top(syntax_symbol_source,source_index);\
+offset_from_stack_top=syntax_symbol_offset_from_stack_top(syntax_symbol_target,target_index);\
+if(offset_from_stack_top==descriptor->stack_top_offset_between_before_and_after_reduce)\
 {\
-    result.insert(semantic_stack_node_source.begin(),semantic_stack_node_source.end());\
+    result->insert(semantic_stack->at(stack_pos));\
 }\
-semantic_stack->at(stack_pos).insert(semantic_stack_node_source.begin(),semantic_stack_node_source.end())
+semantic_stack->at(stack_top-offset_from_stack_top).insert(semantic_stack->at(stack_pos))
 
 //给语义栈中的某一个语法符号的所有属性复制一份给另一个语法符号
 #define copy_syntax_symbol_attributes(syntax_symbol_target,syntax_symbol_source) \
@@ -202,7 +376,7 @@ copy_syntax_symbol_attribute_by_index(syntax_symbol_target,0,syntax_symbol_sourc
 
 //查看语义栈中的某一个语法符号是否有某一个属性
 #define check_syntax_symbol_attribute_by_index(syntax_symbol,attribute,index) \
-(semantic_stack->at(stack_top-syntax_symbol_offset_from_stack_top_map[semantic_rule_name][#syntax_symbol][index]).count(#attribute)!=0)
+(semantic_stack->at(stack_top-syntax_symbol_offset_from_stack_top(syntax_symbol,index)).has_attribute(semantic_attribute::attribute))
 
 //查看语义栈中的某一个语法符号是否有某一个属性
 #define check_syntax_symbol_attribute(syntax_symbol,attribute) \
@@ -210,7 +384,7 @@ check_syntax_symbol_attribute_by_index(syntax_symbol,attribute,0)
 
 //删除语义栈中的某一个语法符号的某一个属性
 #define delete_syntax_symbol_attribute_by_index(syntax_symbol,attribute,index) \
-(semantic_stack->at(stack_top-syntax_symbol_offset_from_stack_top_map[semantic_rule_name][#syntax_symbol][index]).erase(#attribute))
+(semantic_stack->at(stack_top-syntax_symbol_offset_from_stack_top(syntax_symbol,index)).erase(semantic_attribute::attribute))
 
 //删除语义栈中的某一个语法符号的某一个属性
 #define delete_syntax_symbol_attribute(syntax_symbol,attribute) \
@@ -218,11 +392,11 @@ delete_syntax_symbol_attribute_by_index(syntax_symbol,attribute,0)
 
 //获取语法分析的时候的全局信息
 #define get_global_info(info_name) \
-global_info.info_name
+global_info->info_name
 
 //设置语法分析的时候的全局信息
 #define set_global_info(info_name,info_value) \
-global_info.info_name=info_value
+global_info->info_name=info_value
 
 //从符号表中获取一个变量的表项
 #define var(var_name) \
@@ -274,11 +448,11 @@ symbol_table->new_var(name,type,dimensions_len,const_array_value,true)
 
 //在符号表中定义一个非const的基本变量形参，并返回其在符号表中的表项指针
 #define def_f_param(name,type) \
-new struct ic_data(name,type,nullptr,false)
+symbol_table->new_f_param(name,type,nullptr,false)
 
 //在符号表中定义一个非const的数组变量形参，并返回其指针
 #define def_array_f_param(name,type,dimensions_len) \
-new struct ic_data(name,type,dimensions_len,false)
+symbol_table->new_f_param(name,type,dimensions_len,false)
 
 //在符号表中定义一个新的函数，返回其指针
 #define def_func(name,return_type,f_params) \
@@ -18,7 +18,9 @@
 #include<utility>
 #include<cstring>
 #include<stdarg.h>
+#include<mutex>
 #include"language.h"
+#include"arena.h"
 
 using namespace std;
 
@@ -50,20 +52,16 @@ enum class ic_data_type
 //包括基础变量和数组
 struct ic_data
 {
-    //用户定义的局部变量的构造函数
-    ic_data(string name,enum language_data_type data_type,list<struct ic_data * > * dimensions_len,OAA const_or_init_value,bool is_const):type(is_const?ic_data_type::LOCAL_CONST_VAR:ic_data_type::LOCAL_VAR),data_type(data_type),dimensions_len(dimensions_len),const_or_init_value(const_or_init_value),scope(nullptr)
+    //用户定义的局部变量的构造函数(name由符号表的分配器保存)
+    ic_data(const char * name,enum language_data_type data_type,list<struct ic_data * > * dimensions_len,OAA const_or_init_value,bool is_const):type(is_const?ic_data_type::LOCAL_CONST_VAR:ic_data_type::LOCAL_VAR),var_name(name),data_type(data_type),dimensions_len(dimensions_len),const_or_init_value(const_or_init_value),scope(nullptr)
     {
-        size_t name_size=name.size();
-        var_name=new char[name_size+1];
-        strcpy((char *)var_name,name.c_str());
+
     };
 
-    //函数形参的构造函数
-    ic_data(string name,enum language_data_type data_type,list<struct ic_data * > * dimensions_len,bool is_const):type(is_const?ic_data_type::CONST_FUNC_F_PARAM:ic_data_type::FUNC_F_PARAM),data_type(data_type),dimensions_len(dimensions_len),scope(nullptr)
+    //函数形参的构造函数(name由符号表的分配器保存)
+    ic_data(const char * name,enum language_data_type data_type,list<struct ic_data * > * dimensions_len,bool is_const):type(is_const?ic_data_type::CONST_FUNC_F_PARAM:ic_data_type::FUNC_F_PARAM),var_name(name),data_type(data_type),dimensions_len(dimensions_len),scope(nullptr)
     {
-        size_t name_size=name.size();
-        var_name=new char[name_size+1];
-        strcpy((char *)var_name,name.c_str());
+
     };
 
     //临时变量的构造函数
@@ -78,15 +76,15 @@ struct ic_data
 
     };
 
-    //数组元素的构造函数
-    ic_data(struct ic_data * array_var,size_t offset_dimension_lens,struct ic_data * offset):type(ic_data_type::ARRAY_MEMBER),var_name(array_var->var_name),data_type(array_var->data_type),scope(nullptr)
+    //数组元素的构造函数(pair和剩下的维度的长度都从符号表的分配器中分配)
+    ic_data(struct ic_data * array_var,size_t offset_dimension_lens,struct ic_data * offset,Arena & arena):type(ic_data_type::ARRAY_MEMBER),var_name(array_var->var_name),data_type(array_var->data_type),scope(nullptr)
     {
         size_t i=0;
-        pair<struct ic_data *,struct ic_data * > * tmp=new pair<struct ic_data *,struct ic_data * >;
+        pair<struct ic_data *,struct ic_data * > * tmp=arena.create<pair<struct ic_data *,struct ic_data * > >();
         list<struct ic_data * > * array_var_dimensions_len=array_var->dimensions_len;
         if(array_var_dimensions_len->size()>offset_dimension_lens)
         {
-            dimensions_len=new list<struct ic_data * >;
+            dimensions_len=arena.create<list<struct ic_data * > >();
             i=array_var_dimensions_len->size()-offset_dimension_lens;
             for(list<struct ic_data * >::reverse_iterator it=array_var_dimensions_len->rbegin();it!=array_var_dimensions_len->rend();it++)
             {
@@ -358,10 +356,10 @@ struct ic_func
         
     };
 
-    ic_func(string name,enum language_data_type return_type,size_t f_params_num,...):name(name),return_type(return_type),scope(nullptr)
+    //f_params是一个空的形参列表，之后的f_params_num个形参依次加入其中
+    ic_func(string name,enum language_data_type return_type,list<struct ic_data * > * f_params,size_t f_params_num,...):name(name),return_type(return_type),f_params(f_params),scope(nullptr)
     {
         struct ic_data * f_param;
-        f_params=new list<struct ic_data * >;
         va_list argptr;
 	    va_start(argptr,f_params_num);
         for(size_t i=0;i<f_params_num;i++)
@@ -562,18 +560,18 @@ set<struct ic_data * > ic_func::get_local_vars() const
 }
 
 //定义符号表
+//所有的表项(变量、常量、数组取元素、标签、函数和作用域)以及符号表自己建立的小的列表都从符号表的分配器中分配，
+//符号表销毁的时候一起释放，所以符号表必须比引用这些表项的对象晚销毁
+//生成汇编代码的时候只会添加常量和数组取元素表项，这两种表项的添加由符号表自己的互斥锁保护
 class Symbol_table
 {
 
 protected:
-    //单例类对象
-    static Symbol_table * instance_;
-
-    //构造函数
-    Symbol_table();
+    //所有表项的分配器
+    Arena arena_;
 
-    //析构函数
-    ~Symbol_table();
+    //添加常量和数组取元素表项时的互斥锁(按照函数并行生成汇编代码的时候多个线程会同时添加表项)
+    mutex entries_mutex_;
 
     //临时变量的个数
     size_t tmp_vars_num_;
@@ -597,21 +595,24 @@ protected:
     struct ic_scope * current_scope_;
 
 public:
-    //单例模式不应该有克隆构造函数
+    //构造函数
+    Symbol_table();
+
+    //析构函数
+    ~Symbol_table();
+
+    //符号表中的表项由符号表独占，不应该有克隆构造函数
     Symbol_table(Symbol_table & other) = delete;
     
-    //单例模式不应该重载赋值运算符
+    //符号表不应该重载赋值运算符
     void operator=(const Symbol_table &) = delete;
 
-    //获取单例对象的方法
-    static Symbol_table * get_instance();
-
-    //销毁单例类
-    static void delete_instance();
-
     //往符号表中添加一个用户定义的变量
     struct ic_data * new_var(string name,enum language_data_type data_type,list<struct ic_data * > * dimensions_len,OAA const_or_init_value,bool is_const);
 
+    //新建一个函数形参(加入作用域是在定义函数的时候进行的)
+    struct ic_data * new_f_param(string name,enum language_data_type data_type,list<struct ic_data * > * dimensions_len,bool is_const);
+
     //往符号表中添加一个临时变量
     struct ic_data * new_tmp_var(enum language_data_type data_type,list<struct ic_data * > * dimensions_len,OAA const_or_init_value,bool is_const);
 
@@ -18,42 +18,51 @@ using namespace std;
 class Syntax_directed_translator:public LR1_parser
 {
 private:
-    //语义栈(每一个map的键都是属性的字符串,值是属性值)
-    vector<map<string,union semantic_stack_node_member> > * semantic_stack_;
+    //语义栈(每一个结点中的属性按照semantic_attribute存放在固定的槽位中)
+    vector<struct semantic_stack_node> * semantic_stack_;
 
     //语义栈的栈顶指针
     stack_index stack_top_;
 
+    //在父类LR1_parser初始化之后初始化语义栈
+    bool init_semantic_stack(bool is_parser_init_success);
+
     //查看语义栈是否需要扩展
     void check_semantic_stack();
 
     //往语义栈中插入
-    void push_semantic_stack(map<string,union semantic_stack_node_member> semantic_stack_node_member);
+    void push_semantic_stack(const struct semantic_stack_node & semantic_stack_node);
 
     //往语义栈中插入
-    void push_semantic_stack(string key,union semantic_stack_node_member value);
+    void push_semantic_stack(enum semantic_attribute key,union semantic_stack_node_member value);
 
     //往语义栈中插入
     void push_semantic_stack();
 
     //从语义栈中弹出
-    void pop_semantic_stack();
+    void pop_semantic_stack(stack_index pop_num);
 
 public:
     //构造函数
     Syntax_directed_translator();
 
     //初始化
-    bool init(const char * productions_filename,const char * parser_table_filename,list<struct token * > * tokens,bool print_warning);
+    bool init(const char * productions_filename,const char * parser_table_filename,struct token_stream * tokens,bool print_warning,enum parser_table_type table_type=parser_table_type::CANONICAL_LR1);
+
+    //初始化，语义翻译的时候从词法分析器中逐个获取token
+    bool init(const char * productions_filename,const char * parser_table_filename,Lexical_analyzer * lexical_analyzer,bool print_warning,enum parser_table_type table_type=parser_table_type::CANONICAL_LR1);
+
+    //初始化，和一个已经初始化好的翻译器共享文法和语法分析表
+    bool init(const Syntax_directed_translator & prototype);
 
     //析构函数
     ~Syntax_directed_translator();
 
     //进行语义翻译
-    list<struct quaternion> * translate();
+    list<struct quaternion> * translate(Symbol_table * symbol_table);
 
     //进行语义翻译并将中间代码进行输出
-    list<struct quaternion> * translate_then_output(const char * filename);
+    list<struct quaternion> * translate_then_output(const char * filename,Symbol_table * symbol_table);
 };
 
 #endif //__SYNTAX_DIRECTED_TRANSLATOR_H
\ No newline at end of file
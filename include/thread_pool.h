@@ -0,0 +1,61 @@
+/*
+ *
+ *  thread_pool.h
+ *  并行执行任务的工具
+ *  Creator:Sichao Chen
+ *  Create time:2026/10/18
+ *
+*/
+#ifndef __THREAD_POOL_H
+#define __THREAD_POOL_H
+
+#include<iostream>
+#include<streambuf>
+#include<string>
+
+using namespace std;
+
+//并行执行的任务，index是任务的编号，data是所有任务共享的数据
+typedef void (*parallel_task)(size_t index,void * data);
+
+//用thread_num个线程并行执行编号为0到task_num-1的所有任务(thread_num不超过1的时候直接在当前线程中依次执行)
+void parallel_for(size_t task_num,size_t thread_num,parallel_task task,void * data);
+
+//获取机器上可以同时运行的线程个数
+size_t get_hardware_thread_num();
+
+//按照线程重定向的输出缓冲区
+//安装到cout上之后，调用过redirect的线程的输出会写到该线程自己的字符串中，其余线程的输出仍然写到原来的缓冲区中
+//这样并行编译的时候各个源程序的诊断信息不会交错在一起，可以在编译完成之后按照源程序的顺序输出
+class Thread_output_buf:public streambuf
+{
+
+protected:
+    //当前线程的输出要写到的字符串(为nullptr表示写到原来的缓冲区中)
+    static thread_local string * thread_output_;
+
+    //原来的缓冲区
+    streambuf * default_buf_;
+
+    //写入一个字符
+    int overflow(int ch);
+
+    //写入一个字符串
+    streamsize xsputn(const char * s,streamsize n);
+
+    //刷新缓冲区
+    int sync();
+
+public:
+    //构造函数
+    Thread_output_buf(streambuf * default_buf);
+
+    //析构函数
+    ~Thread_output_buf();
+
+    //把当前线程的输出重定向到output中(为nullptr表示恢复写到原来的缓冲区中)
+    static void redirect(string * output);
+
+};
+
+#endif //__THREAD_POOL_H
@@ -0,0 +1,98 @@
+/*
+ *
+ *  time_report.h
+ *  编译各个阶段的耗时、内存和计数统计
+ *  Creator:Sichao Chen
+ *  Create time:2026/10/18
+ *
+*/
+#ifndef __TIME_REPORT_H
+#define __TIME_REPORT_H
+
+#include<iostream>
+#include<string>
+#include<vector>
+#include<chrono>
+
+using namespace std;
+
+//编译过程中的一个阶段的统计信息
+struct time_report_stage
+{
+    time_report_stage(string name,size_t depth):name(name),depth(depth),wall_seconds(0),cpu_seconds(0),peak_rss_kb(0),cpu_start(0),is_done(false)
+    {
+
+    };
+
+    string name;                                        //阶段名
+    size_t depth;                                       //阶段的嵌套深度(0表示最外层的阶段)
+    double wall_seconds;                                //墙上时间
+    double cpu_seconds;                                 //CPU时间
+    long peak_rss_kb;                                   //阶段结束时进程的内存峰值(KB)
+    chrono::steady_clock::time_point wall_start;        //阶段开始时的墙上时间
+    double cpu_start;                                   //阶段开始时的CPU时间
+    bool is_done;                                       //阶段是否已经结束
+};
+
+//编译统计报告
+//安装到一个线程上之后，该线程中各个阶段的begin_stage/end_stage和add_counter都会记录到这个报告中
+//没有安装报告的线程调用这些函数时什么都不做，所以在编译器的各个阶段中打点不会影响正常编译的速度
+class Time_report
+{
+
+protected:
+    //当前线程正在记录的报告(为nullptr表示不记录)
+    static thread_local Time_report * current_;
+
+    //所有的阶段(按照开始的顺序)
+    vector<struct time_report_stage> stages_;
+
+    //还没有结束的阶段在stages_中的下标
+    vector<size_t> open_stages_;
+
+    //所有的计数器(按照第一次出现的顺序)
+    vector<pair<string,size_t> > counters_;
+
+    //整个报告的统计信息
+    struct time_report_stage total_;
+
+    //结束一个阶段
+    void end_stage(struct time_report_stage & stage);
+
+public:
+    //构造函数
+    Time_report();
+
+    //析构函数
+    ~Time_report();
+
+    //把当前线程的统计记录到report中(为nullptr表示不再记录)
+    static void install(Time_report * report);
+
+    //获取当前线程正在记录的报告
+    static Time_report * get_current();
+
+    //开始一个阶段，在上一个还没有结束的阶段中开始的阶段是它的子阶段
+    static void begin_stage(const char * name);
+
+    //结束最近开始的阶段
+    static void end_stage();
+
+    //给计数器加上value
+    static void add_counter(const char * name,size_t value);
+
+    //把另一个报告的计数器加到这个报告中
+    void merge_counters(const Time_report & other);
+
+    //结束所有的阶段和整个报告
+    void finish();
+
+    //以表格的形式输出
+    void output_table(ostream & out) const;
+
+    //以JSON的形式输出到文件中
+    bool output_json(const char * filename,string source_program_filename) const;
+
+};
+
+#endif //__TIME_REPORT_H
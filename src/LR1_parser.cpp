@@ -9,21 +9,51 @@
 #include<fstream>
 #include<iostream>
 #include<algorithm>
+#include<chrono>
+#include<string.h>
+#include<fcntl.h>
+#include<unistd.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
 
 #include "LR1_parser.h"
+#include "time_report.h"
 
 //文法的终结符的个数(包括空符号和栈底符号)
 extern int terminator_num;
 
+//FNV-1a哈希的初始值和乘数
+#define FNV1A_64_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV1A_64_PRIME 0x100000001b3ULL
+
+//语法分析表文件中压缩之后的分析表相对于文件开头的偏移(按照8字节对齐)
+#define LR1_TABLE_FILE_PACKED_TABLE_OFFSET(production_num) ((sizeof(struct LR1_table_file_header)+(production_num)*2*sizeof(int32_t)+7)&(~(size_t)7))
+
+//压缩之后的分析表占用的字节数
+#define PACKED_TABLE_SIZE(state_num,syntax_variable_num,action_size,goto_size) \
+(((size_t)(state_num)+(syntax_variable_num))*sizeof(int32_t)+((size_t)(state_num)+2*(size_t)(action_size)+(syntax_variable_num)+2*(size_t)(goto_size))*sizeof(uint16_t))
+
+//将action表项压缩成packed_action_entry
+#define PACK_ACTION_ENTRY(entry) ((packed_action_entry)((((int)(entry).movement)<<PACKED_ACTION_MOVEMENT_SHIFT)|(((entry).index<0)?0:(entry).index)))
+
 /*
 LR1_parser构造函数
 */
 LR1_parser::LR1_parser()
 {
     tokens_=nullptr;
+    next_token_index_=0;
+    lexical_analyzer_=nullptr;
+    strings_=nullptr;
     grammer_=nullptr;
+    prototype_=nullptr;
     action_=nullptr;
     goto_=nullptr;
+    table_type_=parser_table_type::CANONICAL_LR1;
+    memset(&packed_table_,0,sizeof(packed_table_));
+    packed_table_buf_=nullptr;
+    table_file_map_=nullptr;
+    table_file_map_size_=0;
 }
 
 /*
@@ -33,10 +63,17 @@ Parameters
 ----------
 productions_filename:保存产生式的文件
 parser_table_filename:保存语法分析表的文件，如果为nullptr表示不保存此次建立的语法分析表
+                      如果该文件中的语法分析表和当前的文法一致，就直接使用该文件中的语法分析表，否则重新建立并保存
 tokens:词法分析输出的所有tokens
+print_warning:是否打印构造语法分析表时产生的冲突信息
+table_type:语法分析表的构造方式
 */
-bool LR1_parser::init(const char * productions_filename,const char * parser_table_filename,list<struct token * > * tokens,bool print_warning)
+bool LR1_parser::init(const char * productions_filename,const char * parser_table_filename,struct token_stream * tokens,bool print_warning,enum parser_table_type table_type)
 {
+    uint64_t grammer_hash=0;
+
+    table_type_=table_type;
+
     //先构造终结符字典
     extern map<string,enum code_of_kind> key_word;
     map<string,syntax_symbol_index> terminators=TERMINATOR_NOT_IN_KEY_WORD;
@@ -48,9 +85,14 @@ bool LR1_parser::init(const char * productions_filename,const char * parser_tabl
 
     //构造tokens
     tokens_=tokens;
+    next_token_index_=0;
+    lexical_analyzer_=nullptr;
+    strings_=tokens?(&tokens->strings):nullptr;
 
     //构造拓广文法
+    Time_report::begin_stage("grammer load");
     grammer_=new Grammer(productions_filename,terminators,true);
+    Time_report::end_stage();
 
     if(!grammer_->is_init_success())
     {
@@ -62,9 +104,33 @@ bool LR1_parser::init(const char * productions_filename,const char * parser_tabl
         return false;
     }
 
-    //再根据拓广文法把action和goto表建出来
+    //计算每一个产生式右部的长度，归约的时候直接使用
+    production_right_sizes_.clear();
+    for(auto i : *grammer_->productions_)
+    {
+        production_right_sizes_.push_back(sizeof_production_right(i->right));
+    }
+
+    //如果之前保存的语法分析表和当前的文法一致，那么就直接使用之前保存的语法分析表
+    if(parser_table_filename!=nullptr)
+    {
+        Time_report::begin_stage("parser table load");
+        grammer_hash=hash_grammer(productions_filename,terminators);
+        if(load_LR1_table(parser_table_filename,grammer_hash))
+        {
+            Time_report::end_stage();
+            Time_report::add_counter("productions",grammer_->productions_->size());
+            Time_report::add_counter("LR(1) states",state_num_);
+            return true;
+        }
+        Time_report::end_stage();
+    }
+
+    //否则再根据拓广文法把action和goto表建出来
+    Time_report::begin_stage("LR(1) table build");
     if(!build_LR1_table(print_warning))
     {
+        Time_report::end_stage();
         cout<<"Build action and goto table error!"<<endl;
         delete grammer_;
         free(action_);
@@ -75,15 +141,127 @@ bool LR1_parser::init(const char * productions_filename,const char * parser_tabl
         return false;
     }
 
-    //保存action和goto表
-    if(parser_table_filename!=nullptr)
+    Time_report::end_stage();
+
+    //压缩action和goto表，语法分析的时候使用压缩之后的表
+    Time_report::begin_stage("parser table pack");
+    if(!pack_LR1_table())
     {
-        
+        Time_report::end_stage();
+        cout<<"Pack action and goto table error!"<<endl;
+        delete grammer_;
+        free(action_);
+        free(goto_);
+        grammer_=nullptr;
+        action_=nullptr;
+        goto_=nullptr;
+        return false;
+    }
+
+    Time_report::end_stage();
+    Time_report::add_counter("productions",grammer_->productions_->size());
+    Time_report::add_counter("LR(1) states",state_num_);
+
+    //保存压缩之后的action和goto表
+    if(parser_table_filename!=nullptr && !save_LR1_table(parser_table_filename,grammer_hash))
+    {
+        cout<<"Warning: Save action and goto table to "<<parser_table_filename<<" error!"<<endl;
     }
 
     return true;
 }
 
+/*
+LR1_parser初始化
+语法分析的时候每次需要下一个token才从词法分析器中获取，不需要先保存所有的token
+
+Parameters
+----------
+productions_filename:保存产生式的文件
+parser_table_filename:保存语法分析表的文件(同上)
+lexical_analyzer:已经初始化好的词法分析器，在语法分析结束之前不能被释放
+print_warning:是否打印构造语法分析表时产生的冲突信息
+table_type:语法分析表的构造方式
+*/
+bool LR1_parser::init(const char * productions_filename,const char * parser_table_filename,Lexical_analyzer * lexical_analyzer,bool print_warning,enum parser_table_type table_type)
+{
+    bool res=init(productions_filename,parser_table_filename,(struct token_stream *)nullptr,print_warning,table_type);
+
+    lexical_analyzer_=lexical_analyzer;
+    strings_=lexical_analyzer->get_string_table();
+
+    return res;
+}
+
+/*
+LR1_parser初始化
+和一个已经初始化好的语法分析器共享文法和压缩之后的语法分析表，不需要重新建立
+文法和语法分析表在语法分析的时候是只读的，所以多个线程中的语法分析器可以共享同一个原型
+之后需要用set_tokens设置要进行语法分析的token序列
+
+Parameters
+----------
+prototype:已经初始化好的语法分析器，在该语法分析器被释放之前不能被释放
+
+Return
+------
+原型初始化成功返回true，否则返回false
+*/
+bool LR1_parser::init(const LR1_parser & prototype)
+{
+    if(!prototype.grammer_)
+    {
+        return false;
+    }
+
+    table_type_=prototype.table_type_;
+    tokens_=nullptr;
+    next_token_index_=0;
+    lexical_analyzer_=nullptr;
+    strings_=nullptr;
+    grammer_=prototype.grammer_;
+    prototype_=&prototype;
+    production_right_sizes_=prototype.production_right_sizes_;
+    packed_table_=prototype.packed_table_;
+    state_num_=prototype.state_num_;
+
+    return is_init_success();
+}
+
+/*
+更换要进行语法分析的token序列
+文法和语法分析表只在init的时候建立一次，之后可以用同一个语法分析器依次分析多个源程序
+
+Parameters
+----------
+tokens:词法分析输出的所有tokens(由语法分析器负责释放)
+*/
+void LR1_parser::set_tokens(struct token_stream * tokens)
+{
+    if(tokens_ && tokens_!=tokens)
+    {
+        delete tokens_;
+    }
+    tokens_=tokens;
+    next_token_index_=0;
+    lexical_analyzer_=nullptr;
+    strings_=tokens?(&tokens->strings):nullptr;
+}
+
+/*
+更换语法分析时获取token的词法分析器
+
+Parameters
+----------
+lexical_analyzer:已经初始化好的词法分析器，在语法分析结束之前不能被释放
+*/
+void LR1_parser::set_tokens(Lexical_analyzer * lexical_analyzer)
+{
+    set_tokens((struct token_stream *)nullptr);
+    lexical_analyzer_=lexical_analyzer;
+    strings_=lexical_analyzer->get_string_table();
+}
+
 /*
 LR1_parser析构函数
 */
@@ -92,15 +270,11 @@ LR1_parser::~LR1_parser()
     //删除词法分析得到的tokens
     if(tokens_)
     {
-        for(auto i : *tokens_)
-        {
-            delete i;
-        }
         delete tokens_;
     }
 
-    //删除文法
-    if(grammer_)
+    //删除文法(和原型共享的文法由原型释放)
+    if(grammer_ && !prototype_)
     {
         delete grammer_;
     }
@@ -111,16 +285,30 @@ LR1_parser::~LR1_parser()
         delete (*i);
     }
 
-    //删除action表
-    if(action_)
+    if(table_file_map_)
     {
-        free(action_);
+        //action表和goto表是从文件中映射进来的，直接解除映射即可
+        munmap(table_file_map_,table_file_map_size_);
     }
-
-    //删除goto表
-    if(goto_)
+    else
     {
-        free(goto_);
+        //删除action表
+        if(action_)
+        {
+            free(action_);
+        }
+
+        //删除goto表
+        if(goto_)
+        {
+            free(goto_);
+        }
+
+        //删除压缩之后的action表和goto表
+        if(packed_table_buf_)
+        {
+            free(packed_table_buf_);
+        }
     }
 
 }
@@ -130,7 +318,7 @@ LR1_parser::~LR1_parser()
 */
 bool LR1_parser::is_init_success()
 {
-    return (action_!=nullptr && goto_!=nullptr);
+    return (packed_table_.action_value!=nullptr && packed_table_.goto_value!=nullptr);
 }
 
 /*
@@ -147,144 +335,337 @@ Return
 */
 canonical_LR1_index LR1_parser::closure(set<struct LR1_item> I)
 {
-    int old_size=0,right_size;
+    int right_size;
     set<struct LR1_item> * result;
     syntax_symbol_index B;
-    vector<syntax_symbol_index> right,string;
-    set<syntax_symbol_index> first;
+    pair<production_index,int> core;
+    terminator_set first;
+    map<pair<production_index,int>,terminator_set> lookaheads;
+    queue<pair<production_index,int> > work_queue;
     vector<struct production * > * productions=grammer_->productions_;
+    unordered_map<set<struct LR1_item>,canonical_LR1_index,LR1_item_set_hash>::iterator kernel;
 
     if(I.empty())
     {
         return -1;
     }
 
-    //先进行构造
-    result=new set<struct LR1_item>(I.begin(),I.end());
-    while(old_size!=result->size())
+    //闭包是由项目集的核唯一确定的，因此先根据核查看这个闭包是否已经存在于LR(1)的项目集规范族内
+    //如果已经存在的话就直接返回原本的位置索引，不需要再构造一遍闭包
+    kernel=canonical_LR1_kernel_map_.find(I);
+    if(kernel!=canonical_LR1_kernel_map_.end())
     {
-        old_size=result->size();
+        return kernel->second;
+    }
 
-        for(set<struct LR1_item>::iterator i=result->begin();i!=result->end();i++)
+    //先进行构造
+    //把具有相同的产生式和圆点位置的项目的搜索符合并成一个位图，每当某一个(产生式,圆点位置)的搜索符集合变大时就把它加入工作队列
+    for(auto & i : I)
+    {
+        core=make_pair(i.production,i.dot_position);
+        if(lookaheads.find(core)==lookaheads.end())
         {
-            right=productions->at((*i).production)->right;
-
-            right_size=sizeof_production_right(right);
+            work_queue.push(core);
+        }
+        lookaheads[core].set(i.lookahead_symbol);
+    }
+    while(!work_queue.empty())
+    {
+        core=work_queue.front();
+        work_queue.pop();
 
-            if((*i).dot_position>=right_size)
-            {
-                continue;
-            }
-            B=right[(*i).dot_position];
-            if(B>=grammer_->terminator_num_)
+        const vector<syntax_symbol_index> & right=productions->at(core.first)->right;
+        right_size=production_right_sizes_[core.first];
+        if(core.second>=right_size)
+        {
+            continue;
+        }
+        B=right[core.second];
+        if(B>=grammer_->terminator_num_)
+        {
+            //对于项目[A->α.Bβ,a]，FIRST(βa)中的每一个终结符b都要作为项目[B->.γ,b]的搜索符
+            first=grammer_->suffix_first(core.first,core.second+1,lookaheads[core]);
+            for(auto j : grammer_->productions_by_left_[B-grammer_->terminator_num_])
             {
-                if(right.begin()+(*i).dot_position!=right.end())
+                terminator_set & j_lookaheads=lookaheads[make_pair(j,0)];
+                if((first&~j_lookaheads).any())
                 {
-                    string.assign(right.begin()+((*i).dot_position+1),right.end());
-                }
-                string.push_back((*i).lookahead_symbol);
-                first=grammer_->string_first(string);
-                for(production_index j=0;j<productions->size();j++)
-                {
-                    if(productions->at(j)->left==B)
-                    {
-                        for(set<syntax_symbol_index>::iterator k=first.begin();k!=first.end();k++)
-                        {
-                            result->insert({j,0,(*k)});
-                        }
-                    }
+                    j_lookaheads|=first;
+                    work_queue.push(make_pair(j,0));
                 }
             }
         }
     }
-
-    //然后查看构造之后的闭包是否已经存在于LR(1)的项目集规范族内，如果已经存在的话就返回原本的位置索引
-    for(canonical_LR1_index i=0;i<canonical_LR1_collection_.size();i++)
+    result=new set<struct LR1_item>;
+    for(auto & i : lookaheads)
     {
-        if((*(canonical_LR1_collection_[i]))==*result)
+        for(terminator_index j=0;j<grammer_->terminator_num_;j++)
         {
-            delete result;
-            return i;
+            if(i.second.test(j))
+            {
+                result->insert({i.first.first,i.first.second,j});
+            }
         }
     }
 
-    //如果不存在的话将新构造的闭包加入LR(1)的项目集规范族
+    //将新构造的闭包加入LR(1)的项目集规范族，并以它的核为键建立索引
     canonical_LR1_collection_.push_back(result);
+    canonical_LR1_kernel_map_.insert(make_pair(I,canonical_LR1_collection_.size()-1));
 
     return canonical_LR1_collection_.size()-1;
 }
 
 /*
-计算从一个LR(1)项目闭包经过某一个输入字符之后可以到达的项目闭包
-并把这个项目比闭包加入项目集规范族中
+计算从一个LR(1)项目闭包经过各个输入字符之后可以到达的项目闭包
+并把这些项目闭包加入项目集规范族中，同时记录到闭包转移表中
 
 Parameters
 ----------
 I_index:要计算的项目闭包的编号(其实就是这个项目集在LR(1)规范项目集中的位置)
-X:输入的语法符号
-
-Return
-------
-可以到达的项目闭包的编号(其实就是这个项目集在LR(1)规范项目集中的位置),如果到达不了任何的项目集就返回-1
 */
-canonical_LR1_index LR1_parser::go(canonical_LR1_index I_index,syntax_symbol_index X)
+void LR1_parser::go(canonical_LR1_index I_index)
 {
-    canonical_LR1_index result;
-    set<struct LR1_item> J;
+    map<syntax_symbol_index,set<struct LR1_item> > J;
     vector<struct production * > * productions=grammer_->productions_;
     set<struct LR1_item> * I=canonical_LR1_collection_[I_index];
-    vector<syntax_symbol_index> right;
     unsigned int right_size;
+
+    //只需要遍历一遍项目集，就可以把经过各个输入字符之后得到的项目集的核都求出来
     for(set<struct LR1_item>::iterator i=I->begin();i!=I->end();i++)
     {
-        right=productions->at((*i).production)->right;
-        right_size=sizeof_production_right(right);
-        if(right_size>(*i).dot_position && right[(*i).dot_position]==X)
+        const vector<syntax_symbol_index> & right=productions->at((*i).production)->right;
+        right_size=production_right_sizes_[(*i).production];
+        if(right_size>(*i).dot_position)
         {
-            J.insert({(*i).production,(*i).dot_position+1,(*i).lookahead_symbol});
+            J[right[(*i).dot_position]].insert({(*i).production,(*i).dot_position+1,(*i).lookahead_symbol});
         }
     }
 
-    //求闭包
-    result=closure(J);
-
-    if(result!=-1)
+    //按照输入字符从小到大的顺序求闭包，并将闭包的转移情况加入闭包转移表中
+    for(auto & i : J)
     {
-        //将这个闭包的转移情况加入闭包转移表中
-        canonical_LR1_go_table_[I_index][X]=result;
+        canonical_LR1_go_table_[I_index][i.first]=closure(i.second);
     }
-
-    return result;
 }
 
 /*
 构造LR(1)项目集规范族
-
-Return
-------
-LR(1)项目集规范族
+项目集规范族本身就是一个工作队列，每一个新加入的项目集只会被处理一次
 */
 void LR1_parser::build_canonical_LR1_collection()
 {
     set<struct LR1_item> I;
-    int old_size=0;
 
     //构造一个只有第一个项目的[S'->.S,#]的闭包,并将其加入LR(1)项目集规范族闭包
     I.insert({0,0,grammer_->stack_bottom_symbol_});
     closure(I);
 
-    //不断扩大LR1项目集规范族，直到其大小不再发生改变为止
-    while(old_size!=canonical_LR1_collection_.size())
+    //按照加入的顺序依次处理项目集，go过程中新产生的项目集会被加到项目集规范族的末尾，直到没有新的项目集产生为止
+    for(canonical_LR1_index i=0;i<canonical_LR1_collection_.size();i++)
+    {
+        go(i);
+    }
+
+    //构造完成之后就不再需要索引了
+    canonical_LR1_kernel_map_.clear();
+}
+
+/*
+求出LR(1)项目集规范族中的每一个项目集的核心(即去掉搜索符之后的项目集)的编号
+核心按照其第一次在项目集规范族中出现的顺序进行编号
+
+Return
+------
+每一个项目集的核心的编号
+*/
+vector<canonical_LR1_index> LR1_parser::get_LR1_collection_cores()
+{
+    map<set<pair<production_index,int> >,canonical_LR1_index> cores;
+    set<pair<production_index,int> > core;
+    vector<canonical_LR1_index> res(canonical_LR1_collection_.size());
+
+    for(canonical_LR1_index i=0;i<canonical_LR1_collection_.size();i++)
+    {
+        core.clear();
+        for(auto & j : *canonical_LR1_collection_[i])
+        {
+            core.insert(make_pair(j.production,j.dot_position));
+        }
+        res[i]=cores.insert(make_pair(core,(canonical_LR1_index)cores.size())).first->second;
+    }
+
+    return res;
+}
+
+/*
+按照给定的编号合并LR(1)项目集规范族中的项目集，同时对闭包转移表进行重新编号
+
+Parameters
+----------
+merged_index:每一个项目集合并之后的编号(合并之后的编号必须是从0开始连续的)
+*/
+void LR1_parser::merge_LR1_collection(const vector<canonical_LR1_index> & merged_index)
+{
+    vector<set<struct LR1_item> * > merged_collection;
+    map<canonical_LR1_index,map<syntax_symbol_index,canonical_LR1_index> > merged_go_table;
+
+    for(canonical_LR1_index i=0;i<canonical_LR1_collection_.size();i++)
+    {
+        if(merged_index[i]==merged_collection.size())
+        {
+            merged_collection.push_back(canonical_LR1_collection_[i]);
+        }
+        else
+        {
+            merged_collection[merged_index[i]]->insert(canonical_LR1_collection_[i]->begin(),canonical_LR1_collection_[i]->end());
+            delete canonical_LR1_collection_[i];
+        }
+    }
+
+    for(auto & i : canonical_LR1_go_table_)
+    {
+        for(auto & j : i.second)
+        {
+            merged_go_table[merged_index[i.first]][j.first]=merged_index[j.second];
+        }
+    }
+
+    canonical_LR1_collection_.swap(merged_collection);
+    canonical_LR1_go_table_.swap(merged_go_table);
+}
+
+/*
+合并规范LR(1)分析表中同心并且动作相容的状态
+两个状态的动作相容是指它们在同一个语法符号上的动作要么有一个是ERROR，要么完全相同(移进和goto要转移到同一个合并之后的状态)
+因此合并之后不会引入新的冲突，对于正确的输入，语法分析的过程和结果都和规范LR(1)分析表完全相同
+合并之后的状态按照其中第一个状态在原来的分析表中出现的顺序进行编号
+*/
+void LR1_parser::merge_compatible_LR1_states()
+{
+    int terminator_num=grammer_->terminator_num_,syntax_variable_num=grammer_->syntax_variable_num_;
+    vector<canonical_LR1_index> merged_index=get_LR1_collection_cores(),new_merged_index(state_num_);
+    int merged_num=-1,new_merged_num;
+    vector<vector<int> > rows;
+    vector<vector<canonical_LR1_index> > groups;
+    vector<int> row(terminator_num+syntax_variable_num);
+    struct action_entry entry,* merged_action;
+    goto_entry * merged_goto;
+    bool compatible;
+
+    //一开始先把同心的状态放在同一组中，然后不断地在每一组中把动作相容的状态分到同一个子组中
+    //直到组的个数不再增加为止(此时同一组中的状态经过同一个语法符号之后到达的状态也都在同一组中)
+    while(true)
+    {
+        new_merged_num=0;
+        rows.clear();
+        groups.assign(state_num_,vector<canonical_LR1_index>());
+        for(state i=0;i<state_num_;i++)
+        {
+            //在当前的分组之下把状态的动作编码成整数，-1表示ERROR
+            for(int j=0;j<terminator_num;j++)
+            {
+                entry=action_[terminator_num*i+j];
+                switch(entry.movement)
+                {
+                    case action_movement::SHIFT:
+                        row[j]=merged_index[entry.index]*3;
+                        break;
+                    case action_movement::REDUCE:
+                        row[j]=entry.index*3+1;
+                        break;
+                    case action_movement::ACCEPT:
+                        row[j]=2;
+                        break;
+                    default:
+                        row[j]=-1;
+                        break;
+                }
+            }
+            for(int j=0;j<syntax_variable_num;j++)
+            {
+                row[terminator_num+j]=(goto_[syntax_variable_num*i+j]==-1)?-1:merged_index[goto_[syntax_variable_num*i+j]];
+            }
+
+            //找到同一组中第一个和它相容的子组，如果找不到就新建一个子组
+            new_merged_index[i]=-1;
+            for(auto j : groups[merged_index[i]])
+            {
+                compatible=true;
+                for(int k=0;k<row.size() && compatible;k++)
+                {
+                    compatible=(row[k]==-1 || rows[j][k]==-1 || row[k]==rows[j][k]);
+                }
+                if(compatible)
+                {
+                    new_merged_index[i]=j;
+                    break;
+                }
+            }
+            if(new_merged_index[i]==-1)
+            {
+                new_merged_index[i]=new_merged_num++;
+                rows.push_back(row);
+                groups[merged_index[i]].push_back(new_merged_index[i]);
+            }
+            else
+            {
+                for(int k=0;k<row.size();k++)
+                {
+                    if(row[k]!=-1)
+                    {
+                        rows[new_merged_index[i]][k]=row[k];
+                    }
+                }
+            }
+        }
+        merged_index.swap(new_merged_index);
+        if(new_merged_num==merged_num)
+        {
+            break;
+        }
+        merged_num=new_merged_num;
+    }
+
+    //根据分组建立合并之后的action表和goto表
+    merged_action=(struct action_entry *)malloc(merged_num*terminator_num*sizeof(struct action_entry));
+    merged_goto=(goto_entry *)malloc(merged_num*syntax_variable_num*sizeof(goto_entry));
+    for(int i=0;i<merged_num*terminator_num;i++)
+    {
+        merged_action[i]={action_movement::ERROR,-1};
+    }
+    for(int i=0;i<merged_num*syntax_variable_num;i++)
+    {
+        merged_goto[i]=-1;
+    }
+    for(state i=0;i<state_num_;i++)
     {
-        old_size=canonical_LR1_collection_.size();
-        for(canonical_LR1_index i=0;i<canonical_LR1_collection_.size();i++)
+        for(int j=0;j<terminator_num;j++)
+        {
+            entry=action_[terminator_num*i+j];
+            if(entry.movement==action_movement::SHIFT)
+            {
+                entry.index=merged_index[entry.index];
+            }
+            if(entry.movement!=action_movement::ERROR)
+            {
+                merged_action[terminator_num*merged_index[i]+j]=entry;
+            }
+        }
+        for(int j=0;j<syntax_variable_num;j++)
         {
-            for(syntax_symbol_index j=0;j<grammer_->syntax_symbol_num_;j++)
+            if(goto_[syntax_variable_num*i+j]!=-1)
             {
-                go(i,j);
+                merged_goto[syntax_variable_num*merged_index[i]+j]=merged_index[goto_[syntax_variable_num*i+j]];
             }
         }
     }
+    free(action_);
+    free(goto_);
+    action_=merged_action;
+    goto_=merged_goto;
+    state_num_=merged_num;
+
+    merge_LR1_collection(merged_index);
 }
 
 /*
@@ -553,6 +934,12 @@ bool LR1_parser::build_LR1_table(bool print_warning)
     //先把LR(1)项目集规范族建出来
     build_canonical_LR1_collection();
 
+    //如果要构造的是LALR(1)分析表，就把同心的项目集合并起来
+    if(table_type_==parser_table_type::LALR1)
+    {
+        merge_LR1_collection(get_LR1_collection_cores());
+    }
+
     //LR(1)分析表的状态个数
     state_num_=canonical_LR1_collection_.size();
 
@@ -697,58 +1084,546 @@ bool LR1_parser::build_LR1_table(bool print_warning)
         cout<<goto_[i]<<endl;
     }*/
 
+    //如果要构造的是最小LR(1)分析表，就把规范LR(1)分析表中同心并且动作相容的状态合并起来
+    if(table_type_==parser_table_type::MINIMAL_LR1)
+    {
+        merge_compatible_LR1_states();
+    }
 
     return true;
 
 }
 
 /*
-从token的列表中获取下一个token
+计算文法的哈希值
+文法文件的内容和终结符字典中的任意一个发生了改变，都会导致之前保存的语法分析表失效
+
+Parameters
+----------
+productions_filename:保存产生式的文件
+terminators:文法的终结符字典
 
 Return
 ------
-返回指向下一个token的指针，如果没有下一个token就返回NULL
+文法的哈希值(FNV-1a)
 */
-struct token * LR1_parser::next_token()
+uint64_t LR1_parser::hash_grammer(const char * productions_filename,map<string,syntax_symbol_index> & terminators)
 {
-    static list<struct token * >::iterator i=tokens_->begin();
+    uint64_t hash=FNV1A_64_OFFSET_BASIS;
+    char buf[4096];
+    streamsize read_size;
+    string terminator;
 
-    while(i!=tokens_->end())
+    ifstream inFile(productions_filename,ios::in|ios::binary);
+    while(inFile)
     {
-        return (*(i++));
+        inFile.read(buf,sizeof(buf));
+        read_size=inFile.gcount();
+        for(streamsize i=0;i<read_size;i++)
+        {
+            hash=(hash^(unsigned char)buf[i])*FNV1A_64_PRIME;
+        }
     }
 
-    return NULL;
-}
-
-/*
-错误处理
-*/
-void LR1_parser::error_handle()
-{
+    for(auto i : terminators)
+    {
+        terminator=i.first+":"+to_string(i.second)+";";
+        for(auto j : terminator)
+        {
+            hash=(hash^(unsigned char)j)*FNV1A_64_PRIME;
+        }
+    }
 
+    return hash;
 }
 
 /*
-赋值action表中的表项
+从文件中加载LR(1)分析表
+文件会被直接映射到内存中，压缩之后的分析表直接指向映射进来的内存
 
-Paramters
----------
-LR1_index:项目集编号(也就是状态编号)
-ter_index:终结符编号
-entry:要赋值的表项
-overwrite:如果发生冲突，是否进行覆盖
+Parameters
+----------
+parser_table_filename:保存语法分析表的文件
+grammer_hash:当前文法的哈希值
 
 Return
 ------
-如果此时对action表的赋值没有冲突就返回true，否则返回false
+如果文件存在并且其中的分析表和当前的文法一致，就返回true，否则返回false
 */
-bool LR1_parser::set_action_entry(state LR1_index,terminator_index ter_index,struct action_entry entry,bool overwrite)
+bool LR1_parser::load_LR1_table(const char * parser_table_filename,uint64_t grammer_hash)
 {
-    int length=grammer_->terminator_num_;
-    if(action_[length*LR1_index+ter_index].movement==entry.movement && action_[length*LR1_index+ter_index].index==entry.index)
+    int fd;
+    struct stat file_stat;
+    void * map;
+    const struct LR1_table_file_header * header;
+    const int32_t * production_info;
+    vector<struct production * > * productions=grammer_->productions_;
+    size_t packed_table_offset;
+    bool res=true;
+
+    fd=open(parser_table_filename,O_RDONLY);
+    if(fd==-1)
     {
-        return true;
+        return false;
+    }
+    if(fstat(fd,&file_stat)==-1 || file_stat.st_size<(off_t)sizeof(struct LR1_table_file_header))
+    {
+        close(fd);
+        return false;
+    }
+    map=mmap(nullptr,file_stat.st_size,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if(map==MAP_FAILED)
+    {
+        return false;
+    }
+
+    //检查文件头
+    header=(const struct LR1_table_file_header *)map;
+    if(memcmp(header->magic,LR1_TABLE_FILE_MAGIC,sizeof(header->magic))!=0 || 
+    header->version!=LR1_TABLE_FILE_VERSION || 
+    header->sizeof_packed_action_entry!=sizeof(packed_action_entry) || 
+    header->grammer_hash!=grammer_hash || 
+    header->table_type!=(int32_t)table_type_ || 
+    header->state_num<=0 || 
+    header->terminator_num!=grammer_->terminator_num_ || 
+    header->syntax_variable_num!=grammer_->syntax_variable_num_ || 
+    header->production_num!=(int32_t)productions->size() || 
+    header->packed_action_size<0 || 
+    header->packed_goto_size<0)
+    {
+        munmap(map,file_stat.st_size);
+        return false;
+    }
+
+    //检查文件的大小
+    packed_table_offset=LR1_TABLE_FILE_PACKED_TABLE_OFFSET(header->production_num);
+    if((size_t)file_stat.st_size!=packed_table_offset+PACKED_TABLE_SIZE(header->state_num,header->syntax_variable_num,header->packed_action_size,header->packed_goto_size))
+    {
+        munmap(map,file_stat.st_size);
+        return false;
+    }
+
+    //检查产生式的信息
+    production_info=(const int32_t *)(header+1);
+    for(production_index i=0;i<productions->size();i++)
+    {
+        if(production_info[2*i]!=productions->at(i)->left || production_info[2*i+1]!=(int32_t)sizeof_production_right(productions->at(i)->right))
+        {
+            munmap(map,file_stat.st_size);
+            return false;
+        }
+    }
+
+    //检查压缩之后的分析表的每一行(列)是否都在数组的范围之内
+    state_num_=header->state_num;
+    set_packed_table((char *)map+packed_table_offset,header->packed_action_size,header->packed_goto_size);
+    for(state i=0;i<state_num_ && res;i++)
+    {
+        res=(packed_table_.action_base[i]>=0 && packed_table_.action_base[i]+grammer_->terminator_num_<=packed_table_.action_size);
+    }
+    for(int i=0;i<grammer_->syntax_variable_num_ && res;i++)
+    {
+        res=(packed_table_.goto_base[i]>=0 && packed_table_.goto_base[i]+state_num_<=packed_table_.goto_size);
+    }
+
+    //检查压缩之后的分析表的每一个表项，否则语法分析的时候会越界访问
+    res=(res && check_packed_table_entries());
+    if(!res)
+    {
+        memset(&packed_table_,0,sizeof(packed_table_));
+        munmap(map,file_stat.st_size);
+        return false;
+    }
+
+    table_file_map_=map;
+    table_file_map_size_=file_stat.st_size;
+
+    return true;
+}
+
+/*
+检查压缩之后的分析表中的每一个表项
+移进和转移的目标状态必须小于状态个数，归约的产生式必须小于产生式个数
+
+Return
+------
+所有表项都合法返回true，否则返回false
+*/
+bool LR1_parser::check_packed_table_entries() const
+{
+    int32_t production_num=grammer_->productions_->size();
+    auto is_action_entry_valid=[&](packed_action_entry packed_entry){
+        enum action_movement movement=(enum action_movement)(packed_entry>>PACKED_ACTION_MOVEMENT_SHIFT);
+        int32_t index=packed_entry&PACKED_ACTION_INDEX_MASK;
+
+        return (movement!=action_movement::SHIFT || index<state_num_) && (movement!=action_movement::REDUCE || index<production_num);
+    };
+
+    for(state i=0;i<state_num_;i++)
+    {
+        if(!is_action_entry_valid(packed_table_.default_action[i]))
+        {
+            return false;
+        }
+    }
+    for(int32_t i=0;i<packed_table_.action_size;i++)
+    {
+        if(packed_table_.action_check[i]<state_num_ && !is_action_entry_valid(packed_table_.action_value[i]))
+        {
+            return false;
+        }
+    }
+    for(int i=0;i<grammer_->syntax_variable_num_;i++)
+    {
+        if(packed_table_.default_goto[i]!=PACKED_TABLE_EMPTY && packed_table_.default_goto[i]>=state_num_)
+        {
+            return false;
+        }
+    }
+    for(int32_t i=0;i<packed_table_.goto_size;i++)
+    {
+        if(packed_table_.goto_check[i]<grammer_->syntax_variable_num_ && packed_table_.goto_value[i]!=PACKED_TABLE_EMPTY && packed_table_.goto_value[i]>=state_num_)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+将LR(1)分析表保存到文件中
+先写到一个临时文件中再重命名，这样同时运行的其他编译器进程不会读到写了一半的文件
+
+Parameters
+----------
+parser_table_filename:保存语法分析表的文件
+grammer_hash:当前文法的哈希值
+
+Return
+------
+保存成功返回true，否则返回false
+*/
+bool LR1_parser::save_LR1_table(const char * parser_table_filename,uint64_t grammer_hash)
+{
+    struct LR1_table_file_header header;
+    vector<struct production * > * productions=grammer_->productions_;
+    vector<int32_t> production_info;
+    size_t padding;
+    char zeros[8]={0};
+    string tmp_filename=string(parser_table_filename)+".tmp."+to_string(getpid());
+
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,LR1_TABLE_FILE_MAGIC,sizeof(header.magic));
+    header.version=LR1_TABLE_FILE_VERSION;
+    header.sizeof_packed_action_entry=sizeof(packed_action_entry);
+    header.grammer_hash=grammer_hash;
+    header.table_type=(int32_t)table_type_;
+    header.state_num=state_num_;
+    header.terminator_num=grammer_->terminator_num_;
+    header.syntax_variable_num=grammer_->syntax_variable_num_;
+    header.production_num=productions->size();
+    header.packed_action_size=packed_table_.action_size;
+    header.packed_goto_size=packed_table_.goto_size;
+
+    for(auto i : *productions)
+    {
+        production_info.push_back(i->left);
+        production_info.push_back(sizeof_production_right(i->right));
+    }
+    padding=LR1_TABLE_FILE_PACKED_TABLE_OFFSET(header.production_num)-sizeof(header)-production_info.size()*sizeof(int32_t);
+
+    //创建一个文件输出流对象
+    ofstream outFile;
+    //打开文件
+    outFile.open(tmp_filename,ios::out|ios::binary|ios::trunc);
+    if(!outFile)
+    {
+        return false;
+    }
+    outFile.write((const char *)&header,sizeof(header));
+    outFile.write((const char *)production_info.data(),production_info.size()*sizeof(int32_t));
+    outFile.write(zeros,padding);
+    outFile.write((const char *)packed_table_buf_,PACKED_TABLE_SIZE(state_num_,grammer_->syntax_variable_num_,packed_table_.action_size,packed_table_.goto_size));
+    outFile.close();
+    if(!outFile || rename(tmp_filename.c_str(),parser_table_filename)!=0)
+    {
+        remove(tmp_filename.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/*
+将若干个稀疏的行错开之后叠放到同一个数组中(first-fit)
+行的起始位置都不小于0，并且数组的长度保证任何一行的起始位置加上行的长度都不会越界
+
+Parameters
+----------
+lines:每一行中需要保存的表项(列号,值)
+line_length:每一行的长度
+base:返回每一行的起始位置
+value:返回叠放之后的数组
+check:返回叠放之后的数组中的每一个位置属于哪一行
+*/
+static void displace_lines(const vector<vector<pair<int,uint16_t> > > & lines,int line_length,vector<int32_t> & base,vector<uint16_t> & value,vector<uint16_t> & check)
+{
+    vector<int> order(lines.size());
+    vector<bool> used;
+    int32_t b,size=0;
+    bool fit;
+
+    //先放表项多的行，这样表项少的行更容易填到空隙中
+    for(int i=0;i<lines.size();i++)
+    {
+        order[i]=i;
+    }
+    stable_sort(order.begin(),order.end(),[&lines](int a,int b){return lines[a].size()>lines[b].size();});
+
+    base.assign(lines.size(),0);
+    for(auto i : order)
+    {
+        if(lines[i].empty())
+        {
+            continue;
+        }
+        for(b=0;;b++)
+        {
+            fit=true;
+            for(auto & j : lines[i])
+            {
+                if(b+j.first<used.size() && used[b+j.first])
+                {
+                    fit=false;
+                    break;
+                }
+            }
+            if(fit)
+            {
+                break;
+            }
+        }
+        if(b+line_length>used.size())
+        {
+            used.resize(b+line_length,false);
+            value.resize(b+line_length,0);
+            check.resize(b+line_length,PACKED_TABLE_EMPTY);
+        }
+        for(auto & j : lines[i])
+        {
+            used[b+j.first]=true;
+            value[b+j.first]=j.second;
+            check[b+j.first]=i;
+        }
+        base[i]=b;
+    }
+
+    //保证没有表项的行也不会越界
+    size=max((size_t)line_length,used.size());
+    value.resize(size,0);
+    check.resize(size,PACKED_TABLE_EMPTY);
+}
+
+/*
+压缩LR(1)分析表
+压缩之后的分析表的所有数组都放在同一块内存中，布局和语法分析表文件中的布局相同
+
+Return
+------
+压缩成功返回true，如果状态或者产生式过多而无法压缩就返回false
+*/
+bool LR1_parser::pack_LR1_table()
+{
+    int terminator_num=grammer_->terminator_num_,syntax_variable_num=grammer_->syntax_variable_num_;
+    vector<int32_t> action_base,goto_base;
+    vector<uint16_t> default_action(state_num_,0),action_value,action_check,default_goto(syntax_variable_num,PACKED_TABLE_EMPTY),goto_value,goto_check;
+    vector<vector<pair<int,uint16_t> > > lines;
+    map<int,int> count;
+    int max_count;
+    struct action_entry entry,default_entry;
+    goto_entry next_state;
+    packed_action_entry packed_entry;
+    char * buf;
+
+    if(state_num_>PACKED_TABLE_MAX_INDEX || grammer_->productions_->size()>PACKED_TABLE_MAX_INDEX || syntax_variable_num>PACKED_TABLE_MAX_INDEX)
+    {
+        cout<<"Too many states or productions to pack the action and goto table!"<<endl;
+        return false;
+    }
+
+    //action表中每一个状态的默认动作是这一行中出现次数最多的归约，这样原本是ERROR的表项也会执行归约
+    //但是这不会影响对正确的输入的语法分析，对于错误的输入也会在移进下一个token之前发现错误
+    lines.assign(state_num_,vector<pair<int,uint16_t> >());
+    for(state i=0;i<state_num_;i++)
+    {
+        count.clear();
+        for(int j=0;j<terminator_num;j++)
+        {
+            entry=action_[terminator_num*i+j];
+            if(entry.movement==action_movement::REDUCE)
+            {
+                count[entry.index]++;
+            }
+        }
+        max_count=0;
+        for(auto & j : count)
+        {
+            if(j.second>max_count)
+            {
+                max_count=j.second;
+                default_entry={action_movement::REDUCE,j.first};
+                default_action[i]=PACK_ACTION_ENTRY(default_entry);
+            }
+        }
+        for(int j=0;j<terminator_num;j++)
+        {
+            entry=action_[terminator_num*i+j];
+            packed_entry=PACK_ACTION_ENTRY(entry);
+            if(entry.movement!=action_movement::ERROR && packed_entry!=default_action[i])
+            {
+                lines[i].push_back(make_pair(j,packed_entry));
+            }
+        }
+    }
+    displace_lines(lines,terminator_num,action_base,action_value,action_check);
+
+    //goto表中每一个语法变量的默认转移是这一列中出现次数最多的状态
+    lines.assign(syntax_variable_num,vector<pair<int,uint16_t> >());
+    for(int j=0;j<syntax_variable_num;j++)
+    {
+        count.clear();
+        for(state i=0;i<state_num_;i++)
+        {
+            next_state=goto_[syntax_variable_num*i+j];
+            if(next_state!=-1)
+            {
+                count[next_state]++;
+            }
+        }
+        max_count=0;
+        for(auto & i : count)
+        {
+            if(i.second>max_count)
+            {
+                max_count=i.second;
+                default_goto[j]=i.first;
+            }
+        }
+        for(state i=0;i<state_num_;i++)
+        {
+            next_state=goto_[syntax_variable_num*i+j];
+            if(next_state!=-1 && next_state!=default_goto[j])
+            {
+                lines[j].push_back(make_pair(i,(uint16_t)next_state));
+            }
+        }
+    }
+    displace_lines(lines,state_num_,goto_base,goto_value,goto_check);
+
+    //把压缩之后的各个数组拷贝到同一块内存中
+    buf=(char *)malloc(PACKED_TABLE_SIZE(state_num_,syntax_variable_num,action_value.size(),goto_value.size()));
+    memcpy(buf,action_base.data(),state_num_*sizeof(int32_t));
+    memcpy(buf+state_num_*sizeof(int32_t),goto_base.data(),syntax_variable_num*sizeof(int32_t));
+    set_packed_table(buf,action_value.size(),goto_value.size());
+    memcpy((void *)packed_table_.default_action,default_action.data(),state_num_*sizeof(packed_action_entry));
+    memcpy((void *)packed_table_.action_value,action_value.data(),action_value.size()*sizeof(packed_action_entry));
+    memcpy((void *)packed_table_.action_check,action_check.data(),action_check.size()*sizeof(uint16_t));
+    memcpy((void *)packed_table_.default_goto,default_goto.data(),syntax_variable_num*sizeof(uint16_t));
+    memcpy((void *)packed_table_.goto_value,goto_value.data(),goto_value.size()*sizeof(uint16_t));
+    memcpy((void *)packed_table_.goto_check,goto_check.data(),goto_check.size()*sizeof(uint16_t));
+    packed_table_buf_=buf;
+
+    return true;
+}
+
+/*
+设置压缩之后的语法分析表的各个数组的位置
+
+Parameters
+----------
+buf:压缩之后的语法分析表所在的内存
+action_size:压缩之后的action表的长度
+goto_size:压缩之后的goto表的长度
+*/
+void LR1_parser::set_packed_table(void * buf,int32_t action_size,int32_t goto_size)
+{
+    char * p=(char *)buf;
+    int syntax_variable_num=grammer_->syntax_variable_num_;
+
+    packed_table_.action_base=(const int32_t *)p;
+    p+=state_num_*sizeof(int32_t);
+    packed_table_.goto_base=(const int32_t *)p;
+    p+=syntax_variable_num*sizeof(int32_t);
+    packed_table_.default_action=(const packed_action_entry *)p;
+    p+=state_num_*sizeof(packed_action_entry);
+    packed_table_.action_value=(const packed_action_entry *)p;
+    p+=action_size*sizeof(packed_action_entry);
+    packed_table_.action_check=(const uint16_t *)p;
+    p+=action_size*sizeof(uint16_t);
+    packed_table_.default_goto=(const uint16_t *)p;
+    p+=syntax_variable_num*sizeof(uint16_t);
+    packed_table_.goto_value=(const uint16_t *)p;
+    p+=goto_size*sizeof(uint16_t);
+    packed_table_.goto_check=(const uint16_t *)p;
+    packed_table_.action_size=action_size;
+    packed_table_.goto_size=goto_size;
+}
+
+/*
+从token序列中获取下一个token
+
+Return
+------
+返回指向下一个token的指针(在下一次调用之前有效)，如果没有下一个token就返回NULL
+*/
+struct token * LR1_parser::next_token()
+{
+    //直接从词法分析器中获取，上一个token此时已经移进了，不再需要保存
+    if(lexical_analyzer_)
+    {
+        return lexical_analyzer_->token_scan();
+    }
+
+    if(next_token_index_<tokens_->size())
+    {
+        current_token_.code_of_kind=tokens_->kinds[next_token_index_];
+        current_token_.attribute_value=tokens_->values[next_token_index_];
+        next_token_index_++;
+        return &current_token_;
+    }
+
+    return NULL;
+}
+
+/*
+错误处理
+*/
+void LR1_parser::error_handle()
+{
+
+}
+
+/*
+赋值action表中的表项
+
+Paramters
+---------
+LR1_index:项目集编号(也就是状态编号)
+ter_index:终结符编号
+entry:要赋值的表项
+overwrite:如果发生冲突，是否进行覆盖
+
+Return
+------
+如果此时对action表的赋值没有冲突就返回true，否则返回false
+*/
+bool LR1_parser::set_action_entry(state LR1_index,terminator_index ter_index,struct action_entry entry,bool overwrite)
+{
+    int length=grammer_->terminator_num_;
+    if(action_[length*LR1_index+ter_index].movement==entry.movement && action_[length*LR1_index+ter_index].index==entry.index)
+    {
+        return true;
     }
     if(action_[length*LR1_index+ter_index].movement==action_movement::ERROR)
     {
@@ -827,10 +1702,10 @@ Return
 ------
 返回这个右部的长度，不包括空符号
 */
-unsigned int LR1_parser::sizeof_production_right(vector<syntax_symbol_index> right)
+unsigned int LR1_parser::sizeof_production_right(const vector<syntax_symbol_index> & right)
 {
     unsigned int result=0;
-    for(vector<syntax_symbol_index>::iterator i=right.begin();i!=right.end();i++)
+    for(vector<syntax_symbol_index>::const_iterator i=right.begin();i!=right.end();i++)
     {
         if((*i)!=EMPTY_SYMBOL)
         {
@@ -857,11 +1732,14 @@ queue<struct production * > * LR1_parser::parse()
     syntax_symbol_index syntax_symbol;
     vector<struct production * > * productions=grammer_->productions_;
     struct production * production;
+    unsigned int right_size;
     state next_state;
 
     //先给符号栈和状态栈赋初始值
-    token_stack_.push(grammer_->stack_bottom_symbol_);
-    state_stack_.push(0);
+    token_stack_.clear();
+    state_stack_.clear();
+    token_stack_.push_back(grammer_->stack_bottom_symbol_);
+    state_stack_.push_back(0);
 
     //然后开始按照action表和goto表进行语法分析
     if(input_token_code_of_kind==-1)
@@ -872,14 +1750,14 @@ queue<struct production * > * LR1_parser::parse()
     while(true)
     {
         //cout<<"inptu_token:"<<input_token_code_of_kind<<endl;
-        //cout<<"state:"<<state_stack_.top()<<endl;
-        entry=get_action_entry(state_stack_.top(),input_token_code_of_kind);
+        //cout<<"state:"<<state_stack_.back()<<endl;
+        entry=get_packed_action_entry(state_stack_.back(),input_token_code_of_kind);
         switch(entry.movement)
         {
             case action_movement::SHIFT:
             //cout<<"SHIFT"<<endl;
-                token_stack_.push(input_token_code_of_kind);
-                state_stack_.push(entry.index);
+                token_stack_.push_back(input_token_code_of_kind);
+                state_stack_.push_back(entry.index);
                 input_token=next_token();
                 input_token_code_of_kind=input_token?(terminator_index)input_token->code_of_kind:((tag==-1)?tag=grammer_->stack_bottom_symbol_:-1);
                 if(input_token_code_of_kind==-1)
@@ -892,21 +1770,16 @@ queue<struct production * > * LR1_parser::parse()
             //cout<<"REDUCE:";
                 production=productions->at(entry.index);
                 //cout<<production->production_string<<endl;
-                for(vector<syntax_symbol_index>::iterator i=production->right.begin();i!=production->right.end();i++)
-                {
-                    if((*i)!=grammer_->empty_symbol_)
-                    {
-                        token_stack_.pop();
-                        state_stack_.pop();
-                    }
-                }
-                token_stack_.push(production->left);
+                right_size=production_right_sizes_[entry.index];
+                token_stack_.resize(token_stack_.size()-right_size);
+                state_stack_.resize(state_stack_.size()-right_size);
+                token_stack_.push_back(production->left);
 
-                next_state=get_goto_entry(state_stack_.top(),production->left);
+                next_state=get_packed_goto_entry(state_stack_.back(),production->left);
                 
                 if(next_state!=-1)
                 {
-                    state_stack_.push(next_state);
+                    state_stack_.push_back(next_state);
                 }
                 else
                 {
@@ -962,4 +1835,208 @@ void LR1_parser::output_productions(const char * filename)
     }
 
     outFile.close();
-}
\ No newline at end of file
+}
+
+/*
+只使用action表和goto表对tokens进行识别(不进行归约之外的任何操作)
+
+Parameters
+----------
+use_packed_table:是否使用压缩之后的语法分析表
+
+Return
+------
+如果tokens符合文法就返回true，否则返回false
+*/
+bool LR1_parser::recognize(bool use_packed_table)
+{
+    vector<state> states;
+    size_t i=0;
+    terminator_index input_token_code_of_kind=(i<tokens_->size())?(terminator_index)tokens_->kinds[i]:grammer_->stack_bottom_symbol_;
+    struct action_entry entry;
+    struct production * production;
+    goto_entry next_state;
+
+    states.push_back(0);
+    while(true)
+    {
+        entry=use_packed_table?get_packed_action_entry(states.back(),input_token_code_of_kind):get_action_entry(states.back(),input_token_code_of_kind);
+        switch(entry.movement)
+        {
+            case action_movement::SHIFT:
+                states.push_back(entry.index);
+                i++;
+                input_token_code_of_kind=(i<tokens_->size())?(terminator_index)tokens_->kinds[i]:grammer_->stack_bottom_symbol_;
+                break;
+            case action_movement::REDUCE:
+                production=grammer_->productions_->at(entry.index);
+                states.resize(states.size()-production_right_sizes_[entry.index]);
+                next_state=use_packed_table?get_packed_goto_entry(states.back(),production->left):get_goto_entry(states.back(),production->left);
+                if(next_state==-1)
+                {
+                    return false;
+                }
+                states.push_back(next_state);
+                break;
+            case action_movement::ACCEPT:
+                return true;
+            default:
+                return false;
+        }
+    }
+}
+
+/*
+比较使用压缩前后的语法分析表进行语法分析的速度(每秒识别的token个数)
+只有新建的语法分析表才同时有压缩前后的两种表
+
+Parameters
+----------
+rounds:对tokens重复进行识别的次数
+*/
+void LR1_parser::benchmark_parser_table(int rounds)
+{
+    chrono::steady_clock::time_point start;
+    double seconds;
+    bool use_packed_table;
+
+    if(!action_ || !goto_)
+    {
+        cout<<"Dense action and goto table is not available!"<<endl;
+        return;
+    }
+
+    cout<<"tokens: "<<tokens_->size()<<", rounds: "<<rounds<<endl;
+    cout<<"dense table: "<<(size_t)state_num_*grammer_->terminator_num_*sizeof(struct action_entry)+(size_t)state_num_*grammer_->syntax_variable_num_*sizeof(goto_entry)<<" bytes"<<endl;
+    cout<<"packed table: "<<PACKED_TABLE_SIZE(state_num_,grammer_->syntax_variable_num_,packed_table_.action_size,packed_table_.goto_size)<<" bytes"<<endl;
+    for(int i=0;i<2;i++)
+    {
+        use_packed_table=(i==1);
+        start=chrono::steady_clock::now();
+        for(int j=0;j<rounds;j++)
+        {
+            if(!recognize(use_packed_table))
+            {
+                cout<<"Parse error!"<<endl;
+                return;
+            }
+        }
+        seconds=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+        cout<<(use_packed_table?"packed":"dense")<<" table: "<<(double)tokens_->size()*rounds/seconds<<" tokens/s"<<endl;
+    }
+}
+
+/*
+使用基于deque的std::stack作为符号栈和状态栈进行语法分析，归约的时候沿着产生式右部逐个符号弹栈(跳过空符号)
+这是语法分析栈改成vector之前的做法，只用来作为测试语法分析速度时的比较基准，分析的结果和parse完全相同
+
+Return
+------
+返回产生式队列，如果出错就返回nullptr
+*/
+queue<struct production * > * LR1_parser::parse_with_deque_stack()
+{
+    int tag=-1;
+    queue<struct production * > * result;
+    stack<syntax_symbol_index> token_stack;
+    stack<state> state_stack;
+    struct action_entry entry;
+    struct token * input_token=next_token();
+    terminator_index input_token_code_of_kind=input_token?(terminator_index)input_token->code_of_kind:((tag==-1)?tag=grammer_->stack_bottom_symbol_:-1);
+    vector<struct production * > * productions=grammer_->productions_;
+    struct production * production;
+    state next_state;
+
+    token_stack.push(grammer_->stack_bottom_symbol_);
+    state_stack.push(0);
+
+    if(input_token_code_of_kind==-1)
+    {
+        return nullptr;
+    }
+    result=new queue<struct production * >;
+    while(true)
+    {
+        entry=get_packed_action_entry(state_stack.top(),input_token_code_of_kind);
+        switch(entry.movement)
+        {
+            case action_movement::SHIFT:
+                token_stack.push(input_token_code_of_kind);
+                state_stack.push(entry.index);
+                input_token=next_token();
+                input_token_code_of_kind=input_token?(terminator_index)input_token->code_of_kind:((tag==-1)?tag=grammer_->stack_bottom_symbol_:-1);
+                if(input_token_code_of_kind==-1)
+                {
+                    delete result;
+                    return nullptr;
+                }
+                break;
+            case action_movement::REDUCE:
+                production=productions->at(entry.index);
+                for(vector<syntax_symbol_index>::iterator i=production->right.begin();i!=production->right.end();i++)
+                {
+                    if((*i)!=grammer_->empty_symbol_)
+                    {
+                        token_stack.pop();
+                        state_stack.pop();
+                    }
+                }
+                token_stack.push(production->left);
+
+                next_state=get_packed_goto_entry(state_stack.top(),production->left);
+                if(next_state==-1)
+                {
+                    delete result;
+                    return nullptr;
+                }
+                state_stack.push(next_state);
+
+                result->push(production);
+                break;
+            case action_movement::ACCEPT:
+                return result;
+            case action_movement::ERROR:
+                delete result;
+                return nullptr;
+        }
+    }
+}
+
+/*
+比较语法分析栈改成vector前后的语法分析速度(每秒处理的token个数和归约的次数)
+改之前使用基于deque的栈并且逐个符号弹栈，改之后使用vector并且按照产生式右部的长度一次弹栈
+
+Parameters
+----------
+rounds:每一种方式对tokens重复进行语法分析的次数
+*/
+void LR1_parser::benchmark_parse(int rounds)
+{
+    chrono::steady_clock::time_point start;
+    double seconds;
+    queue<struct production * > * productions;
+    size_t reduce_num;
+    bool use_vector_stack;
+
+    cout<<"tokens: "<<tokens_->size()<<", rounds: "<<rounds<<endl;
+    for(int i=0;i<2;i++)
+    {
+        use_vector_stack=(i==1);
+        reduce_num=0;
+        start=chrono::steady_clock::now();
+        for(int j=0;j<rounds;j++)
+        {
+            next_token_index_=0;
+            productions=use_vector_stack?parse():parse_with_deque_stack();
+            if(!productions)
+            {
+                cout<<"Parse error!"<<endl;
+                return;
+            }
+            reduce_num+=productions->size();
+            delete productions;
+        }
+        seconds=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+        cout<<(use_vector_stack?"vector stack":"deque stack")<<": "<<(double)tokens_->size()*rounds/seconds<<" tokens/s, "<<(double)reduce_num/seconds<<" reductions/s"<<endl;
+    }
+}
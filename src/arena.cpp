@@ -0,0 +1,84 @@
+/*
+ *
+ *  arena.cpp
+ *  按块分配内存的分配器
+ *  Creator:Sichao Chen
+ *  Create time:2026/10/18
+ *
+*/
+#include "arena.h"
+#include<string.h>
+
+/*
+构造函数
+*/
+Arena::Arena():pos_(nullptr),end_(nullptr)
+{
+
+}
+
+/*
+析构函数
+先按照和分配相反的顺序析构所有的对象(后创建的对象可能引用先创建的对象)，然后释放所有的内存块
+*/
+Arena::~Arena()
+{
+    for(auto it=destructors_.rbegin();it!=destructors_.rend();it++)
+    {
+        it->destroy(it->object);
+    }
+    for(auto i:blocks_)
+    {
+        delete[] i;
+    }
+}
+
+/*
+当前块的空间不够的时候分配内存
+大的对象单独分配一块内存，当前块不变；否则新分配一块内存作为当前块
+
+Parameters
+----------
+size:要分配的字节数
+align:对齐的字节数
+
+Return
+------
+分配的内存
+*/
+void * Arena::allocate_slow(size_t size,size_t align)
+{
+    char * block,* res;
+
+    if(size+align>ARENA_MAX_SMALL_SIZE)
+    {
+        block=new char[size+align];
+        blocks_.push_back(block);
+        return (void *)(((uintptr_t)block+align-1)&~(uintptr_t)(align-1));
+    }
+    block=new char[ARENA_BLOCK_SIZE];
+    blocks_.push_back(block);
+    res=(char *)(((uintptr_t)block+align-1)&~(uintptr_t)(align-1));
+    pos_=res+size;
+    end_=block+ARENA_BLOCK_SIZE;
+    return res;
+}
+
+/*
+复制一个字符串
+
+Parameters
+----------
+str:要复制的字符串
+
+Return
+------
+复制之后的以'\0'结尾的字符串
+*/
+const char * Arena::copy_string(const string & str)
+{
+    char * res=(char *)allocate(str.size()+1,1);
+
+    memcpy(res,str.c_str(),str.size()+1);
+    return res;
+}
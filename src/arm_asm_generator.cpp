@@ -7,12 +7,15 @@
  *
 */
 #include "arm_asm_generator.h"
+#include "thread_pool.h"
+#include "time_report.h"
 #include<iostream>
+#include<fstream>
 
 //ARM内存信息
 string arm_memory_info="little_ending";
 
-Arm_asm_generator::Arm_asm_generator()
+Arm_asm_generator::Arm_asm_generator():symbol_table_(nullptr)
 {
 
 }
@@ -25,7 +28,7 @@ Arm_asm_generator::~Arm_asm_generator()
 //初始化汇编指令生成器
 bool Arm_asm_generator::init_instruction_generator(map<reg_index,string> regs_info)
 {
-    instruction_generator_=new Arm_instruction_generator(regs_info);
+    instruction_generator_=new Arm_instruction_generator(regs_info,symbol_table_);
     instruction_generator_->set_mediator(this);
     return instruction_generator_->is_init_successful();
 }
@@ -195,12 +198,18 @@ struct event Arm_asm_generator::notify(Asm_generator_component *sender, struct e
 /*
 ARM汇编代码生成器的初始化
 
+Parameters
+----------
+symbol_table:生成汇编代码时使用的符号表
+
 Return
 ------
 如果初始化成功返回true，否则返回false
 */
-bool Arm_asm_generator::init()
+bool Arm_asm_generator::init(Symbol_table * symbol_table)
 {
+    symbol_table_=symbol_table;
+
     //ARM可用的寄存器的名字以及描述
     set<struct reg> arm_regs={
         reg("r0",0,reg_attr::ARGUMENT,true,reg_state::NOT_USED,32,reg_processor::CPU),
@@ -254,3 +263,149 @@ bool Arm_asm_generator::init()
     };
     return Asm_generator::init(arm_regs,flag_reg("cpsr",4,flag_in_flag_reg::NEGATIVE,flag_in_flag_reg::ZERO,flag_in_flag_reg::CARRY,flag_in_flag_reg::OVERFLOW),arm_memory_info);
 }
+
+
+/*
+只为中间代码流图中的一个函数生成arm汇编函数流图(不进行优化)
+每一个函数都使用一个单独的汇编代码生成器，所以寄存器管理器、内存管理器和汇编指令生成器都是该函数自己的
+
+Parameters
+----------
+intermediate_codes_flow_graph:中间代码流图
+func:要生成的函数
+
+Return
+------
+返回生成的arm汇编函数流图，由调用者负责释放
+*/
+struct arm_func_flow_graph * Arm_asm_generator::generate_func_arm_flow_graph(struct ic_flow_graph * intermediate_codes_flow_graph,list<struct ic_func_flow_graph * >::iterator func)
+{
+    struct arm_func_flow_graph * res=nullptr;
+    list<struct ic_func_flow_graph * >::iterator end_func=func;
+
+    intermediate_code_manager_->init(intermediate_codes_flow_graph,func,++end_func,false);
+    struct arm_flow_graph & arm_flow_graph=((Arm_instruction_generator *)instruction_generator_)->build_arm_flow_graph();
+    if(!arm_flow_graph.func_flow_graphs.empty())
+    {
+        res=arm_flow_graph.func_flow_graphs.front();
+        arm_flow_graph.func_flow_graphs.clear();
+    }
+    return res;
+}
+
+//按照函数并行生成汇编代码时所有线程共享的信息
+struct parallel_func_asm_info
+{
+    Symbol_table * symbol_table;                                        //符号表
+    struct ic_flow_graph * intermediate_codes_flow_graph;               //中间代码流图
+    vector<list<struct ic_func_flow_graph * >::iterator> funcs;         //所有要生成的函数
+    vector<struct arm_func_flow_graph * > arm_funcs;                    //每一个函数生成的arm汇编函数流图
+    vector<Time_report> reports;                                        //每一个函数的统计报告(不需要统计的时候为空)
+};
+
+/*
+为一个函数生成arm汇编函数流图(由线程池调用)
+
+Parameters
+----------
+index:函数的编号
+data:所有线程共享的信息(struct parallel_func_asm_info *)
+*/
+static void generate_func_arm_flow_graph_task(size_t index,void * data)
+{
+    struct parallel_func_asm_info * info=(struct parallel_func_asm_info *)data;
+    Arm_asm_generator func_asm_generator;
+    Time_report * report=Time_report::get_current();
+
+    //每一个函数的计数器先记录到自己的报告中，避免多个线程同时修改同一个报告
+    Time_report::install(info->reports.empty()?nullptr:&info->reports[index]);
+    if(func_asm_generator.init(info->symbol_table))
+    {
+        info->arm_funcs[index]=func_asm_generator.generate_func_arm_flow_graph(info->intermediate_codes_flow_graph,info->funcs[index]);
+    }
+    Time_report::install(report);
+}
+
+/*
+按照函数并行生成最终的汇编代码文件
+中间代码流图中的各个函数之间是相互独立的，所以每一个函数都在线程池中用一个单独的汇编代码生成器生成arm汇编函数流图，
+全局定义由当前的汇编代码生成器生成，最后再按照函数在源程序中的顺序把所有的函数流图拼接起来进行优化和输出
+
+Parameters
+----------
+intermediate_codes_flow_graph:中间代码流图
+filename:要输出的汇编文件名
+thread_num:线程个数
+
+Return
+------
+成功返回true，否则返回false
+*/
+bool Arm_asm_generator::generate_asm_in_parallel_then_output(struct ic_flow_graph * intermediate_codes_flow_graph,const char * filename,size_t thread_num)
+{
+    struct parallel_func_asm_info info;
+    ofstream outFile;
+    bool res=true;
+
+    if(thread_num<=1 || !intermediate_codes_flow_graph)
+    {
+        return generate_asm_then_output(intermediate_codes_flow_graph,filename);
+    }
+
+    //在线程池中为每一个函数生成arm汇编函数流图
+    info.symbol_table=symbol_table_;
+    info.intermediate_codes_flow_graph=intermediate_codes_flow_graph;
+    for(list<struct ic_func_flow_graph * >::iterator i=intermediate_codes_flow_graph->func_flow_graphs.begin();i!=intermediate_codes_flow_graph->func_flow_graphs.end();i++)
+    {
+        info.funcs.push_back(i);
+    }
+    info.arm_funcs.assign(info.funcs.size(),nullptr);
+    if(Time_report::get_current())
+    {
+        info.reports.resize(info.funcs.size());
+    }
+    Time_report::begin_stage("parallel function asm generate");
+    parallel_for(info.funcs.size(),thread_num,generate_func_arm_flow_graph_task,&info);
+    Time_report::end_stage();
+    for(auto & i:info.reports)
+    {
+        Time_report::get_current()->merge_counters(i);
+    }
+
+    //生成全局定义，然后按照源程序中的顺序拼接所有的函数
+    intermediate_code_manager_->init(intermediate_codes_flow_graph,intermediate_codes_flow_graph->func_flow_graphs.end(),intermediate_codes_flow_graph->func_flow_graphs.end(),true);
+    struct arm_flow_graph & arm_flow_graph=((Arm_instruction_generator *)instruction_generator_)->build_arm_flow_graph();
+    for(auto i:info.arm_funcs)
+    {
+        if(i)
+        {
+            arm_flow_graph.func_flow_graphs.push_back(i);
+        }
+        else
+        {
+            res=false;
+        }
+    }
+    if(!res)
+    {
+        cout<<"Generate asm codes in parallel error!"<<endl;
+        return false;
+    }
+
+    outFile.open(filename,ios::out);
+    if(!outFile)
+    {
+        cout<<"Open file "<<filename<<" error!"<<endl;
+        return false;
+    }
+    list<string> & asm_codes=((Arm_instruction_generator *)instruction_generator_)->generate_asm_from_arm_flow_graph();
+    Time_report::begin_stage("write asm file");
+    for(auto & i:asm_codes)
+    {
+        outFile<<i<<endl;
+    }
+    outFile.close();
+    Time_report::end_stage();
+
+    return true;
+}
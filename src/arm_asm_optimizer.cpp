@@ -7,6 +7,7 @@
  *
 */
 #include "arm_asm_optimizer.h"
+#include "time_report.h"
 
 /*
 局部优化
@@ -120,7 +121,11 @@ arm_flow_graph:要优化的arm汇编代码流图
 void Arm_asm_optimizer::optimize(struct arm_flow_graph & arm_flow_graph)
 {
     //局部优化
+    Time_report::begin_stage("asm local optimize");
     local_optimize(arm_flow_graph);
+    Time_report::end_stage();
     //全局优化
+    Time_report::begin_stage("asm global optimize");
     global_optimize(arm_flow_graph);
+    Time_report::end_stage();
 }
\ No newline at end of file
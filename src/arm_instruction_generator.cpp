@@ -7,8 +7,9 @@
  *
 */
 #include "arm_instruction_generator.h"
+#include "time_report.h"
 
-Arm_instruction_generator::Arm_instruction_generator(map<reg_index,string> regs_info):Instruction_generator(regs_info)
+Arm_instruction_generator::Arm_instruction_generator(map<reg_index,string> regs_info,Symbol_table * symbol_table):Instruction_generator(regs_info),symbol_table_(symbol_table)
 {
 
 }
@@ -27,9 +28,56 @@ Arm_instruction_generator::~Arm_instruction_generator()
 void Arm_instruction_generator::generate_asm_codes()
 {
     generate_arm_flow_graph();
+    generate_asm_from_arm_flow_graph();
+}
+
+/*
+根据中间代码生成arm汇编的流图(不进行优化)
+
+Return
+------
+返回生成的arm汇编的流图
+*/
+struct arm_flow_graph & Arm_instruction_generator::build_arm_flow_graph()
+{
+    generate_arm_flow_graph();
+    return arm_flow_graph_;
+}
+
+/*
+对已经生成的arm汇编的流图进行优化，然后生成汇编文件序列
+
+Return
+------
+返回生成的汇编文件序列
+*/
+list<string> & Arm_instruction_generator::generate_asm_from_arm_flow_graph()
+{
+    size_t instruction_num=0;
+
     //arm汇编代码优化
     asm_optimizer_.optimize(arm_flow_graph_);
+    if(Time_report::get_current())
+    {
+        for(auto i:arm_flow_graph_.func_flow_graphs)
+        {
+            for(auto j:i->basic_blocks)
+            {
+                for(auto k:j->arm_sequence)
+                {
+                    if(dynamic_cast<Arm_instruction *>(k))
+                    {
+                        instruction_num++;
+                    }
+                }
+            }
+        }
+        Time_report::add_counter("arm instructions",instruction_num);
+    }
+    Time_report::begin_stage("emission");
     asm_codes_=arm_flow_graph_.to_string();
+    Time_report::end_stage();
+    return asm_codes_;
 }
 
 /*
@@ -37,12 +85,15 @@ void Arm_instruction_generator::generate_asm_codes()
 */
 void Arm_instruction_generator::generate_arm_flow_graph()
 {
+    //寄存器分配是在指令选择的过程中边生成指令边进行的，所以这两者只能一起统计
+    Time_report::begin_stage("instruction selection and register allocation");
     struct quaternion ic=get_next_intermediate_code();
     while(!ic.is_invalid())
     {
         ic_to_arm_asm(ic);
         ic=get_next_intermediate_code();
     }
+    Time_report::end_stage();
 }
 
 /*
@@ -1082,7 +1133,6 @@ void Arm_instruction_generator::var_define_ic_to_arm_asm(struct ic_data * result
     pair<pair<string,list<struct ic_data * > * >,pair<struct ic_data *,reg_index> > * event_data_1;
     pair<struct ic_data *,struct ic_data * > * event_data_2;
     list<struct ic_data * > * r_params;
-    Symbol_table * symbol_table=Symbol_table::get_instance();
     if(result->is_pure_const())
     {
         return;
@@ -1171,8 +1221,8 @@ void Arm_instruction_generator::var_define_ic_to_arm_asm(struct ic_data * result
                 event_data_1->first.first=string("memset");
                 r_params=new list<struct ic_data *>;
                 r_params->push_back(result);
-                r_params->push_back(symbol_table->const_entry(language_data_type::INT,OAA((int)0)));
-                r_params->push_back(symbol_table->const_entry(language_data_type::INT,OAA((int)result->get_byte_size())));
+                r_params->push_back(symbol_table_->const_entry(language_data_type::INT,OAA((int)0)));
+                r_params->push_back(symbol_table_->const_entry(language_data_type::INT,OAA((int)result->get_byte_size())));
                 event_data_1->first.second=r_params;
                 event_data_1->second.first=nullptr;
                 notify(event(event_type::CALL_ABI_FUNC,event_data_1));
@@ -1185,8 +1235,8 @@ void Arm_instruction_generator::var_define_ic_to_arm_asm(struct ic_data * result
                 event_data_2=new pair<struct ic_data *,struct ic_data *>;
                 for(auto i:(*((vector<OAA> *)result->get_value().pointer_data)))
                 {
-                    event_data_2->first=symbol_table->const_entry(result->data_type,i);
-                    event_data_2->second=symbol_table->array_member_entry(result,result->dimensions_len->size(),symbol_table->const_entry(language_data_type::INT,OAA((int)array_member_offset)));
+                    event_data_2->first=symbol_table_->const_entry(result->data_type,i);
+                    event_data_2->second=symbol_table_->array_member_entry(result,result->dimensions_len->size(),symbol_table_->const_entry(language_data_type::INT,OAA((int)array_member_offset)));
                     notify(event(event_type::ASSIGN_VAR,(void *)event_data_2));
                     array_member_offset++;
                 }
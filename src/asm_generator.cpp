@@ -7,6 +7,7 @@
  *
 */
 #include "asm_generator.h"
+#include "time_report.h"
 #include<iostream>
 #include<fstream>
 
@@ -15,7 +16,7 @@ using namespace std;
 /*
 汇编代码生成器的构造函数
 */
-Asm_generator::Asm_generator()
+Asm_generator::Asm_generator():intermediate_code_manager_(nullptr),instruction_generator_(nullptr),register_manager_(nullptr),memory_manager_(nullptr)
 {
 
 }
@@ -124,12 +125,14 @@ bool Asm_generator::generate_asm_then_output(struct ic_flow_graph * intermediate
     asm_codes=instruction_generator_->generate_asm();
 
     //把所有的最终代码输出到文件
+    Time_report::begin_stage("write asm file");
     for(auto i : asm_codes)
     {
         outFile<<(i)<<endl;
     }
 
     outFile.close();
+    Time_report::end_stage();
 
     return true;
 }
\ No newline at end of file
@@ -30,17 +30,13 @@
 //语义动作函数表
 extern map<string,semantic_rule> semantic_rules;
 
-//语义动作注册函数表
-extern map<string,semantic_rule_register> semantic_rule_registers;
 
 /*
 生成一个随机的，以双下划线__开头的新生成的语法变量的名字
 */
 string Grammer::generate_a_new_syntax_variable_name_()
 {
-    static int new_syntax_variable_num=0;
-
-    return "__"+to_string(new_syntax_variable_num++);
+    return "__"+to_string(new_syntax_variable_num_++);
 }
 
 /*
@@ -52,14 +48,15 @@ filename:书写文法的文本文件名
 terminators:文法的终结符字典
 is_augmented:是否将该文法自动转换成拓广文法
 */
-Grammer::Grammer(const char * filename,map<string,syntax_symbol_index> terminators,bool is_augmented):is_augmented_(is_augmented)
+Grammer::Grammer(const char * filename,map<string,syntax_symbol_index> terminators,bool is_augmented):is_augmented_(is_augmented),new_syntax_variable_num_(0)
 {
     string line,str,new_syntax_symbol_str;
     int line_length,head,tail;
     syntax_symbol_index syntax_symbol_index_found,old_start_symbol;
     struct production * pr,*new_pr;
     bool is_semantic_rule,semantic_rule_not_register=false,warning_info=false;
-    string left_string,semantic_rule_str;
+    string left_string;
+    production_index semantic_rule_not_register_index;
     vector<string> right_string;
 
     //创建一个文件输入流对象
@@ -76,15 +73,19 @@ Grammer::Grammer(const char * filename,map<string,syntax_symbol_index> terminato
     terminator_num_=terminators_.size();
     syntax_variable_num_=0;
     syntax_symbol_num_=0;
-    firsts_=nullptr;
-    follows_=nullptr;
-    syntax_variables_derive_empty_=nullptr;
     productions_=new vector<struct production * >;
     //约定空符号的编号是终结符个数减1
     empty_symbol_=terminator_num_-1;
     //约定栈底符号的编号是终结符个数减2
     stack_bottom_symbol_=terminator_num_-2;
 
+    //终结符集合用位图表示，因此终结符的个数不能超过位图的大小
+    if(terminator_num_>MAX_TERMINATOR_NUM)
+    {
+        cout<<"Too many terminators in grammer!"<<endl;
+        return;
+    }
+
     //第一行读取拓广文法的起始符号，最后要有至少一个空格
     if(getline(inFile,line))
     {
@@ -171,10 +172,11 @@ Grammer::Grammer(const char * filename,map<string,syntax_symbol_index> terminato
                 if(tail==line.npos)
                 {
                     //如果这个语义动作位于该产生式的最后，那么就直接将其作为该产生式对应的语义动作即可
-                    production_semantic_rule_.push_back(semantic_rules[str]);
-                    if(semantic_rule_registers.find(str)!=semantic_rule_registers.end())
+                    production_semantic_rule_.push_back(semantic_rules.count(str)?semantic_rules.at(str):nullptr);
+                    production_semantic_rule_descriptors_.push_back(semantic_rule_descriptor());
+                    if(production_semantic_rule_.back())
                     {
-                        semantic_rule_registers[str](left_string,right_string,"");
+                        register_semantic_rule(&production_semantic_rule_descriptors_.back(),left_string,right_string,"",terminators_);
                     }
                     else
                     {
@@ -198,9 +200,10 @@ Grammer::Grammer(const char * filename,map<string,syntax_symbol_index> terminato
                     new_pr->left=syntax_symbol_index_found;
                     new_pr->right.push_back(empty_symbol_);
                     //将原本的语义动作进行适当的更改之后，作为新生成的产生式的语义动作
-                    production_semantic_rule_.push_back(semantic_rules[str]);
-                    //semantic_rule_registers[str](left_string,right_string);
-                    semantic_rule_str=str;
+                    production_semantic_rule_.push_back(semantic_rules.count(str)?semantic_rules.at(str):nullptr);
+                    production_semantic_rule_descriptors_.push_back(semantic_rule_descriptor());
+                    //该语义动作要等到读取了紧跟在它后面的语法符号之后才能注册
+                    semantic_rule_not_register_index=productions_->size();
                     semantic_rule_not_register=true;
                     //将新生成的产生式加入产生式集合中
                     productions_->push_back(new_pr);
@@ -213,10 +216,9 @@ Grammer::Grammer(const char * filename,map<string,syntax_symbol_index> terminato
                 //如果此时找到的是一个语法符号
                 if(semantic_rule_not_register)
                 {
-                    //semantic_rule_registers[semantic_rule_str](left_string,right_string,str);
-                    if(semantic_rule_registers.find(semantic_rule_str)!=semantic_rule_registers.end())
+                    if(production_semantic_rule_.at(semantic_rule_not_register_index))
                     {
-                        semantic_rule_registers[semantic_rule_str](left_string,right_string,str);
+                        register_semantic_rule(&production_semantic_rule_descriptors_.at(semantic_rule_not_register_index),left_string,right_string,str,terminators_);
                     }
                     else
                     {
@@ -254,6 +256,7 @@ Grammer::Grammer(const char * filename,map<string,syntax_symbol_index> terminato
         {
             //production_semantic_rule_[productions_->size()]=nullptr;
             production_semantic_rule_.push_back(nullptr);
+            production_semantic_rule_descriptors_.push_back(semantic_rule_descriptor());
         }
 
         //将产生式加入文法
@@ -278,12 +281,21 @@ Grammer::Grammer(const char * filename,map<string,syntax_symbol_index> terminato
         productions_->insert(productions_->begin(),pr);
         //拓广文法的第一个产生式没有语义动作
         production_semantic_rule_.insert(production_semantic_rule_.begin(),nullptr);
+        production_semantic_rule_descriptors_.insert(production_semantic_rule_descriptors_.begin(),semantic_rule_descriptor());
     }
     
+    //建立从语法变量到以它为左部的产生式的索引
+    productions_by_left_.assign(syntax_variable_num_,vector<production_index>());
+    for(production_index i=0;i<productions_->size();i++)
+    {
+        productions_by_left_[productions_->at(i)->left-terminator_num_].push_back(i);
+    }
+
     //构造文法的FIRST集和FOLLOW
-    //下面三个函数的顺序不能改变
+    //下面四个函数的顺序不能改变
     get_all_symbol_variables_derive_empty();
     get_all_firsts();
+    get_all_suffix_firsts();
     get_all_follows();
 
     //关闭文件
@@ -301,78 +313,53 @@ Grammer::~Grammer()
         delete i;
     }
     delete productions_;
-
-    //释放所有语法符号的FIRST集和所有语法变量的FOLLOW集
-    if(firsts_ && follows_)
-    {
-        for(int i=0;i<syntax_symbol_num_;i++)
-        {
-            delete firsts_[i];
-            if(i>=terminator_num_)
-            {
-                delete follows_[i-terminator_num_];
-            }
-        }
-        free(firsts_);
-        free(follows_);
-    }
-
-    //释放syntax_variables_derive_empty_
-    if(syntax_variables_derive_empty_)
-    {
-        free(syntax_variables_derive_empty_);
-    }
 }
 
 /*
 获取所有的能够派生出空符号的语法变量
+对每一个产生式记录右部中还没有确定能推导出空符号的语法符号的个数，每当一个语法变量被确定能推导出空符号时，
+就把它所在的产生式的计数减一，计数减到0的产生式的左部也就能推导出空符号了
 */
 void Grammer::get_all_symbol_variables_derive_empty()
 {
-    vector<syntax_symbol_index> right;
-    bool tag=true,tag2;
+    vector<int> not_derive_empty_num(productions_->size(),0);
+    vector<vector<production_index> > occurrences(syntax_variable_num_);
+    vector<syntax_symbol_index> work_list;
+    syntax_symbol_index syn_var;
 
-    syntax_variables_derive_empty_=(bool *)malloc(syntax_variable_num_*sizeof(bool));
+    derive_empty_.assign(syntax_symbol_num_,false);
+    derive_empty_[empty_symbol_]=true;
 
-    //先把所有的语法变量都认为是不能推导出空符号
-    for(syntax_symbol_index syn_var=0;syn_var<syntax_symbol_num_-terminator_num_;syn_var++)
+    for(production_index i=0;i<productions_->size();i++)
     {
-        syntax_variables_derive_empty_[syn_var]=false;
-    }
-
-    //查看有没有能一步直接推导出空符号的语法变量
-    for(auto i : (*productions_))
-    {
-        if(i->right.size()==1 && i->right[0]==empty_symbol_)
+        for(auto j : productions_->at(i)->right)
+        {
+            if(j!=empty_symbol_)
+            {
+                not_derive_empty_num[i]++;
+                if(IS_SYNTAX_VARIABLE(j))
+                {
+                    occurrences[j-terminator_num_].push_back(i);
+                }
+            }
+        }
+        if(not_derive_empty_num[i]==0 && !derive_empty_[productions_->at(i)->left])
         {
-            syntax_variables_derive_empty_[i->left-terminator_num_]=true;
+            derive_empty_[productions_->at(i)->left]=true;
+            work_list.push_back(productions_->at(i)->left);
         }
     }
 
-    //接着反复检查所有语法变量能不能推导出空符号,直到有一次检查没有改变任何东西
-    while(tag)
+    while(!work_list.empty())
     {
-        tag=false;
-        for(auto i : (*productions_))
+        syn_var=work_list.back();
+        work_list.pop_back();
+        for(auto i : occurrences[syn_var-terminator_num_])
         {
-            if(syntax_variables_derive_empty_[i->left-terminator_num_]==true)
+            if(--not_derive_empty_num[i]==0 && !derive_empty_[productions_->at(i)->left])
             {
-                continue;
-            }
-            right=i->right;
-            tag2=true;
-            for(auto j : right)
-            {
-                if((IS_TERMINATOR(j) && j!=empty_symbol_) || syntax_variables_derive_empty_[j-terminator_num_]==false)
-                {
-                    tag2=false;
-                    break;
-                }
-            }
-            if(tag2)
-            {
-                syntax_variables_derive_empty_[i->left-terminator_num_]=true;
-                tag=true;
+                derive_empty_[productions_->at(i)->left]=true;
+                work_list.push_back(productions_->at(i)->left);
             }
         }
     }
@@ -388,255 +375,209 @@ syn_sym:要判断的语法符号编号
 */
 bool Grammer::derive_empty(syntax_symbol_index syn_sym)
 {
-    return IS_TERMINATOR(syn_sym)?(syn_sym==empty_symbol_):syntax_variables_derive_empty_[syn_sym];
+    return derive_empty_[syn_sym];
 }
 
 /*
-判断一个符号串能不能派生出空符号
-Parameters
-----------
-string:要判断的符号串
+获取整个文法的所有语法符号的FIRST集
+对于产生式A->X1X2...Xn，如果X1...Xi-1都能推导出空符号，那么FIRST(Xi)就包含于FIRST(A)
+把这种包含关系看成一条从Xi到A的边，先把终结符直接加入FIRST集，然后沿着边不断传播，直到所有的FIRST集都不再改变为止
+调用该函数之前必须调用get_all_symbol_variables_derive_empty()
 */
-bool Grammer::string_derive_empty(vector<syntax_symbol_index> string)
+void Grammer::get_all_firsts()
 {
-    for(auto i : string)
+    vector<vector<syntax_symbol_index> > edges(syntax_variable_num_);
+    vector<syntax_symbol_index> work_list;
+    vector<bool> in_work_list(syntax_variable_num_,false);
+    syntax_symbol_index A,B;
+    terminator_set old_first;
+
+    first_sets_.assign(syntax_symbol_num_,terminator_set());
+
+    //终结符(包括空符号和栈底符号)的FIRST集就是它自己
+    for(syntax_symbol_index i=0;i<terminator_num_;i++)
     {
-        if(derive_empty(i)==false)
+        first_sets_[i].set(i);
+    }
+
+    for(auto i : (*productions_))
+    {
+        A=i->left;
+        for(auto j : i->right)
         {
-            return false;
+            if(j==empty_symbol_)
+            {
+                continue;
+            }
+            if(IS_TERMINATOR(j))
+            {
+                first_sets_[A].set(j);
+            }
+            else
+            {
+                edges[j-terminator_num_].push_back(A);
+            }
+            if(!derive_empty(j))
+            {
+                break;
+            }
+        }
+        if(!in_work_list[A-terminator_num_])
+        {
+            in_work_list[A-terminator_num_]=true;
+            work_list.push_back(A);
         }
     }
-    return true;
-}
-
-/*
-将一个语法符号集合去除空符号
 
-Parameters
-----------
-syntax_symbol_set:要去除空符号的集合
-*/
-set<syntax_symbol_index> Grammer::set_difference_empty(set<syntax_symbol_index> syntax_symbol_set)
-{
-    int k=0;
-    //cout<<"set_difference_empty start "<<syntax_symbol_set.size()<<endl;
-    for(set<syntax_symbol_index>::iterator i=syntax_symbol_set.begin();i!=syntax_symbol_set.end();i++)
+    while(!work_list.empty())
     {
-        //cout<<(*i)<<endl;
-        //cout<<(++k)<<endl;
-        if((*i)==empty_symbol_)
+        B=work_list.back();
+        work_list.pop_back();
+        in_work_list[B-terminator_num_]=false;
+        for(auto i : edges[B-terminator_num_])
         {
-            //cout<<"S"<<endl;
-            syntax_symbol_set.erase(i);
-            break;
-            //cout<<"E"<<endl;
+            old_first=first_sets_[i];
+            first_sets_[i]|=first_sets_[B];
+            if(old_first!=first_sets_[i] && !in_work_list[i-terminator_num_])
+            {
+                in_work_list[i-terminator_num_]=true;
+                work_list.push_back(i);
+            }
         }
-        //cout<<"ENDNNN"<<endl;
     }
-    //cout<<"set_difference_empty end"<<endl;
-    return syntax_symbol_set;
-}
-
-/*
-获取语法符号的FIRST集
-调用该函数之前必须调用get_all_firsts()
-
-Parameters
-----------
-syn_sym:要求FIRST集的语法符号的编号
 
-Return
-------
-返回一个set集合表示该变量的FIRST集的指针
-*/
-set<syntax_symbol_index> * Grammer::first(syntax_symbol_index syn_sym)
-{
-    return firsts_[syn_sym];
+    //能推导出空符号的语法变量的FIRST集中包含空符号，其余的FIRST集都不包含空符号
+    for(syntax_symbol_index i=terminator_num_;i<syntax_symbol_num_;i++)
+    {
+        first_sets_[i].set(empty_symbol_,derive_empty(i));
+    }
 }
 
 /*
-获取语法符号的FOLLOW集
-调用该函数之前必须调用get_all_follows()
+获取一个符号串的FIRST集
+调用该函数之前必须调用get_all_firsts()
 
 Parameters
 ----------
-syn_sym:要求FOLLOW集的语法符号的编号
+string:要获取FIRST集的符号串
 
 Return
 ------
-返回一个set集合表示该变量的FOLLOW集
+符号串的FIRST集，如果整个符号串都能推导出空符号，那么其中包含空符号
 */
-set<syntax_symbol_index> * Grammer::follow(syntax_symbol_index syn_var)
-{
-    return follows_[syn_var-terminator_num_];
-}
-
-/*
-获取整个文法的所有语法符号的FIRST集
-*/
-void Grammer::get_all_firsts()
+set<syntax_symbol_index> Grammer::string_first(vector<syntax_symbol_index> string)
 {
-    syntax_symbol_index syn_sym;
-    set<syntax_symbol_index> * tmp_first,tmp;
-    vector<syntax_symbol_index> right;
-    int old_size;
-    bool tag=true,tag2;
-
-    firsts_=(set<syntax_symbol_index> **)malloc(syntax_symbol_num_*sizeof(set<syntax_symbol_index> *));
+    terminator_set first;
+    set<syntax_symbol_index> result;
+    bool string_derive_empty=true;
 
-    //遍历所有的语法符号,构造它们最初的FIRST集
-    for(syn_sym=0;syn_sym<syntax_symbol_num_;syn_sym++)
+    for(auto i : string)
     {
-        tmp_first=new set<syntax_symbol_index>;
-        if(syn_sym<terminator_num_)
-        {
-            //如果是常规终结符
-            tmp_first->insert(syn_sym);
-        }
-        else
+        first|=first_sets_[i];
+        if(!derive_empty(i))
         {
-            //如果是非终结符
-            for(auto i : (*productions_))
-            {
-                if(i->left==syn_sym)
-                {
-                    if(IS_NORMAL_TERMINATOR(i->right[0]))
-                    {
-                        tmp_first->insert(i->right[0]);
-                    }
-                    else if(i->right.size()==1 && i->right[0]==empty_symbol_)
-                    {
-                        tmp_first->insert(empty_symbol_);
-                    }
-                }
-            }
+            string_derive_empty=false;
+            break;
         }
-        firsts_[syn_sym]=tmp_first;
     }
-
-    //接着遍历所有的语法变量,不断计算它们的FIRST集,直到所有的FIRST集都不再改变为止
-    while(tag)
+    first.set(empty_symbol_,string_derive_empty);
+    for(syntax_symbol_index i=0;i<terminator_num_;i++)
     {
-        tag=false;
-        for(auto i : (*productions_))
+        if(first.test(i))
         {
-            tmp_first=firsts_[i->left];
-            old_size=tmp_first->size();
-            right=i->right;
-
-            if(IS_SYNTAX_VARIABLE(right[0]))
-            {
-                tmp=set_difference_empty(*(firsts_[right[0]]));
-                set_union(tmp.begin(),tmp.end(),tmp_first->begin(),tmp_first->end(),inserter(*tmp_first,tmp_first->begin()));
-
-                if(derive_empty(right[0]))
-                {
-                    tag2=true;
-                    for(vector<syntax_symbol_index>::iterator j=right.begin();j!=right.end();j++)
-                    {
-                        if(!derive_empty(*j))
-                        {
-                            tag2=false;
-                            for(vector<syntax_symbol_index>::iterator k=right.begin()+1;k!=j+1;k++)
-                            {
-                                tmp=set_difference_empty(*(firsts_[*k]));
-                                set_union(tmp.begin(),tmp.end(),tmp_first->begin(),tmp_first->end(),inserter(*tmp_first,tmp_first->begin()));
-                            }
-                        }
-                    }
-                    if(tag2)
-                    {
-                        tmp_first->insert(empty_symbol_);
-                    }
-                }
-            }
-
-            tag|=(old_size!=tmp_first->size());
+            result.insert(i);
         }
     }
+    return result;
 }
 
 /*
-获取一个符号串的FIRST集
+获取所有的产生式右部的后缀的FIRST集
 调用该函数之前必须调用get_all_firsts()
-
-Parameters
-----------
-string:要获取FIRST集的符号串
 */
-set<syntax_symbol_index> Grammer::string_first(vector<syntax_symbol_index> string)
+void Grammer::get_all_suffix_firsts()
 {
-    int string_length=string.size(),i;
-    set<syntax_symbol_index> result,tmp;
-    if(string_length!=0)
-    {
-        result=set_difference_empty(*first(string[0]));
-
-        i=0;
-        while(first(string[i])->find(empty_symbol_)!=first(string[i])->end() && i<string_length-1)
-        {
-            tmp=set_difference_empty(*first(string[i+1]));
-            set_union(result.begin(),result.end(),tmp.begin(),tmp.end(),inserter(result,result.begin()));
-            i++;
-        }
+    int right_size;
 
-        if(first(string_length-1)->find(empty_symbol_)!=first(string_length-1)->end())
+    //从后往前计算每一个后缀的FIRST集
+    suffix_firsts_.assign(productions_->size(),vector<terminator_set>());
+    suffix_derive_empty_.assign(productions_->size(),vector<bool>());
+    for(production_index i=0;i<productions_->size();i++)
+    {
+        right_size=productions_->at(i)->right.size();
+        suffix_firsts_[i].assign(right_size+1,terminator_set());
+        suffix_derive_empty_[i].assign(right_size+1,true);
+        for(int j=right_size-1;j>=0;j--)
         {
-            result.insert(empty_symbol_);
+            const terminator_set & first=first_sets_[productions_->at(i)->right[j]];
+            suffix_firsts_[i][j]=first;
+            suffix_firsts_[i][j].reset(empty_symbol_);
+            suffix_derive_empty_[i][j]=derive_empty(productions_->at(i)->right[j]) && suffix_derive_empty_[i][j+1];
+            if(derive_empty(productions_->at(i)->right[j]))
+            {
+                suffix_firsts_[i][j]|=suffix_firsts_[i][j+1];
+            }
         }
     }
-    return result;
 }
 
 /*
 获取整个文法的所有语法变量的FOLLOW集
+对于产生式A->αBβ，FIRST(β)中除了空符号之外的终结符都属于FOLLOW(B)，如果β能推导出空符号，那么FOLLOW(A)包含于FOLLOW(B)
+把后一种包含关系看成一条从A到B的边，先加入所有的FIRST(β)，然后沿着边不断传播，直到所有的FOLLOW集都不再改变为止
+调用该函数之前必须调用get_all_suffix_firsts()
 */
 void Grammer::get_all_follows()
 {
-    syntax_symbol_index syn_var,A,B;
-    vector<syntax_symbol_index> right,string;
-    set<syntax_symbol_index> *tmp_follow,tmp;
-    int old_size;
-    bool tag=true;
+    vector<vector<syntax_variable_index> > edges(syntax_variable_num_);
+    vector<syntax_variable_index> work_list;
+    vector<bool> in_work_list(syntax_variable_num_,true);
+    syntax_variable_index A,B;
+    terminator_set old_follow;
 
-    follows_=(set<syntax_symbol_index> **)malloc(syntax_variable_num_*sizeof(set<syntax_symbol_index> *));
+    follow_sets_.assign(syntax_variable_num_,terminator_set());
 
-    //先把所有的语法变量的FOLLOW集设置为空集
-    for(syn_var=0;syn_var<syntax_variable_num_;syn_var++)
-    {
-        follows_[syn_var]=new set<syntax_symbol_index>;
-    }
-    //把起始符号的FOLLOW集设置为只有一个栈底符号
-    follows_[start_symbol_-terminator_num_]->insert(stack_bottom_symbol_);
-    //遍历所有的产生式，计算所有语法变量的FOLLOW集，直到所有的FOLLOW集都不再变化为止
-    while(tag)
+    //起始符号的FOLLOW集中有栈底符号
+    follow_sets_[start_symbol_-terminator_num_].set(stack_bottom_symbol_);
+
+    for(production_index i=0;i<productions_->size();i++)
     {
-        tag=false;
-        for(vector<struct production * >::iterator i=productions_->begin();i!=productions_->end();i++)
+        A=productions_->at(i)->left-terminator_num_;
+        const vector<syntax_symbol_index> & right=productions_->at(i)->right;
+        for(int j=0;j<right.size();j++)
         {
-            A=(*i)->left-terminator_num_;
-            right=(*i)->right;
-            for(vector<syntax_symbol_index>::iterator j=right.begin();j!=right.end();j++)
+            if(IS_SYNTAX_VARIABLE(right[j]))
             {
-                B=(*j);
-                if(IS_SYNTAX_VARIABLE(B))
+                B=right[j]-terminator_num_;
+                follow_sets_[B]|=suffix_firsts_[i][j+1];
+                if(suffix_derive_empty_[i][j+1] && A!=B)
                 {
-                    B-=terminator_num_;
-                    tmp_follow=follows_[B];
-                    old_size=tmp_follow->size();
-                    string=vector<syntax_symbol_index>(j+1,right.end());
-                    tmp=set_difference_empty(string_first(string));
-                    set_union(tmp_follow->begin(),tmp_follow->end(),tmp.begin(),tmp.end(),inserter(*tmp_follow,tmp_follow->begin()));
-
-                    if(j==right.end()-1 || (string_derive_empty(string) && A!=B))
-                    {
-                        set_union(tmp_follow->begin(),tmp_follow->end(),follows_[A]->begin(),follows_[A]->end(),inserter(*tmp_follow,tmp_follow->begin()));
-                    }
-                    tag|=(old_size!=tmp_follow->size());
+                    edges[A].push_back(B);
                 }
             }
         }
     }
+
+    for(syntax_variable_index i=0;i<syntax_variable_num_;i++)
+    {
+        work_list.push_back(i);
+    }
+    while(!work_list.empty())
+    {
+        A=work_list.back();
+        work_list.pop_back();
+        in_work_list[A]=false;
+        for(auto i : edges[A])
+        {
+            old_follow=follow_sets_[i];
+            follow_sets_[i]|=follow_sets_[A];
+            if(old_follow!=follow_sets_[i] && !in_work_list[i])
+            {
+                in_work_list[i]=true;
+                work_list.push_back(i);
+            }
+        }
+    }
 }
 
 /*
@@ -7,6 +7,7 @@
  *
 */
 #include"ic_optimizer.h"
+#include "time_report.h"
 #include<fstream>
 #include<iostream>
 
@@ -63,14 +64,30 @@ Return
 */
 struct ic_flow_graph * Ic_optimizer::optimize(list<struct quaternion> * intermediate_codes)
 {
+    size_t basic_block_num=0;
+
     //建立中间代码流图
+    Time_report::begin_stage("flow graph build");
     intermediate_codes_flow_graph_=new struct ic_flow_graph(intermediate_codes);
+    Time_report::end_stage();
+    for(auto i:intermediate_codes_flow_graph_->func_flow_graphs)
+    {
+        basic_block_num+=i->basic_blocks.size();
+    }
+    Time_report::add_counter("functions",intermediate_codes_flow_graph_->func_flow_graphs.size());
+    Time_report::add_counter("basic blocks",basic_block_num);
     //进行局部优化
+    Time_report::begin_stage("local optimize");
     local_optimize();
+    Time_report::end_stage();
     //进行数据流分析
+    Time_report::begin_stage("data flow analysis");
     data_flow_analysis();
+    Time_report::end_stage();
     //进行全局优化
+    Time_report::begin_stage("global optimize");
     global_optimize();
+    Time_report::end_stage();
     //返回优化结果
     return intermediate_codes_flow_graph_;
 }
@@ -7,6 +7,10 @@
  *
 */
 #include "instruction_generator.h"
+#include<mutex>
+
+//多个线程同时建立汇编指令生成器的时候互斥地写寄存器信息
+static mutex regs_info_mutex;
 
 /*
 构造函数
@@ -17,7 +21,14 @@ regs_info:寄存器信息
 */
 Instruction_generator::Instruction_generator(map<reg_index,string> regs_info)
 {
-    regs_info_=regs_info;
+    //所有的汇编指令生成器使用的寄存器信息都是一样的，只在第一次建立的时候赋值，之后就是只读的
+    {
+        lock_guard<mutex> lock(regs_info_mutex);
+        if(regs_info_.empty())
+        {
+            regs_info_=regs_info;
+        }
+    }
     is_init_successful_=true;
 }
 
@@ -11,7 +11,7 @@
 /*
 构造函数
 */
-Intermediate_code_manager::Intermediate_code_manager():intermediate_codes_flow_graph_(nullptr)
+Intermediate_code_manager::Intermediate_code_manager():intermediate_codes_flow_graph_(nullptr),first_tag_(true),end_tag_(false)
 {
 
 }
@@ -34,32 +34,56 @@ intermediate_codes_flow_graph:中间代码流图
 void Intermediate_code_manager::init(struct ic_flow_graph * intermediate_codes_flow_graph)
 {
     intermediate_codes_flow_graph_=intermediate_codes_flow_graph;
+    if(intermediate_codes_flow_graph_)
+    {
+        current_global_define_=intermediate_codes_flow_graph_->global_defines.begin();
+        begin_func_=intermediate_codes_flow_graph_->func_flow_graphs.begin();
+        end_func_=intermediate_codes_flow_graph_->func_flow_graphs.end();
+    }
+    first_tag_=true;
+    end_tag_=false;
+}
+
+/*
+初始化中间代码管理器，只转换流图中的一部分函数
+按照函数并行生成汇编代码的时候，每一个函数都由一个单独的汇编代码生成器进行转换，全局定义则由另外一个汇编代码生成器转换
+
+Parameters
+----------
+intermediate_codes_flow_graph:中间代码流图
+begin_func:要转换的第一个函数
+end_func:要转换的最后一个函数的下一个位置
+with_global_defines:是否要转换全局定义
+*/
+void Intermediate_code_manager::init(struct ic_flow_graph * intermediate_codes_flow_graph,list<struct ic_func_flow_graph * >::iterator begin_func,list<struct ic_func_flow_graph * >::iterator end_func,bool with_global_defines)
+{
+    intermediate_codes_flow_graph_=intermediate_codes_flow_graph;
+    current_global_define_=with_global_defines?intermediate_codes_flow_graph_->global_defines.begin():intermediate_codes_flow_graph_->global_defines.end();
+    begin_func_=begin_func;
+    end_func_=end_func;
+    first_tag_=true;
+    end_tag_=false;
 }
 
 struct event Intermediate_code_manager::handle_NEXT_IC()
 {
     struct event res(event_type::RESPONSE_POINTER,nullptr);
-    static list<struct quaternion>::iterator current_global_define=intermediate_codes_flow_graph_->global_defines.begin();
-    // static list<struct ic_func_flow_graph * >::iterator current_func;
-    // static list<struct ic_basic_block * >::iterator current_basic_block;
-    // static vector<struct quaternion_with_def_use_info>::iterator current_ic;
-    static bool first_tag=true,end_tag=false;
     if(intermediate_codes_flow_graph_)
     {
-        if(current_global_define!=intermediate_codes_flow_graph_->global_defines.end())
+        if(current_global_define_!=intermediate_codes_flow_graph_->global_defines.end())
         {
-            res.pointer_data=&(*current_global_define);
-            current_global_define++;
+            res.pointer_data=&(*current_global_define_);
+            current_global_define_++;
         }
-        else if(!end_tag)
+        else if(!end_tag_)
         {
-            if(!first_tag)
+            if(!first_tag_)
             {
                 goto not_first_pos;
             }
-            first_tag=false;
-            current_func_=intermediate_codes_flow_graph_->func_flow_graphs.begin();
-            while(current_func_!=intermediate_codes_flow_graph_->func_flow_graphs.end())
+            first_tag_=false;
+            current_func_=begin_func_;
+            while(current_func_!=end_func_)
             {
                 notify(event(event_type::START_FUNC,(void *)(*current_func_)->func));
                 current_basic_block_=(*current_func_)->basic_blocks.begin();
@@ -80,7 +104,7 @@ not_first_pos:
                 notify(event(event_type::END_FUNC,nullptr));
                 current_func_++;
             }
-            end_tag=true;
+            end_tag_=true;
         }
     }
     return res;
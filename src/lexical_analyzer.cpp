@@ -10,6 +10,49 @@
 #include "lexical_analyzer.h"
 #include "symbol_table.h"
 
+#include<string.h>
+
+#if defined(__AVX2__)
+#include<immintrin.h>
+#elif defined(__SSE2__)
+#include<emmintrin.h>
+#endif
+
+//字符类别
+#define CHAR_CLASS_BLANK 0x01               //空白字符
+#define CHAR_CLASS_ALPHA 0x02               //字母和下划线(标识符的第一个字符)
+#define CHAR_CLASS_DIGIT 0x04               //0到9的数字
+#define CHAR_CLASS_ID (CHAR_CLASS_ALPHA | CHAR_CLASS_DIGIT)        //标识符中的字符
+
+//每一个字符对应的字符类别
+static const struct char_class_table
+{
+    char_class_table()
+    {
+        for(int ch=0;ch<256;ch++)
+        {
+            classes[ch]=0;
+            if(ch<=32 || ch==127)
+            {
+                classes[ch]|=CHAR_CLASS_BLANK;
+            }
+            if((ch>='a' && ch<='z') || (ch>='A' && ch<='Z') || ch=='_')
+            {
+                classes[ch]|=CHAR_CLASS_ALPHA;
+            }
+            if(ch>='0' && ch<='9')
+            {
+                classes[ch]|=CHAR_CLASS_DIGIT;
+            }
+        }
+    };
+
+    unsigned char classes[256];
+} char_classes;
+
+//获取字符的类别
+#define get_char_class(ch) (char_classes.classes[(unsigned char)(ch)])
+
 //判断缓冲区指针是不是位于第一个缓冲区
 #define in_first_buf(index) ((index>=0) && (index<BUF_SIZE))                    
 //判断缓冲区指针是不是位于第二个缓冲区
@@ -27,9 +70,11 @@
 //将缓冲区指针移到双缓冲区中的上一个位置
 #define pre_pos(index) (index=((index-1)%(BUF_SIZE<<1)))                        
 //判断字符是不是空格字符
-#define is_blank(ch) ((ch>=0 && ch<=32) || ch==127)                             
-//判断字符是不是字母
-#define is_alpha(ch) ((ch>='a' && ch<='z') || (ch>='A' && ch<='Z'))
+#define is_blank(ch) (get_char_class(ch) & CHAR_CLASS_BLANK)
+//判断字符能不能作为标识符的第一个字符(字母和下划线)
+#define is_id_begin(ch) (get_char_class(ch) & CHAR_CLASS_ALPHA)
+//判断字符能不能出现在标识符中(字母，数字和下划线)
+#define is_id_char(ch) (get_char_class(ch) & CHAR_CLASS_ID)
 //判断某一个字符串能不能表示转义字符
 #define is_escape_char(string) (escape_char.find(string)==escape_char.end())
 //判断某一个字符是不是转义字符中的斜杠后面的字符
@@ -45,35 +90,172 @@
 ((ch>='0' && ch<='9') || (ch>='a' && ch<='f') || (ch>='A' && ch<='F')):\
 false)))))))
 
+//SIMD指令一次能处理的字符个数以及相关操作，没有SSE2和AVX2的平台只使用标量代码
+#if defined(__AVX2__)
+#define SIMD_WIDTH 32
+#define SIMD_FULL_MASK 0xffffffffu
+typedef __m256i simd_chars;
+#define simd_load(p) _mm256_loadu_si256((const __m256i *)(p))
+#define simd_set1(ch) _mm256_set1_epi8(ch)
+#define simd_eq(a,b) _mm256_cmpeq_epi8(a,b)
+#define simd_gt(a,b) _mm256_cmpgt_epi8(a,b)
+#define simd_and(a,b) _mm256_and_si256(a,b)
+#define simd_or(a,b) _mm256_or_si256(a,b)
+#define simd_movemask(a) ((unsigned int)_mm256_movemask_epi8(a))
+#elif defined(__SSE2__)
+#define SIMD_WIDTH 16
+#define SIMD_FULL_MASK 0xffffu
+typedef __m128i simd_chars;
+#define simd_load(p) _mm_loadu_si128((const __m128i *)(p))
+#define simd_set1(ch) _mm_set1_epi8(ch)
+#define simd_eq(a,b) _mm_cmpeq_epi8(a,b)
+#define simd_gt(a,b) _mm_cmpgt_epi8(a,b)
+#define simd_and(a,b) _mm_and_si128(a,b)
+#define simd_or(a,b) _mm_or_si128(a,b)
+#define simd_movemask(a) ((unsigned int)_mm_movemask_epi8(a))
+#endif
+
+#ifdef SIMD_WIDTH
+//判断每一个字符是否在[lo,hi]之间(lo和hi都需要在1到126之间)
+#define simd_in_range(chars,lo,hi) simd_and(simd_gt(chars,simd_set1((lo)-1)),simd_gt(simd_set1((hi)+1),chars))
+#endif
+
 /*
-获取缓冲区中的下一个字符
+跳过从p开始的连续的空白字符
+'\0'不在这里跳过，需要调用者判断它是不是源程序末尾的哨兵
+
+Parameters
+----------
+p:开始扫描的位置
+end:源程序末尾的哨兵的位置，SIMD指令不会读取end及其之后的内存
+line:每跳过一个换行符就加1
+
+Return
+------
+第一个不是空白字符(或者是'\0')的位置
 */
-#define next_char(cok,ch) ch=double_buf_[lexeme_ending_];\
-next_pos(lexeme_ending_);\
-if(ch==EOF)\
+static inline const char * skip_blank_run(const char * p,const char * end,int & line)
+{
+    //大多数单词之间只有一个空格，先用标量代码判断一下
+    if(!is_blank(*p) || *p=='\0')
+    {
+        return p;
+    }
+#ifdef SIMD_WIDTH
+    simd_chars chars;
+    unsigned int blank_mask,line_feed_mask;
+    int n;
+    while(end-p>=SIMD_WIDTH)
+    {
+        chars=simd_load(p);
+        blank_mask=simd_movemask(simd_or(simd_in_range(chars,1,32),simd_eq(chars,simd_set1(127))));
+        line_feed_mask=simd_movemask(simd_eq(chars,simd_set1('\n')));
+        if(blank_mask!=SIMD_FULL_MASK)
+        {
+            n=__builtin_ctz(~blank_mask);
+            line+=__builtin_popcount(line_feed_mask&((1u<<n)-1));
+            return p+n;
+        }
+        line+=__builtin_popcount(line_feed_mask);
+        p+=SIMD_WIDTH;
+    }
+#endif
+    while(is_blank(*p) && *p!='\0')
+    {
+        if(*p=='\n')
+        {
+            line++;
+        }
+        p++;
+    }
+    return p;
+}
+
+/*
+跳过从p开始的连续的标识符中的字符(字母，数字和下划线)
+
+Parameters
+----------
+p:开始扫描的位置
+end:源程序末尾的哨兵的位置，SIMD指令不会读取end及其之后的内存
+
+Return
+------
+第一个不能出现在标识符中的字符的位置
+*/
+static inline const char * scan_id_run(const char * p,const char * end)
+{
+#ifdef SIMD_WIDTH
+    simd_chars chars;
+    unsigned int id_mask;
+    while(end-p>=SIMD_WIDTH)
+    {
+        chars=simd_load(p);
+        //字母转换成小写之后判断是不是在a到z之间
+        id_mask=simd_movemask(simd_or(simd_or(simd_in_range(simd_or(chars,simd_set1(0x20)),'a','z'),simd_in_range(chars,'0','9')),simd_eq(chars,simd_set1('_'))));
+        if(id_mask!=SIMD_FULL_MASK)
+        {
+            return p+__builtin_ctz(~id_mask);
+        }
+        p+=SIMD_WIDTH;
+    }
+#endif
+    while(is_id_char(*p))
+    {
+        p++;
+    }
+    return p;
+}
+
+/*
+跳过从p开始的连续的十进制数字
+
+Parameters
+----------
+p:开始扫描的位置
+end:源程序末尾的哨兵的位置，SIMD指令不会读取end及其之后的内存
+
+Return
+------
+第一个不是十进制数字的字符的位置
+*/
+static inline const char * scan_digit_run(const char * p,const char * end)
+{
+#ifdef SIMD_WIDTH
+    simd_chars chars;
+    unsigned int digit_mask;
+    while(end-p>=SIMD_WIDTH)
+    {
+        chars=simd_load(p);
+        digit_mask=simd_movemask(simd_in_range(chars,'0','9'));
+        if(digit_mask!=SIMD_FULL_MASK)
+        {
+            return p+__builtin_ctz(~digit_mask);
+        }
+        p+=SIMD_WIDTH;
+    }
+#endif
+    while(get_char_class(*p) & CHAR_CLASS_DIGIT)
+    {
+        p++;
+    }
+    return p;
+}
+
+/*
+获取源程序中的下一个字符
+到了源程序末尾的时候，只有字符常量和字符串常量需要报错，其他单词把末尾的哨兵('\0'或者EOF)当成一个普通的字符，之后再回退即可
+*/
+#define next_char(cok,ch) if(!read_char(ch) && (cok==code_of_kind::CONST_CHAR || cok==code_of_kind::CONST_STRING))\
 {\
-    if(in_buf_begin(lexeme_ending_))\
+    retract(1);\
+    append_to_string_buf();\
+    error_handle((cok==code_of_kind::CONST_CHAR)?my_error_code::UNCLOSED_CONST_CHAR:my_error_code::UNCLOSED_CONST_STRING);\
+    if(!br_stack_.empty())\
     {\
-        ch=double_buf_[lexeme_ending_];\
-        next_pos(lexeme_ending_);\
-    }\
-    else\
-    {\
-        if(cok==code_of_kind::CONST_CHAR || cok==code_of_kind::CONST_STRING)\
-        {\
-            append_to_string_buf();\
-            error_handle((cok==code_of_kind::CONST_CHAR)?my_error_code::UNCLOSED_CONST_CHAR:my_error_code::UNCLOSED_CONST_STRING);\
-            if(!br_stack_.empty())\
-            {\
-                error_handle(my_error_code::UNCLOSED_LEFT_BRACKET);\
-            }\
-            return nullptr;\
-        }\
-        else\
-        {\
-            return get_token(cok);\
-        }\
+        error_handle(my_error_code::UNCLOSED_LEFT_BRACKET);\
     }\
+    return nullptr;\
 }
 
 //定义关键字
@@ -85,7 +267,7 @@ extern map<string,char> escape_char;
 /*
 词法分析器的构造函数
 */
-Lexical_analyzer::Lexical_analyzer()
+Lexical_analyzer::Lexical_analyzer():source_program_(nullptr),source_program_buf_(nullptr),source_program_buf_size_(0),source_program_buf_pos_(0),input_mode_(lexical_input_mode::DOUBLE_BUF),token_stream_(nullptr)
 {
     
 }
@@ -96,13 +278,17 @@ Lexical_analyzer::Lexical_analyzer()
 Paramters
 ---------
 source_program_filename:预处理之后的源程序文件名
+input_mode:读取源程序的方式
 
 Return
 ------
 如果初始化成功，就返回true，否则返回false
 */
-bool Lexical_analyzer::init(const char * source_program_filename)
+bool Lexical_analyzer::init(const char * source_program_filename,enum lexical_input_mode input_mode)
 {
+    char buf[BUF_SIZE];
+    size_t read_length;
+
     //打开文件
     source_program_=fopen(source_program_filename,"r");
     if(source_program_==nullptr)
@@ -111,9 +297,79 @@ bool Lexical_analyzer::init(const char * source_program_filename)
         return false;
     }
 
+    //WHOLE_BUF模式下一次性读入整个文件，之后就不再需要这个文件了
+    if(input_mode==lexical_input_mode::WHOLE_BUF)
+    {
+        whole_buf_.clear();
+        while((read_length=fread(buf,1,BUF_SIZE,source_program_))>0)
+        {
+            whole_buf_.append(buf,read_length);
+        }
+        fclose(source_program_);
+        source_program_=nullptr;
+        source_program_buf_=whole_buf_.c_str();
+        source_program_buf_size_=whole_buf_.size();
+        source_program_buf_pos_=0;
+    }
+
+    init_buf(input_mode);
+
+    return true;
+}
+
+/*
+使用内存中的源程序对词法分析器进行初始化
+词法分析器不会复制源程序，所以在词法分析结束之前source_program不能被释放
+
+Paramters
+---------
+source_program:预处理之后的源程序
+input_mode:读取源程序的方式
+
+Return
+------
+如果初始化成功，就返回true，否则返回false
+*/
+bool Lexical_analyzer::init_from_string(const string & source_program,enum lexical_input_mode input_mode)
+{
+    source_program_buf_=source_program.c_str();
+    source_program_buf_size_=source_program.size();
+    source_program_buf_pos_=0;
+
+    init_buf(input_mode);
+
+    return true;
+}
+
+/*
+初始化缓冲区等词法分析的状态
+
+Paramters
+---------
+input_mode:读取源程序的方式
+*/
+void Lexical_analyzer::init_buf(enum lexical_input_mode input_mode)
+{
     line_=1;
     string_buf_=nullptr;
     last_error_=my_error_code::NO_ERROR;
+    input_mode_=input_mode;
+
+    //字符串表保存在token序列中，边词法分析边语法分析的时候token序列是空的
+    if(token_stream_)
+    {
+        delete token_stream_;
+    }
+    token_stream_=new struct token_stream;
+    string_kinds_.clear();
+
+    if(input_mode_==lexical_input_mode::WHOLE_BUF)
+    {
+        //string保证了c_str()的末尾一定有一个'\0'，直接把它作为哨兵，不需要再复制一遍源程序
+        lexeme_begining_ptr_=source_program_buf_;
+        lexeme_ending_ptr_=source_program_buf_;
+        return;
+    }
 
     //构建双缓冲区
     double_buf_[BUF_SIZE-1]=EOF;
@@ -126,8 +382,6 @@ bool Lexical_analyzer::init(const char * source_program_filename)
     write_buf();
     lexeme_begining_=0;
     lexeme_ending_=0;
-
-    return true;
 }
 
 /*
@@ -139,6 +393,10 @@ Lexical_analyzer::~Lexical_analyzer()
     {
         fclose(source_program_);
     }
+    if(token_stream_)
+    {
+        delete token_stream_;
+    }
 }
 
 /*
@@ -146,7 +404,34 @@ Lexical_analyzer::~Lexical_analyzer()
 */
 bool Lexical_analyzer::is_init_success()
 {
-    return (source_program_!=nullptr);
+    return (source_program_!=nullptr || source_program_buf_!=nullptr);
+}
+
+/*
+从源程序文件或者内存中的源程序中读取最多length个字符
+
+Parameters
+----------
+buf:读取的字符存放的位置
+length:最多读取的字符个数
+
+Return
+------
+实际读取的字符个数
+*/
+size_t Lexical_analyzer::read_source_program(char * buf,size_t length)
+{
+    if(source_program_buf_)
+    {
+        if(length>source_program_buf_size_-source_program_buf_pos_)
+        {
+            length=source_program_buf_size_-source_program_buf_pos_;
+        }
+        memcpy(buf,source_program_buf_+source_program_buf_pos_,length);
+        source_program_buf_pos_+=length;
+        return length;
+    }
+    return fread(buf,1,length,source_program_);
 }
 
 /*
@@ -162,7 +447,7 @@ bool Lexical_analyzer::write_buf()
     int read_length;
     if(!vaild_first_buf_)
     {
-        read_length=fread(double_buf_,1,(BUF_SIZE-1),source_program_);
+        read_length=read_source_program(double_buf_,(BUF_SIZE-1));
         if(read_length!=(BUF_SIZE-1))
         {
             double_buf_[read_length]=EOF;
@@ -171,7 +456,7 @@ bool Lexical_analyzer::write_buf()
     }
     else if(!vaild_second_buf_)
     {
-        read_length=fread(double_buf_+BUF_SIZE,1,(BUF_SIZE-1),source_program_);
+        read_length=read_source_program(double_buf_+BUF_SIZE,(BUF_SIZE-1));
         if(read_length!=(BUF_SIZE-1))
         {
             double_buf_[BUF_SIZE+read_length]=EOF;
@@ -185,6 +470,40 @@ bool Lexical_analyzer::write_buf()
     return result;
 }
 
+/*
+读入源程序中的下一个字符
+WHOLE_BUF模式下直接移动指针，末尾的'\0'就是哨兵；DOUBLE_BUF模式下遇到缓冲区末尾的EOF的时候切换到另一个缓冲区
+到了源程序末尾的时候ch是哨兵，结束指针也会越过哨兵，之后可以像普通的字符一样回退
+
+Parameters
+----------
+ch:读入的字符
+
+Return
+------
+读入的是源程序中的字符就返回true，到了源程序末尾就返回false
+*/
+bool Lexical_analyzer::read_char(char & ch)
+{
+    if(input_mode_==lexical_input_mode::WHOLE_BUF)
+    {
+        ch=*(lexeme_ending_ptr_++);
+        return (ch!='\0' || lexeme_ending_ptr_<=source_program_buf_+source_program_buf_size_);
+    }
+    ch=double_buf_[lexeme_ending_];
+    next_pos(lexeme_ending_);
+    if(ch==EOF)
+    {
+        if(!in_buf_begin(lexeme_ending_))
+        {
+            return false;
+        }
+        ch=double_buf_[lexeme_ending_];
+        next_pos(lexeme_ending_);
+    }
+    return true;
+}
+
 /*
 将已读入的字符回退
 
@@ -199,6 +518,11 @@ Return
 int Lexical_analyzer::retract(int num)
 {
     int i;
+    if(input_mode_==lexical_input_mode::WHOLE_BUF)
+    {
+        lexeme_ending_ptr_-=num;
+        return num;
+    }
     for(i=0;i<num && i<MAX_RETRACT_NUM;i++)
     {
         pre_pos(lexeme_ending_);
@@ -217,6 +541,13 @@ string Lexical_analyzer::get_token_string()
 {
     string result,tmp;
 
+    if(input_mode_==lexical_input_mode::WHOLE_BUF)
+    {
+        result=string(lexeme_begining_ptr_,lexeme_ending_ptr_-lexeme_begining_ptr_);
+        lexeme_begining_ptr_=lexeme_ending_ptr_;
+        return result;
+    }
+
     if(in_first_buf(lexeme_begining_) && in_second_buf(lexeme_ending_))                 //开始指针在第一个缓冲区而结束指针在第二个缓冲区
     {
         result=string(double_buf_+lexeme_begining_,(BUF_SIZE-1-lexeme_begining_));
@@ -271,7 +602,32 @@ Return
 */
 bool Lexical_analyzer::skip_all_blanks()
 {
+    const char * source_program_end;
     char ch;
+
+    if(input_mode_==lexical_input_mode::WHOLE_BUF)
+    {
+        source_program_end=source_program_buf_+source_program_buf_size_;
+        while(true)
+        {
+            lexeme_ending_ptr_=skip_blank_run(lexeme_ending_ptr_,source_program_end,line_);
+            if(*lexeme_ending_ptr_!='\0')
+            {
+                break;
+            }
+            //遇到了末尾的哨兵就说明源程序已经扫描完了
+            if(lexeme_ending_ptr_==source_program_end)
+            {
+                lexeme_begining_ptr_=lexeme_ending_ptr_;
+                return false;
+            }
+            //源程序中间的'\0'也是空白字符
+            lexeme_ending_ptr_++;
+        }
+        lexeme_begining_ptr_=lexeme_ending_ptr_;
+        return true;
+    }
+
     if(double_buf_[lexeme_begining_]==EOF)
     {
         return false;
@@ -317,20 +673,27 @@ bool Lexical_analyzer::skip_all_blanks()
     return true;
 }
 
+/*
+获取当前结束指针指向的字符
+*/
+char Lexical_analyzer::get_current_char()
+{
+    return (input_mode_==lexical_input_mode::WHOLE_BUF)?(*lexeme_ending_ptr_):double_buf_[lexeme_ending_];
+}
+
 /*
 将此时识别出来的串加入string缓冲区的末尾
 （此时需要保证string缓冲区string_buf_有效）
 */
 void Lexical_analyzer::append_to_string_buf()
 {
-    string string_tmp=get_token_string();
     if(string_buf_==nullptr)
     {
-        string_buf_=new string(string_tmp);
+        string_buf_=new string(get_token_string());
     }
     else 
     {
-        string_buf_->append(string_tmp);
+        string_buf_->append(get_token_string());
     }
 }
 
@@ -347,14 +710,30 @@ Return
 */
 struct token * Lexical_analyzer::get_token(enum code_of_kind cok)
 {
-    struct token * result=new struct token;
-    string token_string,*token_string_value;
+    struct token * result=&token_;
+    string token_string,token_string_value;
     char ch;
     int token_len,i;
-    Symbol_table * symbol_table=Symbol_table::get_instance();
     result->code_of_kind=cok;
 
-    if(cok==code_of_kind::CONST_CHAR || cok==code_of_kind::CONST_STRING || cok==code_of_kind::ID)
+    //标识符直接加入字符串表
+    if(cok==code_of_kind::ID)
+    {
+        result=get_id_token(string_buf_->data(),string_buf_->size());
+        delete string_buf_;
+        string_buf_=nullptr;
+        return result;
+    }
+
+    //WHOLE_BUF模式下整常数后面紧跟着的一定不是这个进制的数字，所以可以直接在源程序上转换，运算符也不需要构造字符串
+    if(input_mode_==lexical_input_mode::WHOLE_BUF && cok!=code_of_kind::CONST_FLOAT && cok!=code_of_kind::CONST_CHAR && cok!=code_of_kind::CONST_STRING)
+    {
+        result->attribute_value.int_value=(cok==code_of_kind::CONST_INT)?strtol(lexeme_begining_ptr_,nullptr,base_):0;
+        lexeme_begining_ptr_=lexeme_ending_ptr_;
+        return result;
+    }
+
+    if(cok==code_of_kind::CONST_CHAR || cok==code_of_kind::CONST_STRING)
     {
         token_string=*string_buf_;
         delete string_buf_;
@@ -367,17 +746,6 @@ struct token * Lexical_analyzer::get_token(enum code_of_kind cok)
 
     switch(cok)
     {
-        case code_of_kind::ID:
-            if(key_word.find(token_string)==key_word.end())
-            {
-                result->attribute_value.p_string_value=new string(token_string);
-            }
-            else
-            {
-                result->code_of_kind=key_word[token_string];
-                result->attribute_value.int_value=0;
-            }
-            break;
         case code_of_kind::CONST_INT:
             result->attribute_value.int_value=strtol(token_string.c_str(),nullptr,base_);
             break;
@@ -389,21 +757,20 @@ struct token * Lexical_analyzer::get_token(enum code_of_kind cok)
             result->attribute_value.char_value=(ch!='\\')?ch:escape_char[token_string.substr(1,2)];
             break;
         case code_of_kind::CONST_STRING:
-            token_string_value=new string();
             token_len=token_string.length();
             for(i=1;i<token_len-1;i++)
             {
                 ch=token_string.at(i);
                 if(ch!='\\')
                 {
-                    (*token_string_value)+=ch;
+                    token_string_value+=ch;
                 }
                 else
                 {
-                    (*token_string_value)+=escape_char[token_string.substr(i++,2)];
+                    token_string_value+=escape_char[token_string.substr(i++,2)];
                 }
             }
-            result->attribute_value.p_string_value=token_string_value;
+            result->attribute_value.string_id=token_stream_->strings.intern(token_string_value.data(),token_string_value.size());
             break;
         default:
             result->attribute_value.int_value=0;
@@ -413,6 +780,43 @@ struct token * Lexical_analyzer::get_token(enum code_of_kind cok)
     return result;
 }
 
+/*
+将标识符加入字符串表，并且根据它是不是保留字确定种别码
+每一个不同的字符串只需要查找一次保留字表
+
+Parameters
+----------
+str:标识符的起始位置
+length:标识符的长度
+
+Return
+------
+识别出来的token
+*/
+struct token * Lexical_analyzer::get_id_token(const char * str,size_t length)
+{
+    map<string,enum code_of_kind>::iterator key_word_iter;
+    int id=token_stream_->strings.intern(str,length);
+
+    //这是一个新加入字符串表的字符串，查找它是不是保留字
+    while((size_t)id>=string_kinds_.size())
+    {
+        key_word_iter=key_word.find(*token_stream_->strings.get_string(string_kinds_.size()));
+        string_kinds_.push_back((key_word_iter==key_word.end())?code_of_kind::ID:key_word_iter->second);
+    }
+
+    token_.code_of_kind=string_kinds_[id];
+    if(token_.code_of_kind==code_of_kind::ID)
+    {
+        token_.attribute_value.string_id=id;
+    }
+    else
+    {
+        token_.attribute_value.int_value=0;
+    }
+    return &token_;
+}
+
 /*
 把左括号压入栈中
 
@@ -482,6 +886,27 @@ bool Lexical_analyzer::right_br_pop(enum code_of_kind r_br_cok)
     return false;
 }
 
+/*
+检查右括号是否能够和栈顶的左括号匹配，如果不能匹配就进行错误处理
+
+Parameters
+----------
+r_br_cok:右括号的种别码
+*/
+void Lexical_analyzer::right_br_check(enum code_of_kind r_br_cok)
+{
+    if(br_stack_.empty())
+    {
+        br_stack_.push({r_br_cok,line_});
+        error_handle(my_error_code::UNCLOSED_RIGHT_BRACKET);
+    }
+    else if(!right_br_pop(r_br_cok))
+    {
+        br_stack_.push({r_br_cok,line_});
+        error_handle(my_error_code::UNMATCHED_BRACKET);
+    }
+}
+
 /*
 错误处理
 */
@@ -593,7 +1018,7 @@ void Lexical_analyzer::error_handle(enum my_error_code ec)
             string_buf_=nullptr;
             break;
         case my_error_code::NONEXISTENT_ESCAPE_CHAR:
-            cout<<endl<<"Line "<<line_<<" Error: Nonexistent escape char \'\\"<<double_buf_[lexeme_ending_]<<"\'"<<endl;
+            cout<<endl<<"Line "<<line_<<" Error: Nonexistent escape char \'\\"<<get_current_char()<<"\'"<<endl;
             break;
         case my_error_code::CONST_INT_TOO_LONG:
             cout<<endl<<"Line "<<line_<<" Error: Const int length is too long (Max const int length is "<<MAX_LEN_OF_ID<<")"<<endl;
@@ -613,11 +1038,14 @@ void Lexical_analyzer::error_handle(enum my_error_code ec)
 */
 struct token * Lexical_analyzer::token_scan()
 {
+    const char * id_begining,* run_end;
     char ch;
     int length;
     int tag;
     enum digit_type dig_typ;
 
+repeat:
+
     //跳过此前的所有空白字符
     if(!skip_all_blanks())
     {
@@ -628,32 +1056,28 @@ struct token * Lexical_analyzer::token_scan()
         return nullptr;
     }
 
-repeat:
-
-    //获取本单词的第一个字符,如果此时这个字符是文件末尾的EOF的话就直接返回NULL
-    ch=double_buf_[lexeme_ending_];
-    next_pos(lexeme_ending_);
-    if(ch==EOF)
+    //获取本单词的第一个字符,如果此时已经到了源程序末尾的话就直接返回NULL
+    if(!read_char(ch))
     {
-        if(in_buf_begin(lexeme_ending_))
-        {
-            ch=double_buf_[lexeme_ending_];
-            next_pos(lexeme_ending_);
-        }
-        else
+        retract(1);
+        if(!br_stack_.empty())
         {
-            lexeme_ending_=lexeme_begining_;
-            if(!br_stack_.empty())
-            {
-                error_handle(my_error_code::UNCLOSED_LEFT_BRACKET);
-            }
-            return nullptr;
+            error_handle(my_error_code::UNCLOSED_LEFT_BRACKET);
         }
+        return nullptr;
     }
 
     //识别标识符和保留字
-    if(is_alpha(ch) || ch=='_')             //以字母和_开头的单词是合法的标识符
+    if(is_id_begin(ch))             //以字母和_开头的单词是合法的标识符
     {
+        //整个源程序都在内存中的时候可以一次扫描完整个标识符，并且直接在源程序上查找字符串表
+        if(input_mode_==lexical_input_mode::WHOLE_BUF)
+        {
+            lexeme_ending_ptr_=scan_id_run(lexeme_ending_ptr_,source_program_buf_+source_program_buf_size_);
+            id_begining=lexeme_begining_ptr_;
+            lexeme_begining_ptr_=lexeme_ending_ptr_;
+            return get_id_token(id_begining,lexeme_ending_ptr_-id_begining);
+        }
         length=1;
         do
         {
@@ -666,7 +1090,7 @@ repeat:
             }
             next_char(code_of_kind::ID,ch);
             length++;
-        }while(is_alpha(ch) || is_digit(ch,digit_type::DIGIT) || ch=='_');        //合法的标识符只能包含字母,数字和_
+        }while(is_id_char(ch));        //合法的标识符只能包含字母,数字和_
         retract(1);
         append_to_string_buf();
         return get_token(code_of_kind::ID);
@@ -688,6 +1112,13 @@ repeat:
             dig_typ=digit_type::DIGIT;
         }
         length=1;
+        //整个源程序都在内存中的时候可以一次扫描完十进制数中连续的数字
+        if(input_mode_==lexical_input_mode::WHOLE_BUF && dig_typ==digit_type::DIGIT)
+        {
+            run_end=scan_digit_run(lexeme_ending_ptr_,source_program_buf_+source_program_buf_size_);
+            length+=run_end-lexeme_ending_ptr_;
+            lexeme_ending_ptr_=run_end;
+        }
 again:
         do
         {
@@ -829,16 +1260,7 @@ again:
             return get_token(code_of_kind::L_PS);
             break;
         case ')':
-            if(br_stack_.empty())
-            {
-                br_stack_.push({code_of_kind::R_PS,line_});
-                error_handle(my_error_code::UNCLOSED_RIGHT_BRACKET);
-            }
-            else if(!right_br_pop(code_of_kind::R_PS))
-            {
-                br_stack_.push({code_of_kind::R_PS,line_});
-                error_handle(my_error_code::UNMATCHED_BRACKET);
-            }
+            right_br_check(code_of_kind::R_PS);
             return get_token(code_of_kind::R_PS);
             break;
         case ';':
@@ -1041,16 +1463,7 @@ again:
             return get_token(code_of_kind::L_BT);
             break;
         case ']':
-            if(br_stack_.empty())
-            {
-                br_stack_.push({code_of_kind::R_BT,line_});
-                error_handle(my_error_code::UNCLOSED_RIGHT_BRACKET);
-            }
-            else if(!right_br_pop(code_of_kind::R_BT))
-            {
-                br_stack_.push({code_of_kind::R_BT,line_});
-                error_handle(my_error_code::UNMATCHED_BRACKET);
-            }
+            right_br_check(code_of_kind::R_BT);
             return get_token(code_of_kind::R_BT);
             break;
         case '{':
@@ -1058,16 +1471,7 @@ again:
             return get_token(code_of_kind::L_BS);
             break;
         case '}':
-            if(br_stack_.empty())
-            {
-                br_stack_.push({code_of_kind::R_BS,line_});
-                error_handle(my_error_code::UNCLOSED_RIGHT_BRACKET);
-            }
-            else if(!right_br_pop(code_of_kind::R_BS))
-            {
-                br_stack_.push({code_of_kind::R_BS,line_});
-                error_handle(my_error_code::UNMATCHED_BRACKET);
-            }
+            right_br_check(code_of_kind::R_BS);
             return get_token(code_of_kind::R_BS);
             break;
         case ':':
@@ -1083,17 +1487,23 @@ again:
 /*
 词法分析出所有单词
 */
-list<struct token * > * Lexical_analyzer::tokens_scan()
+struct token_stream * Lexical_analyzer::tokens_scan()
 {
-    list<struct token * > * result=new list<struct token * >;
-    struct token * t=token_scan();
+    struct token_stream * result=token_stream_;
+    struct token * t;
+
+    //token序列大约每4个字符一个token，先预留好空间，避免词法分析的过程中反复分配内存
+    result->reserve(source_program_buf_size_/4);
+    t=token_scan();
 
     while(t)
     {
-        result->push_back(t);
+        result->push_back(*t,line_);
         t=token_scan();
     }
 
+    //token序列交给调用者管理
+    token_stream_=nullptr;
     return result;
 }
 
@@ -1104,39 +1514,40 @@ Parameters
 ----------
 filename:要输出的文件名
 */
-list<struct token * > * Lexical_analyzer::tokens_scan_then_output(const char * filename)
+struct token_stream * Lexical_analyzer::tokens_scan_then_output(const char * filename)
 {
     FILE * fp=fopen(filename,"w");
-    list<struct token * > * result=nullptr;
-    struct token * t;
+    struct token_stream * result=nullptr;
+    union attribute_value value;
     string tmp;
 
     if(fp!=nullptr)
     {
         result=tokens_scan();
 
-        for(auto i : (*result))
+        for(size_t i=0;i<result->size();i++)
         {
-            tmp="("+to_string((int)(i->code_of_kind))+",";
-            switch(i->code_of_kind)
+            value=result->values[i];
+            tmp="("+to_string((int)(result->kinds[i]))+",";
+            switch(result->kinds[i])
             {
                 case code_of_kind::ID:
-                    tmp+=((*(i->attribute_value.p_string_value))+")"+"\n");
+                    tmp+=((*(result->strings.get_string(value.string_id)))+")"+"\n");
                     break;
                 case code_of_kind::CONST_INT:
-                    tmp+=(to_string(i->attribute_value.int_value)+")"+"\n");
+                    tmp+=(to_string(value.int_value)+")"+"\n");
                     break;
                 case code_of_kind::CONST_FLOAT:
-                    tmp+=(to_string(i->attribute_value.float_value)+")"+"\n");
+                    tmp+=(to_string(value.float_value)+")"+"\n");
                     break;
                 case code_of_kind::CONST_CHAR:
-                    tmp+=(string("\'")+(i->attribute_value.char_value)+"\')"+"\n");
+                    tmp+=(string("\'")+(value.char_value)+"\')"+"\n");
                     break;
                 case code_of_kind::CONST_STRING:
-                    tmp+=("\""+(*(i->attribute_value.p_string_value))+"\")"+"\n");
+                    tmp+=("\""+(*(result->strings.get_string(value.string_id)))+"\")"+"\n");
                     break;
                 default:
-                    tmp+=(to_string((int)(i->attribute_value.int_value))+")"+"\n");
+                    tmp+=(to_string((int)(value.int_value))+")"+"\n");
                     break;
             }
             fwrite(tmp.c_str(),tmp.length(),1,fp);
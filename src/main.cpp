@@ -1,13 +1,26 @@
 #include<iostream>
 #include<stdio.h>
+#include<stdlib.h>
+#include<ctype.h>
+#include<errno.h>
+#include<chrono>
 #include<list>
 #include<string>
+#include<vector>
+#include<fstream>
+#include<algorithm>
+#include<map>
+#include<mutex>
+#include<dirent.h>
+#include<sys/stat.h>
 #include "symbol_table.h"
 #include "pre_processor.h"
 #include "lexical_analyzer.h"
 #include "syntax_directed_translator.h"
 #include "arm_asm_generator.h"
 #include "ic_optimizer.h"
+#include "thread_pool.h"
+#include "time_report.h"
 
 using namespace std;
 
@@ -19,72 +32,105 @@ using namespace std;
 #define INTERMEDIATE_CODES_OUTPUT_FILE_SUFFIX ".ic"               //语义翻译得到的中间代码输出的文件后缀
 #define FLOW_GRAPH_OUTPUT_FILE_SUFFIX ".fg"                     //中间代码优化之后获得的数据流图的文件后缀
 #define ASM_CODES_OUTPUT_FILE_SUFFIX ".s"                   //目标汇编代码输出的文件
+#define TIME_REPORT_OUTPUT_FILE_SUFFIX ".time.json"             //编译统计报告输出的文件后缀
+#define SOURCE_FILE_SUFFIX ".sy"                                //源程序文件后缀
 
 #define GRAMMER_FILE "./grammer/SysY.gra"                                      //书写语法的文件
 #define ACTION_GOTO_FILE "action_goto"                                  //保存语法分析表action和goto的文件
+#define PARSER_TABLE_TYPE parser_table_type::MINIMAL_LR1                //语法分析表的构造方式
+#define LEXICAL_INPUT_MODE lexical_input_mode::WHOLE_BUF                //词法分析器读取源程序的方式
 
 #define DEBUG_FLAG "-debug"
+#define TIME_REPORT_FLAG "-ftime-report"                                //输出编译各个阶段的耗时、内存峰值和计数统计
+#define BATCH_FLAG "--batch"                                            //批量编译一个目录(或者列表文件)中的所有源程序
+#define OUT_DIR_FLAG "--out-dir"                                        //批量编译时目标文件所在的目录
+#define THREAD_NUM_FLAG "-j"                                            //批量编译时同时编译的线程个数，编译单个源程序时按照函数并行生成汇编代码的线程个数(0表示和机器的线程个数相同)
+#define BENCHMARK_PARSER_TABLE_FLAG "-bench-parser-table"
+#define BENCHMARK_PARSER_TABLE_ROUNDS 100                               //比较语法分析表的速度时重复进行语法分析的次数
+#define BENCHMARK_PARSER_FLAG "-bench-parser"
+#define BENCHMARK_PARSER_ROUNDS 100                                     //测试语法分析的速度时重复进行语法分析的次数
+#define BENCHMARK_LEXICAL_ANALYZER_FLAG "-bench-lexer"
+#define BENCHMARK_LEXICAL_ANALYZER_ROUNDS 20                            //比较词法分析器读取方式的速度时重复进行词法分析的次数
 #define GENERATE_ASM_FLAG "-S"
 #define SPECIFY_TARGET_FLAG "-o"
 #define OPTIMIZATION_FLAG "-O1"
 
-bool lrc(string source_program_filename,string target_filename,bool debug=false)
+/*
+使用已经初始化好的语法制导翻译器编译一个源程序
+文法和语法分析表只在翻译器初始化的时候建立一次，其余各个阶段的对象都是每次编译单独建立的
+
+Parameters
+----------
+translator:已经初始化好的语法制导翻译器
+source_program_filename:源程序文件名
+target_filename:目标文件名(不带后缀)
+debug:是否输出各个阶段的中间结果
+backend_thread_num:按照函数并行生成汇编代码时的线程个数(为1表示不并行)
+
+Return
+------
+成功返回true，否则返回false
+*/
+bool compile(Syntax_directed_translator & translator,string source_program_filename,string target_filename,bool debug,size_t backend_thread_num=1)
 {
     bool res=false;
-    Symbol_table * symbol_table;
+    //符号表最先建立，最后销毁，其余各个阶段的对象都引用符号表中的表项
+    Symbol_table symbol_table;
     Pre_processor pre;
     Lexical_analyzer lex;
-    Syntax_directed_translator translator;
     Arm_asm_generator asm_generator;
     Ic_optimizer ic_optimizer;
-    list<struct token * > * tokens;
     list<struct quaternion> * intermediate_codes;
     struct ic_flow_graph * intermediate_codes_flow_graph;
-
-    //建立符号表
-    symbol_table=Symbol_table::get_instance();
+    struct token_stream * tokens;
 
     //添加语言内置的头文件
     pre.add_inner_header_files(1,SYSY_INNER_HEADER_FILE_NAME);
 
-    //先对源程序进行预处理
-    if(!pre.pre_process(source_program_filename.c_str(),(target_filename+PRE_PROCESS_OUTPUT_FILE_SUFFIX).c_str()))
+    //先对源程序进行预处理，预处理之后的源程序保存在内存中，只有调试模式才写到文件里
+    Time_report::begin_stage("pre process");
+    if(!pre.pre_process(source_program_filename.c_str(),debug?(target_filename+PRE_PROCESS_OUTPUT_FILE_SUFFIX).c_str():nullptr))
     {
         cout<<"Pre process error!\n"<<endl;
         goto out;
     }
+    Time_report::end_stage();
+    Time_report::add_counter("source bytes",pre.get_source_program_after_pre_process().size());
 
-    //建立词法分析器
-    if(!lex.init((target_filename+PRE_PROCESS_OUTPUT_FILE_SUFFIX).c_str()))
+    //建立词法分析器，直接读取内存中预处理之后的源程序
+    if(!lex.init_from_string(pre.get_source_program_after_pre_process(),LEXICAL_INPUT_MODE))
     {
         cout<<"Lexical analyzer init error!"<<endl;
         goto out;
     }
 
-    //进行词法分析
+    //输出符号表内容到文件
+    //symbol_table.outptu_symbols((target_filename+SYMBOL_TABLE_OUTPUT_FILE_SUFFIX).c_str());
+
+    //调试模式下需要输出所有的token，所以先进行词法分析，否则边词法分析边进行语义翻译，不需要保存所有的token
+    //统计各个阶段的耗时的时候也先进行词法分析，这样词法分析和语义翻译的耗时才能分开统计
     if(debug)
     {
-        tokens=lex.tokens_scan_then_output((target_filename+TOKENS_OUTPUT_FILE_SUFFIX).c_str());
+        translator.set_tokens(lex.tokens_scan_then_output((target_filename+TOKENS_OUTPUT_FILE_SUFFIX).c_str()));
     }
-    else
+    else if(Time_report::get_current())
     {
+        Time_report::begin_stage("lexical analysis");
         tokens=lex.tokens_scan();
+        Time_report::end_stage();
+        Time_report::add_counter("tokens",tokens->size());
+        translator.set_tokens(tokens);
     }
-
-    //输出符号表内容到文件
-    //symbol_table->outptu_symbols((target_filename+SYMBOL_TABLE_OUTPUT_FILE_SUFFIX).c_str());
-
-    //建立语法分析器
-    if(!translator.init(GRAMMER_FILE,ACTION_GOTO_FILE,tokens,false))
+    else
     {
-        cout<<"Syntax directed translator init error!"<<endl;
-        goto out;
+        translator.set_tokens(&lex);
     }
 
     //进行语义翻译,生成中间代码
+    Time_report::begin_stage("translate");
     if(debug)
     {
-        if(!(intermediate_codes=translator.translate_then_output((target_filename+INTERMEDIATE_CODES_OUTPUT_FILE_SUFFIX).c_str())))
+        if(!(intermediate_codes=translator.translate_then_output((target_filename+INTERMEDIATE_CODES_OUTPUT_FILE_SUFFIX).c_str(),&symbol_table)))
         {
             cout<<"Generate intermedia codes error!"<<endl;
             goto out;
@@ -92,17 +138,21 @@ bool lrc(string source_program_filename,string target_filename,bool debug=false)
     }
     else
     {
-        if(!(intermediate_codes=translator.translate()))
+        if(!(intermediate_codes=translator.translate(&symbol_table)))
         {
             cout<<"Generate intermedia codes error!"<<endl;
             goto out;
         }
     }
 
+    Time_report::end_stage();
+    Time_report::add_counter("quaternions",intermediate_codes->size());
+
     //初始化中间代码优化器
     ic_optimizer.init();
 
     //中间代码优化
+    Time_report::begin_stage("ic optimize");
     if(debug)
     {
         intermediate_codes_flow_graph=ic_optimizer.optimize_then_output(intermediate_codes,(target_filename+FLOW_GRAPH_OUTPUT_FILE_SUFFIX).c_str());
@@ -112,35 +162,508 @@ bool lrc(string source_program_filename,string target_filename,bool debug=false)
         intermediate_codes_flow_graph=ic_optimizer.optimize(intermediate_codes);
     }
 
+    Time_report::end_stage();
+
     //初始化汇编生成器
-    if(!(asm_generator.init()))
+    Time_report::begin_stage("asm generate");
+    if(!(asm_generator.init(&symbol_table)))
     {
         cout<<"Asm generator init error!"<<endl;
         goto out;
     }
 
     //输出最终的汇编文件
-    asm_generator.generate_asm_then_output(intermediate_codes_flow_graph,(target_filename+ASM_CODES_OUTPUT_FILE_SUFFIX).c_str());
+    res=asm_generator.generate_asm_in_parallel_then_output(intermediate_codes_flow_graph,(target_filename+ASM_CODES_OUTPUT_FILE_SUFFIX).c_str(),backend_thread_num);
+    Time_report::end_stage();
     delete intermediate_codes_flow_graph;
+
+out:
+    //翻译器不能再引用本次编译的词法分析器和tokens，符号表等对象在函数返回时自动销毁
+    translator.set_tokens((struct token_stream *)nullptr);
+    return res;
+}
+
+/*
+编译一个源程序
+
+Parameters
+----------
+source_program_filename:源程序文件名
+target_filename:目标文件名(不带后缀)
+debug:是否输出各个阶段的中间结果
+backend_thread_num:按照函数并行生成汇编代码时的线程个数(为1表示不并行)
+time_report:是否统计并输出各个阶段的耗时、内存峰值和计数
+
+Return
+------
+成功返回true，否则返回false
+*/
+bool lrc(string source_program_filename,string target_filename,bool debug=false,size_t backend_thread_num=1,bool time_report=false)
+{
+    Syntax_directed_translator translator;
+    Time_report report;
+    bool res=false;
+
+    if(time_report)
+    {
+        Time_report::install(&report);
+    }
+
+    //建立语法制导翻译器(文法和语法分析表)
+    Time_report::begin_stage("translator init");
+    if(!translator.init(GRAMMER_FILE,ACTION_GOTO_FILE,(struct token_stream *)nullptr,false,PARSER_TABLE_TYPE))
+    {
+        cout<<"Syntax directed translator init error!"<<endl;
+    }
+    else
+    {
+        Time_report::end_stage();
+        res=compile(translator,source_program_filename,target_filename,debug,backend_thread_num);
+    }
+
+    //编译出错的时候也输出已经完成的阶段的统计
+    if(time_report)
+    {
+        Time_report::install(nullptr);
+        report.finish();
+        report.output_table(cout);
+        report.output_json((target_filename+TIME_REPORT_OUTPUT_FILE_SUFFIX).c_str(),source_program_filename);
+    }
+
+    return res;
+}
+
+/*
+递归地获取目录下所有的源程序文件
+
+Parameters
+----------
+dir_name:目录名
+relative_dir_name:该目录相对于最开始的目录的路径
+files:获取到的源程序文件(源程序文件名,相对于最开始的目录的不带后缀的文件名)
+*/
+void get_source_files_in_dir(string dir_name,string relative_dir_name,vector<pair<string,string> > & files)
+{
+    DIR * dir;
+    struct dirent * entry;
+    struct stat file_stat;
+    string file_name,suffix=SOURCE_FILE_SUFFIX;
+
+    if(!(dir=opendir(dir_name.c_str())))
+    {
+        return;
+    }
+    while((entry=readdir(dir)))
+    {
+        file_name=entry->d_name;
+        if(file_name=="." || file_name=="..")
+        {
+            continue;
+        }
+        if(stat((dir_name+"/"+file_name).c_str(),&file_stat)!=0)
+        {
+            continue;
+        }
+        if(S_ISDIR(file_stat.st_mode))
+        {
+            get_source_files_in_dir(dir_name+"/"+file_name,relative_dir_name+file_name+"/",files);
+        }
+        else if(file_name.size()>suffix.size() && file_name.compare(file_name.size()-suffix.size(),suffix.size(),suffix)==0)
+        {
+            files.push_back(make_pair(dir_name+"/"+file_name,relative_dir_name+file_name.substr(0,file_name.size()-suffix.size())));
+        }
+    }
+    closedir(dir);
+}
+
+/*
+创建目录(包括不存在的上级目录)
+
+Parameters
+----------
+dir_name:要创建的目录名
+
+Return
+------
+目录已经存在或者创建成功返回true，否则返回false
+*/
+bool make_dirs(string dir_name)
+{
+    size_t pos=0;
+    struct stat file_stat;
+
+    while((pos=dir_name.find('/',pos+1))!=string::npos)
+    {
+        mkdir(dir_name.substr(0,pos).c_str(),0755);
+    }
+    mkdir(dir_name.c_str(),0755);
+    return stat(dir_name.c_str(),&file_stat)==0 && S_ISDIR(file_stat.st_mode);
+}
+
+//批量编译时的一个源程序的编译任务
+struct batch_compile_task
+{
+    batch_compile_task(string source_program_filename,string target_filename):source_program_filename(source_program_filename),target_filename(target_filename),is_success(false),is_done(false),seconds(0)
+    {
+
+    };
+
+    string source_program_filename;         //源程序文件名
+    string target_filename;                 //相对于目标文件目录的不带后缀的目标文件名
+    bool is_success;                        //是否编译成功
+    bool is_done;                           //是否已经编译完成
+    double seconds;                         //编译耗时
+    string output;                          //编译过程中输出的诊断信息
+};
+
+//批量编译时所有编译任务共享的信息
+struct batch_compile_info
+{
+    const Syntax_directed_translator * prototype;       //共享文法和语法分析表的翻译器
+    string out_dir;                                     //目标文件所在的目录
+    vector<struct batch_compile_task> tasks;            //所有的编译任务
+    size_t next_output_task;                            //下一个要输出结果的编译任务
+    size_t error_num;                                   //编译出错的源程序个数
+    mutex output_mutex;                                 //输出编译结果时的互斥锁
+};
+
+/*
+执行一个批量编译任务
+每一个任务使用自己的翻译器(和原型共享文法和语法分析表)、符号表、中间代码和汇编代码生成器
+编译过程中的诊断信息先保存下来，然后严格按照源程序的顺序和编译结果一起输出，所以输出和线程个数无关
+
+Parameters
+----------
+index:编译任务的编号
+data:所有编译任务共享的信息(struct batch_compile_info *)
+*/
+void batch_compile(size_t index,void * data)
+{
+    struct batch_compile_info * info=(struct batch_compile_info *)data;
+    struct batch_compile_task * task=&info->tasks[index];
+    Syntax_directed_translator translator;
+    size_t base_pos=task->target_filename.find_last_of('/');
+    chrono::steady_clock::time_point start=chrono::steady_clock::now();
+
+    Thread_output_buf::redirect(&task->output);
+    task->is_success=translator.init(*info->prototype) && 
+    make_dirs(base_pos==string::npos?info->out_dir:info->out_dir+"/"+task->target_filename.substr(0,base_pos)) && 
+    compile(translator,task->source_program_filename,info->out_dir+"/"+task->target_filename,false);
+    task->seconds=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+    Thread_output_buf::redirect(nullptr);
+
+    //把已经编译完成的任务按照顺序输出
+    lock_guard<mutex> lock(info->output_mutex);
+    task->is_done=true;
+    while(info->next_output_task<info->tasks.size() && info->tasks[info->next_output_task].is_done)
+    {
+        task=&info->tasks[info->next_output_task++];
+        if(!task->is_success)
+        {
+            info->error_num++;
+        }
+        cout<<task->output<<task->source_program_filename<<"\t\t\t\t\t\t"<<(task->is_success?"success!":"error!")<<"\t"<<task->seconds*1000<<" ms"<<endl;
+    }
+}
+
+/*
+批量编译源程序，文法和语法分析表只建立一次
+如果sources是目录，那么编译该目录下(包括子目录)的所有源程序，目标文件按照相同的相对路径放在out_dir中
+否则sources是一个每行一个源程序文件名的列表文件，目标文件直接放在out_dir中(不同目录下的同名源程序会被拒绝)
+
+Parameters
+----------
+sources:源程序所在的目录或者源程序列表文件
+out_dir:目标文件所在的目录
+thread_num:同时编译的线程个数
+
+Return
+------
+所有源程序都编译成功返回true，否则返回false
+*/
+bool lrc_batch(string sources,string out_dir,size_t thread_num=1)
+{
+    Syntax_directed_translator translator;
+    struct batch_compile_info info;
+    vector<pair<string,string> > files;
+    map<string,string> target_files;
+    pair<map<string,string>::iterator,bool> target_file;
+    struct stat file_stat;
+    ifstream list_file;
+    string line,file_name;
+    size_t base_pos;
+    streambuf * cout_buf;
+    chrono::steady_clock::time_point batch_start=chrono::steady_clock::now();
+    double init_seconds,seconds;
+
+    //获取所有要编译的源程序
+    if(stat(sources.c_str(),&file_stat)!=0)
+    {
+        cout<<"Can't find "<<sources<<"!"<<endl;
+        return false;
+    }
+    if(S_ISDIR(file_stat.st_mode))
+    {
+        while(sources.size()>1 && sources.back()=='/')
+        {
+            sources.pop_back();
+        }
+        get_source_files_in_dir(sources,"",files);
+        sort(files.begin(),files.end());
+    }
+    else
+    {
+        list_file.open(sources,ios::in);
+        while(getline(list_file,line))
+        {
+            if(line.empty())
+            {
+                continue;
+            }
+            base_pos=line.find_last_of('/');
+            file_name=line.substr(base_pos==string::npos?0:base_pos+1);
+            files.push_back(make_pair(line,file_name.substr(0,file_name.find_last_of('.'))));
+        }
+        list_file.close();
+    }
+
+    //不同的源程序不能输出到同一个目标文件，否则后编译的会覆盖先编译的(并行编译的时候还会同时写同一个文件)
+    for(auto & file:files)
+    {
+        target_file=target_files.insert(make_pair(file.second,file.first));
+        if(!target_file.second)
+        {
+            cout<<"Error: "<<target_file.first->second<<" and "<<file.first<<" have the same target file "<<out_dir<<"/"<<file.second<<"!"<<endl;
+            return false;
+        }
+    }
+
+    //建立语法制导翻译器，所有源程序共用同一份文法和语法分析表
+    if(!translator.init(GRAMMER_FILE,ACTION_GOTO_FILE,(struct token_stream *)nullptr,false,PARSER_TABLE_TYPE))
+    {
+        cout<<"Syntax directed translator init error!"<<endl;
+        return false;
+    }
+    init_seconds=chrono::duration<double>(chrono::steady_clock::now()-batch_start).count();
+
+    //编译所有的源程序，每一个线程的输出都先写到各自任务的诊断信息中
+    info.prototype=&translator;
+    info.out_dir=out_dir;
+    info.next_output_task=0;
+    info.error_num=0;
+    for(auto & file:files)
+    {
+        info.tasks.push_back(batch_compile_task(file.first,file.second));
+    }
+    Thread_output_buf output_buf(cout.rdbuf());
+    cout_buf=cout.rdbuf(&output_buf);
+    parallel_for(info.tasks.size(),thread_num,batch_compile,&info);
+    cout.rdbuf(cout_buf);
+
+    seconds=chrono::duration<double>(chrono::steady_clock::now()-batch_start).count();
+    cout<<files.size()<<" files, "<<info.error_num<<" error, threads: "<<thread_num<<", init: "<<init_seconds*1000<<" ms, total: "<<seconds*1000<<" ms"<<endl;
+
+    return info.error_num==0;
+}
+
+/*
+比较使用压缩前后的语法分析表对源程序进行语法分析的速度
+
+Parameters
+----------
+source_program_filename:源程序文件名
+
+Return
+------
+成功返回true，否则返回false
+*/
+bool benchmark_parser_table(string source_program_filename)
+{
+    bool res=false;
+    Pre_processor pre;
+    Lexical_analyzer lex;
+    LR1_parser parser;
+    struct token_stream * tokens;
+
+    pre.add_inner_header_files(1,SYSY_INNER_HEADER_FILE_NAME);
+    if(!pre.pre_process(source_program_filename.c_str(),nullptr))
+    {
+        cout<<"Pre process error!\n"<<endl;
+        goto out;
+    }
+    if(!lex.init_from_string(pre.get_source_program_after_pre_process()))
+    {
+        cout<<"Lexical analyzer init error!"<<endl;
+        goto out;
+    }
+    tokens=lex.tokens_scan();
+
+    //不使用保存下来的语法分析表，这样才能同时得到压缩前后的两种表
+    if(!parser.init(GRAMMER_FILE,nullptr,tokens,false,PARSER_TABLE_TYPE))
+    {
+        cout<<"Parser init error!"<<endl;
+        goto out;
+    }
+    parser.benchmark_parser_table(BENCHMARK_PARSER_TABLE_ROUNDS);
+    res=true;
+
+out:
+    return res;
+}
+
+/*
+测试语法分析的速度
+
+Parameters
+----------
+source_program_filename:源程序文件名
+
+Return
+------
+成功返回true，否则返回false
+*/
+bool benchmark_parser(string source_program_filename)
+{
+    bool res=false;
+    Pre_processor pre;
+    Lexical_analyzer lex;
+    LR1_parser parser;
+    struct token_stream * tokens;
+
+    pre.add_inner_header_files(1,SYSY_INNER_HEADER_FILE_NAME);
+    if(!pre.pre_process(source_program_filename.c_str(),nullptr))
+    {
+        cout<<"Pre process error!\n"<<endl;
+        goto out;
+    }
+    if(!lex.init_from_string(pre.get_source_program_after_pre_process()))
+    {
+        cout<<"Lexical analyzer init error!"<<endl;
+        goto out;
+    }
+    tokens=lex.tokens_scan();
+
+    if(!parser.init(GRAMMER_FILE,ACTION_GOTO_FILE,tokens,false,PARSER_TABLE_TYPE))
+    {
+        cout<<"Parser init error!"<<endl;
+        goto out;
+    }
+    parser.benchmark_parse(BENCHMARK_PARSER_ROUNDS);
+    res=true;
+
+out:
+    return res;
+}
+
+/*
+比较词法分析器的两种读取源程序的方式的速度
+
+Parameters
+----------
+source_program_filename:源程序文件名
+
+Return
+------
+成功返回true，否则返回false
+*/
+bool benchmark_lexical_analyzer(string source_program_filename)
+{
+    bool res=false;
+    Pre_processor pre;
+    const string * source_program;
+    struct token_stream * tokens;
+    size_t token_num=0;
+    chrono::steady_clock::time_point start;
+    double seconds;
+    enum lexical_input_mode input_modes[]={lexical_input_mode::DOUBLE_BUF,lexical_input_mode::WHOLE_BUF};
+
+    pre.add_inner_header_files(1,SYSY_INNER_HEADER_FILE_NAME);
+    if(!pre.pre_process(source_program_filename.c_str(),nullptr))
+    {
+        cout<<"Pre process error!\n"<<endl;
+        goto out;
+    }
+
+    source_program=&pre.get_source_program_after_pre_process();
+    cout<<"source: "<<source_program->size()<<" bytes, rounds: "<<BENCHMARK_LEXICAL_ANALYZER_ROUNDS<<endl;
+    for(auto input_mode:input_modes)
+    {
+        start=chrono::steady_clock::now();
+        for(int i=0;i<BENCHMARK_LEXICAL_ANALYZER_ROUNDS;i++)
+        {
+            Lexical_analyzer lex;
+            if(!lex.init_from_string(*source_program,input_mode))
+            {
+                cout<<"Lexical analyzer init error!"<<endl;
+                goto out;
+            }
+            tokens=lex.tokens_scan();
+            token_num=tokens->size();
+            delete tokens;
+        }
+        seconds=chrono::duration<double>(chrono::steady_clock::now()-start).count();
+        cout<<((input_mode==lexical_input_mode::WHOLE_BUF)?"whole buffer":"double buffer")<<": "<<token_num<<" tokens, "<<(double)source_program->size()*BENCHMARK_LEXICAL_ANALYZER_ROUNDS/seconds/(1<<20)<<" MB/s"<<endl;
+    }
     res=true;
 
 out:
-    //释放内存并退出
-    Symbol_table::delete_instance();
-    
     return res;
 }
 
+/*
+解析命令行中的线程个数，只接受十进制的非负整数(不能有正负号、空白符或者其他字符)
+
+Parameters
+----------
+str:命令行中的线程个数
+thread_num:返回线程个数，0会被换成机器的线程个数
+
+Return
+------
+线程个数合法返回true，否则返回false
+*/
+bool parse_thread_num(const char * str,size_t & thread_num)
+{
+    char * end;
+    unsigned long value;
+
+    if(!isdigit((unsigned char)str[0]))
+    {
+        return false;
+    }
+    errno=0;
+    value=strtoul(str,&end,10);
+    if(*end!='\0' || errno==ERANGE)
+    {
+        return false;
+    }
+    thread_num=value?value:get_hardware_thread_num();
+    return true;
+}
+
 int main(int argc,char * argv[])
 {
     string source_program_filename;
     string target_filename;
     string debug_info;
     bool debug;
+    size_t thread_num;
 
     switch(argc)
     {
         case 3:
+            if(string(argv[1])==BENCHMARK_PARSER_TABLE_FLAG)
+            {
+                return benchmark_parser_table(argv[2])?0:-1;
+            }
+            if(string(argv[1])==BENCHMARK_PARSER_FLAG)
+            {
+                return benchmark_parser(argv[2])?0:-1;
+            }
+            if(string(argv[1])==BENCHMARK_LEXICAL_ANALYZER_FLAG)
+            {
+                return benchmark_lexical_analyzer(argv[2])?0:-1;
+            }
             source_program_filename=argv[1];
             target_filename=argv[2];
             debug=false;
@@ -153,12 +676,45 @@ int main(int argc,char * argv[])
             {
                 debug=true;
             }
+            else if(debug_info==TIME_REPORT_FLAG)
+            {
+                return lrc(source_program_filename,target_filename,false,1,true)?0:-1;
+            }
             else
             {
                 cout<<"No such command!"<<endl;
                 return -1;
             }
             break;
+        case 5:
+            if(string(argv[1])==BATCH_FLAG && string(argv[3])==OUT_DIR_FLAG)
+            {
+                return lrc_batch(argv[2],argv[4])?0:-1;
+            }
+            //编译单个源程序的时候，-j表示按照函数并行生成汇编代码的线程个数
+            if(string(argv[1])==THREAD_NUM_FLAG && parse_thread_num(argv[2],thread_num))
+            {
+                return lrc(argv[3],argv[4],false,thread_num)?0:-1;
+            }
+            cout<<"No such command!"<<endl;
+            return -1;
+            break;
+        case 6:
+            if(string(argv[1])==TIME_REPORT_FLAG && string(argv[2])==THREAD_NUM_FLAG && parse_thread_num(argv[3],thread_num))
+            {
+                return lrc(argv[4],argv[5],false,thread_num,true)?0:-1;
+            }
+            cout<<"No such command!"<<endl;
+            return -1;
+            break;
+        case 7:
+            if(string(argv[1])==BATCH_FLAG && string(argv[3])==OUT_DIR_FLAG && string(argv[5])==THREAD_NUM_FLAG && parse_thread_num(argv[6],thread_num))
+            {
+                return lrc_batch(argv[2],argv[4],thread_num)?0:-1;
+            }
+            cout<<"No such command!"<<endl;
+            return -1;
+            break;
         default:
             cout<<"No such command!"<<endl;
             return -1;
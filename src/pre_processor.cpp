@@ -7,10 +7,15 @@
  *
 */
 #include "pre_processor.h"
+#include "time_report.h"
 
 #include<algorithm>
 #include<sstream>
 #include<stdarg.h>
+#include<stdio.h>
+#include<string.h>
+#include<time.h>
+#include<sys/stat.h>
 
 //字符是否是字母
 #define is_letter(ch) ((ch>='A' && ch<='Z') || (ch>='a' && ch<='z'))
@@ -31,7 +36,7 @@
 #define is_line_feed(ch) (ch=='\n')
 
 //字符是否是空白符
-#define is_whitespace(ch) (ch==' ')
+#define is_whitespace(ch) (ch==' ' || ch=='\t' || ch=='\r')
 
 //字符是否是井号
 #define is_well_number(ch) (ch=='#')
@@ -48,908 +53,1970 @@
 //字符是否是反斜杠
 #define is_backslash(ch) (ch=='\\')
 
-/*
-Pre_processor的构造函数
-*/
-Pre_processor::Pre_processor():double_quotation_mark_(false),single_quotation_mark_(false)
-{
-    inner_macro_vars_["__FILE__"]="";
-    inner_macro_vars_["__LINE__"]="";
-    inner_macro_vars_["__DATE__"]="";
-    inner_macro_vars_["__TIME__"]="";
-    inner_macro_vars_["__STDC__"]="";
-}
+//字符是否可以出现在标识符中
+#define is_identifier_char(ch) (is_letter(ch) || is_digit(ch) || is_underline(ch))
+
+//FNV-1a哈希的初始值和乘数
+#define FNV1A_64_OFFSET_BASIS 0xcbf29ce484222325ULL
+#define FNV1A_64_PRIME 0x100000001b3ULL
+
+//宏表的槽的最小个数
+#define MACRO_TABLE_MIN_SLOT_NUM 64
+
+//可变参数在宏函数的内容中的名字
+#define MACRO_VA_ARGS "__VA_ARGS__"
+
+//收集宏函数调用的实参的时候预先分配的记号个数(避免逐个增加记号的时候多次重新分配内存)
+#define MACRO_CALL_TOKEN_RESERVE_NUM 32
+
+//由多个字符组成的标点符号(长的在前面，按照最长匹配识别)
+static const char * const multi_char_punctuators[]={"<<=",">>=","...","++","--","->","<<",">>","<=",">=","==","!=","&&","||","+=","-=","*=","/=","%=","&=","|=","^=","##"};
 
 /*
-Pre_processor的析构函数
+识别一个预处理记号
+
+Parameters
+----------
+str:要识别的文本
+size:文本的长度
+pos:记号的开始位置(不是空白符)
+kind:识别出来的记号的种类
+
+Return
+------
+记号之后的位置
 */
-Pre_processor::~Pre_processor()
+static size_t scan_pp_token(const char * str,size_t size,size_t pos,enum pp_token_kind & kind)
 {
-    
+    char ch=str[pos];
+    size_t len;
+
+    if(is_letter(ch) || is_underline(ch))
+    {
+        kind=pp_token_kind::IDENTIFIER;
+        while(++pos<size && is_identifier_char(str[pos]));
+        return pos;
+    }
+    if(is_digit(ch) || (ch=='.' && pos+1<size && is_digit(str[pos+1])))
+    {
+        //数字(包括十六进制数和浮点数的指数部分)
+        kind=pp_token_kind::NUMBER;
+        while(++pos<size && (is_identifier_char(str[pos]) || str[pos]=='.' || 
+        ((str[pos]=='+' || str[pos]=='-') && (str[pos-1]=='e' || str[pos-1]=='E' || str[pos-1]=='p' || str[pos-1]=='P'))));
+        return pos;
+    }
+    if(is_double_quotation(ch) || is_single_quotation(ch))
+    {
+        //字符串和字符常量(没有结束的时候到行尾为止)
+        kind=pp_token_kind::LITERAL;
+        while(++pos<size && str[pos]!=ch && !is_line_feed(str[pos]))
+        {
+            if(is_backslash(str[pos]) && pos+1<size)
+            {
+                pos++;
+            }
+        }
+        return pos<size && str[pos]==ch?pos+1:pos;
+    }
+    kind=pp_token_kind::PUNCTUATOR;
+    for(auto i:multi_char_punctuators)
+    {
+        len=strlen(i);
+        if(pos+len<=size && strncmp(str+pos,i,len)==0)
+        {
+            return pos+len;
+        }
+    }
+    return pos+1;
 }
 
 /*
-增加一个宏变量
+判断一个记号是否是指定的标点符号
 
 Parameters
 ----------
-macro_source:待替换的宏
-macro_destination:被替换的宏
+token:要判断的记号
+punctuator:标点符号
 
 Return
 ------
-如果增加成功，返回true，否则返回false
+是返回true，否则返回false
 */
-bool Pre_processor::add_macro_var(string macro_source,string macro_destination)
+static inline bool is_punctuator_token(const struct pp_token & token,const char * punctuator)
 {
-    if(macro_vars_.find(macro_source)!=macro_vars_.end() || macro_funcs_.find(macro_source)!=macro_funcs_.end() || inner_macro_vars_.find(macro_source)!=inner_macro_vars_.end())
-    {
-        return false;
-    }
-    macro_vars_[macro_source]=macro_destination;
-    return true;
+    return token.kind==pp_token_kind::PUNCTUATOR && strncmp(token.str,punctuator,token.len)==0 && punctuator[token.len]=='\0';
 }
 
 /*
-增加一个宏函数
+判断两个相邻的字符是否可能被连在一起当作一个记号
 
 Parameters
 ----------
-macro_source:待替换的宏
-macro_func_f_params:宏函数的形参
-macro_destination:被替换的宏
+left:左边的字符
+right:右边的字符
 
 Return
 ------
-如果增加成功，返回true，否则返回false
+可能返回true，否则返回false
 */
-bool Pre_processor::add_macro_func(string macro_source,list<string> macro_func_f_params,string macro_destination)
+static inline bool may_paste(char left,char right)
 {
-    size_t automata_state=0;
-    string identifier;
-    list<size_t> f_params_in_content;
-    list<string> content;
-    if(macro_vars_.find(macro_source)!=macro_vars_.end() || macro_funcs_.find(macro_source)!=macro_funcs_.end() || inner_macro_vars_.find(macro_source)!=inner_macro_vars_.end())
+    if(is_identifier_char(left))
     {
-        return false;
+        return is_identifier_char(right) || right=='.';
     }
-    if(macro_func_f_params.size()>0)
+    switch(left)
     {
-        cout<<"Warning: Unable to process macro functions "<<macro_source<<" with "<<macro_func_f_params.size()<<" parameters at this time!"<<endl;
-        return false;
+        case '.':
+            if(is_digit(right))
+            {
+                return true;
+            }
+        case '+': case '-': case '*': case '/': case '%': case '<': case '>': 
+        case '=': case '!': case '&': case '|': case '^': case '#':
+            switch(right)
+            {
+                case '.': case '+': case '-': case '*': case '/': case '%': case '<': case '>': 
+                case '=': case '!': case '&': case '|': case '^': case '#':
+                    return true;
+                default:
+                    return false;
+            }
+        default:
+            return false;
     }
-    content.push_back(macro_destination);
-    macro_funcs_.insert(make_pair(macro_source,macro_func(macro_source,0,f_params_in_content,content)));
-    return true;
 }
 
+
 /*
-进行没有参数的宏函数的宏替换
+Macro_table的构造函数
 */
-void Pre_processor::no_f_params_macro_func_replace(string macro_source)
+Macro_table::Macro_table():filter_(0),version_(0)
 {
-    string macro_destination;
-    
-    if(macro_funcs_.find(macro_source)!=macro_funcs_.end())
+
+}
+
+/*
+Macro_table的析构函数
+*/
+Macro_table::~Macro_table()
+{
+    for(auto i:macros_)
     {
-        macro_destination=macro_funcs_.at(macro_source).content.front();
-        macro_bufs_.push(make_pair(0,macro_destination));
+        delete i;
     }
 }
 
 /*
-进行宏变量的宏替换
+计算宏名的哈希值(FNV-1a)
+
+Parameters
+----------
+name:宏名
+len:宏名的长度
+
+Return
+------
+宏名的哈希值
 */
-void Pre_processor::macro_var_replace(string macro_source)
+uint64_t Macro_table::hash(const char * name,size_t len)
 {
-    string macro_destination;
+    uint64_t res=FNV1A_64_OFFSET_BASIS;
 
-    if(macro_vars_.find(macro_source)!=macro_vars_.end())
+    for(size_t i=0;i<len;i++)
     {
-        macro_destination=macro_vars_.at(macro_source);
-        macro_bufs_.push(make_pair(0,macro_destination));
+        res=(res^(unsigned char)name[i])*FNV1A_64_PRIME;
     }
+    return res;
 }
 
 /*
-进行内置宏变量的宏替换
+把一个宏放到哈希表的槽中(使用线性探测)
+
+Parameters
+----------
+m:要放入的宏
 */
-void Pre_processor::inner_macro_var_replace(string macro_source)
+void Macro_table::insert_slot(struct macro * m)
 {
-    //string macro_destination;
-    //stringstream ss;
+    size_t mask=slots_.size()-1,index=(m->hash>>6)&mask;
 
-    if(macro_source=="__LINE__")
+    while(slots_[index])
     {
-        //ss << current_line_;
-        //ss >> macro_destination;
-        macro_bufs_.push(make_pair(0,to_string(current_line_)));
+        index=(index+1)&mask;
     }
+    slots_[index]=m;
 }
 
 /*
-添加内置的头文件
+查找一个宏
 
 Parameters
 ----------
-file_num:要添加的头文件的数量
-filename:要添加的内置头文件的文件名
+name:宏名(不需要以'\0'结尾)
+len:宏名的长度
+hash:宏名的哈希值
 
 Return
 ------
-如果添加成功返回true，否则返回false
+找到的宏，找不到返回nullptr
 */
-bool Pre_processor::add_inner_header_files(size_t file_num,...)
+struct macro * Macro_table::find(const char * name,size_t len,uint64_t hash) const
 {
-    //创建一个文件输入流对象
-	ifstream inFile;
-    string line;
-    const char * filename;
-    bool res=true;
-    va_list argptr;
-	va_start(argptr,file_num);
-	for(size_t i=0;i<file_num;i++)
-	{
-		filename=va_arg(argptr,const char *);
-        //打开文件
-        inFile.open(filename);
-        if(!inFile)
-        {
-            cout<<"Open file "<<filename<<" error!"<<endl;
-            return false;
-        }
+    size_t mask,index;
 
-        //预处理，这里主要是为了处理头文件中的#define语句
-        if(!pre_process(filename,nullptr))
+    if(slots_.empty())
+    {
+        return nullptr;
+    }
+    mask=slots_.size()-1;
+    index=(hash>>6)&mask;
+    while(slots_[index])
+    {
+        if(slots_[index]->hash==hash && slots_[index]->name.size()==len && slots_[index]->name.compare(0,len,name,len)==0)
         {
-            cout<<"Inner header file "<<filename<<" format error!"<<endl;
-            res=false;
+            return slots_[index];
         }
-
-        //关闭文件
-        inFile.close();
-	}
-    va_end(argptr);
-    return res;
+        index=(index+1)&mask;
+    }
+    return nullptr;
 }
 
 /*
-获取源程序的下一个字符
+增加一个宏
+哈希表的装载因子超过1/2的时候把槽的个数扩大一倍
+
+Parameters
+----------
+name:宏名
+kind:宏的种类
+f_param_num:形参个数
+content:宏的内容
+
+Return
+------
+增加的宏，已经存在同名的宏的时候返回nullptr
 */
-char Pre_processor::read_char()
+struct macro * Macro_table::add(string name,enum macro_kind kind,size_t f_param_num,string content)
 {
-    static size_t read_buf_pos=0;
+    uint64_t name_hash=hash(name.c_str(),name.size());
+    struct macro * res;
 
-    while(!macro_bufs_.empty())
+    if(find(name.c_str(),name.size(),name_hash))
     {
-        if(macro_bufs_.top().first>=macro_bufs_.top().second.size())
-        {
-            macro_bufs_.pop();
-        }
-        else
-        {
-            return macro_bufs_.top().second[macro_bufs_.top().first++];
-        }
+        return nullptr;
     }
-
-    if(read_buf_pos>=read_buf_.size())
+    res=new struct macro(name,name_hash,kind,f_param_num,content);
+    macros_.push_back(res);
+    if(macros_.size()*2>slots_.size())
     {
-        read_buf_pos=0;
-        if(getline(source_program_,read_buf_))
+        slots_.assign(max(slots_.size()*2,(size_t)MACRO_TABLE_MIN_SLOT_NUM),nullptr);
+        for(auto i:macros_)
         {
-            read_buf_.push_back('\n');
-        }
-        else
-        {
-            read_buf_.clear();
-            return EOF;
+            insert_slot(i);
         }
     }
-    return read_buf_[read_buf_pos++];
+    else
+    {
+        insert_slot(res);
+    }
+    filter_|=(1ULL<<(name_hash&63));
+    version_++;
+    return res;
 }
 
 /*
-尝试进行#define语句的识别的自动机
-能识别正常的宏变量定义
-只能识别没有参数的宏函数定义
+把一个已经存在的宏重新定义
+宏对象本身不变，这样别的宏记忆的展开结果中引用的宏仍然有效；宏表的版本加1，所有记忆的展开结果都会失效
 
-Return
-------
-是否成功进行了#define的识别
+Parameters
+----------
+m:要重新定义的宏
+definition:新的定义(已经分好了记号)
 */
-bool Pre_processor::macro_define_distinguish_automata(char ch)
+void Macro_table::redefine(struct macro * m,const struct macro & definition)
 {
-    bool res=false;
-    static size_t automata_state=1,macro_define_string_pointer=0;
-    static string macro_define_string="define",macro_source,macro_destination,macro_func_f_param;
-    static list<string> macro_func_f_params;
-    switch(automata_state)
+    m->kind=definition.kind;
+    m->f_param_num=definition.f_param_num;
+    m->is_variadic=definition.is_variadic;
+    m->content=definition.content;
+    //记号直接指向宏的内容，复制之后要指向新的内容中相同的位置
+    m->tokens=definition.tokens;
+    for(auto & i:m->tokens)
     {
-        case 0:
-            if(is_line_feed(ch))
-            {
-                automata_state=1;
-            }
-            break;
-        case 1:
-            if(is_whitespace(ch) || is_line_feed(ch))
-            {
-                ;
-            }
-            else if(ch=='#')
-            {
-                automata_state=2;
-            }
-            else
-            {
-                automata_state=0;
-            }
-            break;
-        case 2:
-            if(is_whitespace(ch))
-            {
-                ;
-            }
-            else if(macro_define_string[macro_define_string_pointer++]==ch)
-            {
-                if(macro_define_string_pointer>=macro_define_string.size())
-                {
-                    macro_define_string_pointer=0;
-                    automata_state=3;
-                }
-            }
-            else
-            {
-                macro_define_string_pointer=0;
-                automata_state=is_line_feed(ch)?1:0;
-            }
-            break;
-        case 3:
-            if(is_whitespace(ch))
-            {
-                automata_state=4;
-            }
-            else
-            {
-                automata_state=is_line_feed(ch)?1:0;
-            }
-        case 4:
-            if(is_whitespace(ch))
-            {
-                ;
-            }
-            else if(is_letter(ch) || is_underline(ch))
-            {
-                macro_source.push_back(ch);
-                automata_state=5;
-            }
-            else
-            {
-                automata_state=is_line_feed(ch)?1:0;
-            }
-            break;
-        case 5:
-            if(is_letter(ch) || is_underline(ch) || is_digit(ch))
-            {
-                macro_source.push_back(ch);
-            }
-            else if(is_whitespace(ch))
-            {
-                automata_state=6;
-            }
-            else if(is_left_parentheses(ch))
-            {
-                automata_state=9;
-            }
-            else
-            {
-                if(is_line_feed(ch))
-                {
-                    add_macro_var(macro_source,macro_destination);
-                    automata_state=1;
-                }
-                else
-                {
-                    automata_state=0;
-                }
-                macro_source.clear();
-            }
-            break;
-        case 6:
-            if(is_whitespace(ch))
-            {
-                ;
-            }
-            else if(is_line_feed(ch))
-            {
-                add_macro_var(macro_source,macro_destination);
-                automata_state=1;
-                macro_source.clear();
-                macro_destination.clear();
-            }
-            else
-            {
-                macro_destination.push_back(ch);
-                automata_state=7;
-                res=true;
-            }
-            break;
-        case 7:
-            if(is_line_feed(ch))
-            {
-                add_macro_var(macro_source,macro_destination);
-                automata_state=1;
-                macro_source.clear();
-                macro_destination.clear();
-            }
-            else
-            {
-                macro_destination.push_back(ch);
-                res=true;
-            }
-            break;
-        case 9:
-            if(is_whitespace(ch))
-            {
-                ;
-            }
-            else if(is_right_parentheses(ch))
-            {
-                automata_state=13;
-            }
-            else if(is_letter(ch) || is_underline(ch))
-            {
-                macro_func_f_param.push_back(ch);
-                automata_state=10;
-            }
-            else
-            {
-                macro_source.clear();
-                automata_state=is_line_feed(ch)?1:0;
-            }
-            break;
-        case 10:
-            if(is_letter(ch) || is_underline(ch) || is_digit(ch))
-            {
-                macro_func_f_param.push_back(ch);
-            }
-            else if(is_whitespace(ch))
-            {
-                macro_func_f_params.push_back(macro_func_f_param);
-                macro_func_f_param.clear();
-                automata_state=11;
-            }
-            else if(is_comma(ch))
-            {
-                macro_func_f_params.push_back(macro_func_f_param);
-                macro_func_f_param.clear();
-                automata_state=12;
-            }
-            else if(is_right_parentheses(ch))
-            {
-                macro_func_f_params.push_back(macro_func_f_param);
-                macro_func_f_param.clear();
-                automata_state=13;
-            }
-            else
-            {
-                macro_source.clear();
-                macro_func_f_params.clear();
-                macro_func_f_param.clear();
-                automata_state=is_line_feed(ch)?1:0;
-            }
-            break;
-        case 11:
-            if(is_whitespace(ch))
-            {
-                ;
-            }
-            else if(is_comma(ch))
-            {
-                automata_state=12;
-            }
-            else if(is_right_parentheses(ch))
-            {
-                automata_state=13;
-            }
-            else
-            {
-                macro_source.clear();
-                macro_func_f_params.clear();
-                automata_state=is_line_feed(ch)?1:0;
-            }
-            break;
-        case 12:
-            if(is_whitespace(ch))
-            {
-                ;
-            }
-            else if(is_letter(ch) || is_underline(ch))
-            {
-                macro_func_f_param.push_back(ch);
-                automata_state=10;
-            }
-            else
-            {
-                macro_source.clear();
-                macro_func_f_params.clear();
-                automata_state=is_line_feed(ch)?1:0;
-            }
-            break;
-        case 13:
-            if(is_whitespace(ch))
-            {
-                automata_state=14;
-            }
-            else if(is_line_feed(ch))
-            {
-                add_macro_func(macro_source,macro_func_f_params,macro_destination);
-                automata_state=1;
-                macro_source.clear();
-                macro_func_f_params.clear();
-            }
-            else
-            {
-                macro_source.clear();
-                macro_func_f_params.clear();
-                automata_state=0;
-            }
-            break;
-        case 14:
-            if(is_whitespace(ch))
-            {
-                ;
-            }
-            else if(is_line_feed(ch))
-            {
-                add_macro_func(macro_source,macro_func_f_params,macro_destination);
-                automata_state=1;
-                macro_source.clear();
-                macro_func_f_params.clear();
-            }
-            else
-            {
-                macro_destination.push_back(ch);
-                automata_state=15;
-                res=true;
-            }
-            break;
-        case 15:
-            if(is_line_feed(ch))
-            {
-                add_macro_func(macro_source,macro_func_f_params,macro_destination);
-                automata_state=1;
-                macro_source.clear();
-                macro_func_f_params.clear();
-                macro_destination.clear();
-            }
-            else
-            {
-                macro_destination.push_back(ch);
-                res=true;
-            }
-            break;
-        default:
-            macro_define_string_pointer=0;
-            macro_source.clear();
-            macro_func_f_params.clear();
-            macro_func_f_param.clear();
-            macro_destination.clear();
-            automata_state=0;
-            break;
+        i.str=m->content.data()+(i.str-definition.content.data());
     }
-
-    return res;
+    m->memo.clear();
+    m->memo_deps.clear();
+    m->memo_version=0;
+    version_++;
 }
 
+//头文件缓存的互斥锁和所有缓存的头文件
+mutex Include_cache::mutex_;
+map<string,shared_ptr<const struct include_file> > Include_cache::files_;
+
 /*
-尝试进行宏替换的自动机
-能进行正常的宏变量替换
-只能进行没有参数的宏函数替换
+查找一个头文件
+
+Parameters
+----------
+filename:头文件名
+file_stat:头文件目前的状态
 
 Return
 ------
-返回写缓冲区需要弹出的字符
+缓存的头文件，没有缓存或者文件的修改时间、大小和缓存的时候不同时返回nullptr
 */
-size_t Pre_processor::macro_replace_automata(char ch,bool do_macro_replace)
+shared_ptr<const struct include_file> Include_cache::find(const string & filename,const struct stat & file_stat)
 {
-    size_t res=0;
-    static size_t automata_state=1,macro_source_size;
-    static string identifier;
+    lock_guard<mutex> lock(mutex_);
+    auto it=files_.find(filename);
 
-    if(!do_macro_replace)
+    if(it==files_.end())
     {
-        return res;
+        return nullptr;
     }
-
-    switch(automata_state)
+    const struct include_file & file=*it->second;
+    if(file.mtime.tv_sec!=file_stat.st_mtim.tv_sec || file.mtime.tv_nsec!=file_stat.st_mtim.tv_nsec || file.size!=file_stat.st_size)
     {
-        case 1:
-            if(is_double_quotation(ch))
-            {
-                automata_state=2;
-            }
-            else if(is_single_quotation(ch))
-            {
-                automata_state=4;
-            }
-            else if(is_letter(ch) || is_underline(ch))
-            {
-                identifier.push_back(ch);
-                automata_state=6;
-            }
-            break;
-        case 2:
-            if(is_double_quotation(ch))
+        return nullptr;
+    }
+    return it->second;
+}
+
+/*
+缓存一个头文件
+
+Parameters
+----------
+filename:头文件名
+file:要缓存的头文件
+*/
+void Include_cache::add(const string & filename,const shared_ptr<const struct include_file> & file)
+{
+    lock_guard<mutex> lock(mutex_);
+    files_[filename]=file;
+}
+
+/*
+Pre_processor的构造函数
+*/
+Pre_processor::Pre_processor():macro_expansion_num_(0),macro_memo_hit_num_(0),recorded_macros_(nullptr),include_depth_(0)
+{
+    macros_.add("__FILE__",macro_kind::INNER_VAR,0,"");
+    macros_.add("__LINE__",macro_kind::INNER_VAR,0,"");
+    macros_.add("__DATE__",macro_kind::INNER_VAR,0,"");
+    macros_.add("__TIME__",macro_kind::INNER_VAR,0,"");
+    macros_.add("__STDC__",macro_kind::INNER_VAR,0,"");
+}
+
+/*
+Pre_processor的析构函数
+*/
+Pre_processor::~Pre_processor()
+{
+    
+}
+
+/*
+增加一个宏变量
+
+Parameters
+----------
+macro_source:待替换的宏
+macro_destination:被替换的宏
+
+Return
+------
+如果增加成功，返回true，否则返回false
+*/
+bool Pre_processor::add_macro_var(string macro_source,string macro_destination)
+{
+    return define_macro(macro_source,macro_kind::VAR,list<string>(),macro_destination);
+}
+
+/*
+增加一个宏函数
+如果最后一个形参是__VA_ARGS__，那么它是可变参数
+
+Parameters
+----------
+macro_source:待替换的宏
+macro_func_f_params:宏函数的形参
+macro_destination:被替换的宏
+
+Return
+------
+如果增加成功，返回true，否则返回false
+*/
+bool Pre_processor::add_macro_func(string macro_source,list<string> macro_func_f_params,string macro_destination)
+{
+    return define_macro(macro_source,macro_kind::FUNC,macro_func_f_params,macro_destination);
+}
+
+/*
+判断两个宏的定义是否相同(种类、形参和内容的记号都相同，记号之间的空白符只看有没有)
+
+Parameters
+----------
+a:第一个宏
+b:第二个宏
+
+Return
+------
+相同返回true，否则返回false
+*/
+static bool is_same_macro_definition(const struct macro * a,const struct macro * b)
+{
+    if(a->kind!=b->kind || a->f_param_num!=b->f_param_num || a->is_variadic!=b->is_variadic || a->tokens.size()!=b->tokens.size())
+    {
+        return false;
+    }
+    for(size_t i=0;i<a->tokens.size();i++)
+    {
+        const struct pp_token & x=a->tokens[i],& y=b->tokens[i];
+        if(x.kind!=y.kind || x.len!=y.len || memcmp(x.str,y.str,x.len)!=0 || x.param_index!=y.param_index || (i>0 && x.space_before!=y.space_before))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+定义一个宏
+已经存在同名的宏的时候，如果定义不同就给出警告并使用新的定义(和gcc相同)，内置宏变量不能重新定义
+
+Parameters
+----------
+name:宏名
+kind:宏的种类(宏变量或者宏函数)
+f_params:宏函数的形参，如果最后一个形参是__VA_ARGS__，那么它是可变参数
+content:宏的内容
+
+Return
+------
+如果定义成功，返回true，否则返回false
+*/
+bool Pre_processor::define_macro(string name,enum macro_kind kind,const list<string> & f_params,string content)
+{
+    uint64_t name_hash=Macro_table::hash(name.c_str(),name.size());
+    struct macro * m=macros_.find(name.c_str(),name.size(),name_hash);
+
+    if(!m)
+    {
+        m=macros_.add(name,kind,f_params.size(),content);
+        m->is_variadic=(!f_params.empty() && f_params.back()==MACRO_VA_ARGS);
+        tokenize_macro_content(m,f_params);
+        return true;
+    }
+    if(m->kind==macro_kind::INNER_VAR)
+    {
+        cout<<"Warning: Built-in macro "<<name<<" can not be redefined!"<<endl;
+        return false;
+    }
+
+    struct macro definition(name,name_hash,kind,f_params.size(),content);
+    definition.is_variadic=(!f_params.empty() && f_params.back()==MACRO_VA_ARGS);
+    tokenize_macro_content(&definition,f_params);
+    if(!is_same_macro_definition(m,&definition))
+    {
+        cout<<"Warning: Macro "<<name<<" redefined!"<<endl;
+        macros_.redefine(m,definition);
+    }
+    return true;
+}
+
+/*
+把宏的内容分成记号
+宏函数的内容中的形参、#形参和##会被识别出来，替换的时候就不需要再查找形参了
+
+Parameters
+----------
+m:要处理的宏
+f_params:宏函数的形参
+*/
+void Pre_processor::tokenize_macro_content(struct macro * m,const list<string> & f_params)
+{
+    const string & content=m->content;
+    size_t pos=0,end,param_index;
+    bool space_before=false;
+    struct pp_token token;
+    enum pp_token_kind kind;
+
+    while(pos<content.size())
+    {
+        if(is_whitespace(content[pos]) || is_line_feed(content[pos]))
+        {
+            space_before=true;
+            pos++;
+            continue;
+        }
+        end=scan_pp_token(content.data(),content.size(),pos,kind);
+        token={content.data()+pos,end-pos,0,kind,space_before,false};
+        space_before=false;
+        pos=end;
+        if(kind==pp_token_kind::IDENTIFIER && m->kind==macro_kind::FUNC)
+        {
+            param_index=0;
+            for(auto & i:f_params)
+            {
+                if(i.size()==token.len && i.compare(0,token.len,token.str,token.len)==0)
+                {
+                    token.kind=pp_token_kind::PARAM;
+                    token.param_index=param_index;
+                    break;
+                }
+                param_index++;
+            }
+            //#形参
+            if(token.kind==pp_token_kind::PARAM && !m->tokens.empty() && is_punctuator_token(m->tokens.back(),"#"))
+            {
+                token.kind=pp_token_kind::STRINGIFY;
+                token.space_before=m->tokens.back().space_before;
+                m->tokens.back()=token;
+                continue;
+            }
+        }
+        else if(is_punctuator_token(token,"##"))
+        {
+            token.kind=pp_token_kind::PASTE;
+        }
+        m->tokens.push_back(token);
+    }
+
+    //##的两边都必须有记号
+    if(!m->tokens.empty() && (m->tokens.front().kind==pp_token_kind::PASTE || m->tokens.back().kind==pp_token_kind::PASTE))
+    {
+        cout<<"Warning: '##' cannot appear at either end of macro "<<m->name<<"!"<<endl;
+        m->tokens.front().kind=(m->tokens.front().kind==pp_token_kind::PASTE?pp_token_kind::PUNCTUATOR:m->tokens.front().kind);
+        m->tokens.back().kind=(m->tokens.back().kind==pp_token_kind::PASTE?pp_token_kind::PUNCTUATOR:m->tokens.back().kind);
+    }
+}
+
+/*
+保存一个拼接出来的字符串，返回指向它的记号
+
+Parameters
+----------
+str:记号的内容
+kind:记号的种类
+space_before:记号之前是否有空白符
+
+Return
+------
+指向保存的字符串的记号
+*/
+struct pp_token Pre_processor::make_token(string str,enum pp_token_kind kind,bool space_before)
+{
+    token_strs_.push_back(move(str));
+    return {token_strs_.back().data(),token_strs_.back().size(),0,kind,space_before,false};
+}
+
+/*
+进行内置宏变量的宏替换
+
+Parameters
+----------
+m:要替换的内置宏变量
+
+Return
+------
+替换之后的记号
+*/
+struct pp_token Pre_processor::inner_macro_var_replace(struct macro * m)
+{
+    char buf[32];
+    time_t now;
+    struct pp_token res;
+
+    if(m->name=="__LINE__")
+    {
+        res=make_token(to_string(current_line_),pp_token_kind::NUMBER,false);
+    }
+    else if(m->name=="__FILE__")
+    {
+        res=make_token("\""+source_program_filename_+"\"",pp_token_kind::LITERAL,false);
+    }
+    else if(m->name=="__STDC__")
+    {
+        res=make_token("1",pp_token_kind::NUMBER,false);
+    }
+    else
+    {
+        now=time(nullptr);
+        strftime(buf,sizeof(buf),m->name=="__DATE__"?"\"%b %e %Y\"":"\"%H:%M:%S\"",localtime(&now));
+        res=make_token(buf,pp_token_kind::LITERAL,false);
+    }
+    res.no_expand=true;
+    return res;
+}
+
+/*
+添加内置的头文件
+内置头文件中只有定义的宏有用，所以同一个进程中每个内置头文件只预处理一次，并记录其中定义的宏，
+之后的预处理器在头文件没有被修改过的时候直接重新定义这些宏
+
+Parameters
+----------
+file_num:要添加的头文件的数量
+filename:要添加的内置头文件的文件名
+
+Return
+------
+如果添加成功返回true，否则返回false
+*/
+bool Pre_processor::add_inner_header_files(size_t file_num,...)
+{
+    struct stat file_stat;
+    shared_ptr<const struct include_file> file;
+    shared_ptr<struct include_file> new_file;
+    const char * filename;
+    bool res=true;
+    va_list argptr;
+	va_start(argptr,file_num);
+	for(size_t i=0;i<file_num;i++)
+	{
+		filename=va_arg(argptr,const char *);
+        if(stat(filename,&file_stat)!=0)
+        {
+            cout<<"Open file "<<filename<<" error!"<<endl;
+            va_end(argptr);
+            return false;
+        }
+
+        //已经记录了其中定义的宏的时候直接重新定义这些宏
+        file=Include_cache::find(filename,file_stat);
+        if(file && file->is_macros_recorded)
+        {
+            Time_report::add_counter("include cache hits",1);
+            define_macros(file->macros);
+            continue;
+        }
+
+        //预处理，这里主要是为了记录头文件中的#define语句，预处理的结果会被丢弃
+        new_file=make_shared<struct include_file>();
+        new_file->mtime=file_stat.st_mtim;
+        new_file->size=file_stat.st_size;
+        if(file)
+        {
+            new_file->text=file->text;
+        }
+        else if(!remove_comments(filename,new_file->text))
+        {
+            cout<<"Inner header file "<<filename<<" format error!"<<endl;
+            res=false;
+            continue;
+        }
+        source_program_filename_=filename;
+        current_line_=1;
+        include_depth_=0;
+        recorded_macros_=&new_file->macros;
+        macro_replace(new_file->text);
+        recorded_macros_=nullptr;
+        source_program_after_pre_process_.clear();
+        new_file->is_macros_recorded=true;
+        Include_cache::add(filename,new_file);
+	}
+    va_end(argptr);
+    return res;
+}
+
+/*
+识别一条#define语句
+能识别宏变量和宏函数的定义，宏函数的最后一个形参可以是...(可变参数)
+
+Parameters
+----------
+source:删除注释之后的源程序
+pos:一行中的第一个非空白字符'#'的位置
+
+Return
+------
+如果是#define语句，返回该行的换行符的位置(整行都不会输出，只输出换行符，保持行号不变)，否则返回pos
+*/
+size_t Pre_processor::macro_define(const string & source,size_t pos)
+{
+    static const string macro_define_string="define";
+    static const string macro_ellipsis_string="...";
+    size_t end=source.find('\n',pos),p=pos+1,start;
+    string name;
+    list<string> f_params;
+
+    if(end==string::npos)
+    {
+        end=source.size();
+    }
+
+    //#和define之间可以有空白符，define之后必须有空白符
+    while(p<end && is_whitespace(source[p]))
+    {
+        p++;
+    }
+    if(source.compare(p,macro_define_string.size(),macro_define_string)!=0)
+    {
+        return pos;
+    }
+    p+=macro_define_string.size();
+    if(p>=end || !is_whitespace(source[p]))
+    {
+        return pos;
+    }
+    while(p<end && is_whitespace(source[p]))
+    {
+        p++;
+    }
+
+    //宏名
+    if(p>=end || !(is_letter(source[p]) || is_underline(source[p])))
+    {
+        return pos;
+    }
+    start=p;
+    while(p<end && is_identifier_char(source[p]))
+    {
+        p++;
+    }
+    name=source.substr(start,p-start);
+
+    if(p<end && is_left_parentheses(source[p]))
+    {
+        //宏函数的形参
+        p++;
+        while(true)
+        {
+            while(p<end && is_whitespace(source[p]))
+            {
+                p++;
+            }
+            if(p<end && is_right_parentheses(source[p]) && f_params.empty())
+            {
+                break;
+            }
+            if(source.compare(p,macro_ellipsis_string.size(),macro_ellipsis_string)==0)
+            {
+                //可变参数只能是最后一个形参
+                f_params.push_back(MACRO_VA_ARGS);
+                p+=macro_ellipsis_string.size();
+                while(p<end && is_whitespace(source[p]))
+                {
+                    p++;
+                }
+                if(p<end && is_right_parentheses(source[p]))
+                {
+                    break;
+                }
+                return pos;
+            }
+            if(p>=end || !(is_letter(source[p]) || is_underline(source[p])))
             {
-                automata_state=1;
+                return pos;
             }
-            else if(is_backslash(ch))
+            start=p;
+            while(p<end && is_identifier_char(source[p]))
             {
-                automata_state=3;
+                p++;
             }
-            break;
-        case 3:
-            automata_state=2;
-            break;
-        case 4:
-            if(is_single_quotation(ch))
+            f_params.push_back(source.substr(start,p-start));
+            while(p<end && is_whitespace(source[p]))
             {
-                automata_state=1;
+                p++;
             }
-            else if(is_backslash(ch))
+            if(p<end && is_comma(source[p]))
             {
-                automata_state=5;
+                p++;
             }
-            break;
-        case 5:
-            automata_state=4;
-            break;
-        case 6:
-            if(is_letter(ch) || is_underline(ch) || is_digit(ch))
+            else if(p<end && is_right_parentheses(source[p]))
             {
-                identifier.push_back(ch);
+                break;
             }
-            else if(macro_funcs_.find(identifier)!=macro_funcs_.end() && (is_whitespace(ch) || is_line_feed(ch)))
+            else
             {
-                macro_source_size=identifier.size()+1;
-                automata_state=7;
+                return pos;
             }
-            else if(macro_funcs_.find(identifier)!=macro_funcs_.end() && is_left_parentheses(ch))
+        }
+        p++;
+        while(p<end && is_whitespace(source[p]))
+        {
+            p++;
+        }
+        if(add_macro_func(name,f_params,source.substr(p,end-p)) && recorded_macros_)
+        {
+            recorded_macros_->push_back({name,true,f_params,source.substr(p,end-p)});
+        }
+    }
+    else if(p>=end || is_whitespace(source[p]))
+    {
+        while(p<end && is_whitespace(source[p]))
+        {
+            p++;
+        }
+        if(add_macro_var(name,source.substr(p,end-p)) && recorded_macros_)
+        {
+            recorded_macros_->push_back({name,false,list<string>(),source.substr(p,end-p)});
+        }
+    }
+    else
+    {
+        return pos;
+    }
+
+    return end;
+}
+
+/*
+识别一条#include语句
+#include "文件名"把头文件宏替换之后的内容放在这一行，其中的换行符替换成空格，保持之后的行号不变
+#include <文件名>是系统的头文件(例如内置头文件中的stdio.h)，SysY程序用不到，直接忽略
+
+Parameters
+----------
+source:删除注释之后的源程序
+pos:一行中的第一个非空白字符'#'的位置
+
+Return
+------
+如果是#include语句，返回该行的换行符的位置，否则返回pos
+*/
+size_t Pre_processor::macro_include(const string & source,size_t pos)
+{
+    static const string macro_include_string="include";
+    string & output=source_program_after_pre_process_;
+    size_t end=source.find('\n',pos),p=pos+1,start,slash,output_start,old_line;
+    string filename,old_filename;
+    shared_ptr<const struct include_file> file;
+    char close;
+
+    if(end==string::npos)
+    {
+        end=source.size();
+    }
+
+    while(p<end && is_whitespace(source[p]))
+    {
+        p++;
+    }
+    if(source.compare(p,macro_include_string.size(),macro_include_string)!=0)
+    {
+        return pos;
+    }
+    p+=macro_include_string.size();
+    while(p<end && is_whitespace(source[p]))
+    {
+        p++;
+    }
+    if(p<end && is_double_quotation(source[p]))
+    {
+        close='\"';
+    }
+    else if(p<end && source[p]=='<')
+    {
+        close='>';
+    }
+    else
+    {
+        return pos;
+    }
+    start=++p;
+    while(p<end && source[p]!=close)
+    {
+        p++;
+    }
+    if(p>=end)
+    {
+        return pos;
+    }
+    if(close=='>')
+    {
+        return end;
+    }
+
+    //相对路径是相对于包含它的文件所在的目录
+    filename=source.substr(start,p-start);
+    if((filename.empty() || filename[0]!='/') && (slash=source_program_filename_.rfind('/'))!=string::npos)
+    {
+        filename=source_program_filename_.substr(0,slash+1)+filename;
+    }
+    if(include_depth_>=MAX_INCLUDE_DEPTH)
+    {
+        cout<<source_program_filename_<<":"<<current_line_<<": #include nested too deeply!"<<endl;
+        return end;
+    }
+    if(!(file=load_include_file(filename)))
+    {
+        return end;
+    }
+
+    //对头文件进行宏替换，其中的#define语句定义的宏在之后的源程序中也有效
+    old_filename=source_program_filename_;
+    old_line=current_line_;
+    source_program_filename_=filename;
+    current_line_=1;
+    include_depth_++;
+    output_start=output.size();
+    macro_replace(file->text);
+    replace(output.begin()+output_start,output.end(),'\n',' ');
+    include_depth_--;
+    source_program_filename_=old_filename;
+    current_line_=old_line;
+
+    return end;
+}
+
+/*
+重新定义头文件中记录的宏
+
+Parameters
+----------
+macros:头文件中定义的宏(按照定义的顺序)
+*/
+void Pre_processor::define_macros(const vector<struct macro_definition> & macros)
+{
+    for(auto & i:macros)
+    {
+        if(i.is_func)
+        {
+            add_macro_func(i.name,i.f_params,i.content);
+        }
+        else
+        {
+            add_macro_var(i.name,i.content);
+        }
+    }
+}
+
+/*
+展开源程序中的一个宏，展开的结果直接写到预处理之后的源程序中
+宏函数的实参中的换行符放在展开的结果之前，保持之后的行号不变
+
+Parameters
+----------
+source:删除注释之后的源程序
+start:宏名在源程序中的开始位置
+pos:宏名之后的位置
+m:要展开的宏
+
+Return
+------
+源程序中下一个要扫描的位置
+*/
+size_t Pre_processor::macro_expand_from_source(const string & source,size_t start,size_t pos,struct macro * m)
+{
+    struct macro_expand_context & context=source_expand_context_;
+    vector<struct pp_token> & result=source_expand_result_;
+    struct pp_token name={source.data()+start,pos-start,0,pp_token_kind::IDENTIFIER,false,false};
+
+    //源程序中没有正在展开的宏，宏变量的记忆的结果只要没有过期就可以直接输出(最后一个记号是标识符的时候可能是宏函数名，需要正常展开)
+    if(m->kind==macro_kind::VAR && m->memo_version==macros_.get_version() && (m->memo.empty() || m->memo.back().kind!=pp_token_kind::IDENTIFIER || m->memo.back().no_expand))
+    {
+        macro_expansion_num_++;
+        macro_memo_hit_num_++;
+        output_tokens(m->memo);
+        return pos;
+    }
+
+    context.frames.clear();
+    context.base=nullptr;
+    context.base_num=0;
+    context.base_pos=0;
+    context.source=&source;
+    context.source_pos=pos;
+    context.line_feed_num=0;
+    context.space_pending=false;
+    context.is_context_free=true;
+    context.is_args_unterminated=false;
+    context.deps.clear();
+    context.painted.clear();
+    result.clear();
+
+    //不是宏函数的调用的时候宏名原样输出(读取过的记号也会重新扫描)
+    if(!push_macro_expansion(context,name,m))
+    {
+        result.push_back(name);
+    }
+    macro_expand(context,result);
+
+    source_program_after_pre_process_.append(context.line_feed_num,'\n');
+    current_line_+=context.line_feed_num;
+    output_tokens(result);
+    return context.source_pos;
+}
+
+/*
+展开上下文中的所有宏，直到正在展开的宏的栈和最下面的记号都扫描完
+源程序不会被读取，只有在收集宏函数的实参的时候才会读取
+
+Parameters
+----------
+context:宏展开的上下文
+result:展开的结果
+*/
+void Pre_processor::macro_expand(struct macro_expand_context & context,vector<struct pp_token> & result)
+{
+    struct pp_token token;
+    struct macro * m;
+
+    while(next_token(context,token,m,false))
+    {
+        if(m && push_macro_expansion(context,token,m))
+        {
+            //替换之后的第一个记号继承宏名之前的空白符
+            context.space_pending=(context.space_pending || token.space_before);
+            continue;
+        }
+        if(context.space_pending)
+        {
+            token.space_before=true;
+            context.space_pending=false;
+        }
+        result.push_back(token);
+    }
+}
+
+/*
+从上下文中读取下一个记号
+正在展开的宏的内容扫描完之后，该宏出栈，可以再次被替换
+正在展开的宏的宏名会被标记为不再替换，之后即使该宏展开完了也不会再替换
+
+Parameters
+----------
+context:宏展开的上下文
+token:读取的记号
+m:记号对应的可以替换的宏(不能替换的时候为nullptr)
+read_source:是否读取最下面的源程序
+
+Return
+------
+读取成功返回true，上下文中没有记号了返回false
+*/
+bool Pre_processor::next_token(struct macro_expand_context & context,struct pp_token & token,struct macro * & m,bool read_source)
+{
+    const string * source;
+    enum pp_token_kind kind;
+    size_t end;
+    bool space_before=false;
+
+    m=nullptr;
+    while(!context.frames.empty())
+    {
+        struct macro_expand_frame & frame=context.frames.back();
+        const vector<struct pp_token> & tokens=frame.memo?*frame.memo:frame.tokens;
+
+        if(frame.pos<tokens.size())
+        {
+            token=tokens[frame.pos++];
+            //已经完全展开过的记号不再重新扫描，否则展开出来的左括号会和之前的宏函数名组成调用
+            if(frame.is_expanded && frame.pos<tokens.size())
+            {
+                return true;
+            }
+            goto found;
+        }
+        if(frame.m)
+        {
+            frame.m->is_expanding=false;
+        }
+        context.frames.pop_back();
+    }
+    if(context.base_pos<context.base_num)
+    {
+        token=context.base[context.base_pos++];
+        goto found;
+    }
+    if(!read_source || !context.source)
+    {
+        return false;
+    }
+
+    //从源程序中读取
+    source=context.source;
+    while(context.source_pos<source->size() && (is_whitespace((*source)[context.source_pos]) || is_line_feed((*source)[context.source_pos])))
+    {
+        if(is_line_feed((*source)[context.source_pos]))
+        {
+            context.line_feed_num++;
+        }
+        space_before=true;
+        context.source_pos++;
+    }
+    if(context.source_pos>=source->size())
+    {
+        return false;
+    }
+    end=scan_pp_token(source->data(),source->size(),context.source_pos,kind);
+    token={source->data()+context.source_pos,end-context.source_pos,0,kind,space_before,false};
+    context.source_pos=end;
+
+found:
+    if(token.kind==pp_token_kind::IDENTIFIER && !token.no_expand)
+    {
+        uint64_t hash=Macro_table::hash(token.str,token.len);
+
+        if(!macros_.is_definitely_not_macro(hash) && (m=macros_.find(token.str,token.len,hash)) && m->is_expanding)
+        {
+            token.no_expand=true;
+            context.painted.push_back(m);
+            m=nullptr;
+        }
+    }
+    return true;
+}
+
+/*
+判断上下文中下一个记号是否是左括号(不读取记号)
+
+Parameters
+----------
+context:宏展开的上下文
+
+Return
+------
+下一个记号是左括号返回true，否则返回false
+*/
+bool Pre_processor::is_next_left_parentheses(struct macro_expand_context & context)
+{
+    size_t p;
+
+    for(size_t i=context.frames.size();i-->0;)
+    {
+        const vector<struct pp_token> & tokens=context.frames[i].memo?*context.frames[i].memo:context.frames[i].tokens;
+
+        if(context.frames[i].pos<tokens.size())
+        {
+            return is_punctuator_token(tokens[context.frames[i].pos],"(");
+        }
+    }
+    if(context.base_pos<context.base_num)
+    {
+        return is_punctuator_token(context.base[context.base_pos],"(");
+    }
+    if(context.source)
+    {
+        p=context.source_pos;
+        while(p<context.source->size() && (is_whitespace((*context.source)[p]) || is_line_feed((*context.source)[p])))
+        {
+            p++;
+        }
+        return p<context.source->size() && is_left_parentheses((*context.source)[p]);
+    }
+    return false;
+}
+
+/*
+开始展开一个宏：收集实参并进行替换，然后把替换的结果压入正在展开的宏的栈中
+没有实参的宏(宏变量和没有形参的宏函数)的展开结果会被记忆下来，之后直接重新扫描记忆的结果
+
+Parameters
+----------
+context:宏展开的上下文
+name:宏名的记号
+m:要展开的宏
+
+Return
+------
+开始展开返回true，不是宏函数的调用返回false
+*/
+bool Pre_processor::push_macro_expansion(struct macro_expand_context & context,const struct pp_token & name,struct macro * m)
+{
+    vector<struct pp_token> tokens,substituted;
+    vector<pair<size_t,size_t> > args;
+    struct macro_expand_frame frame;
+    bool is_memo_valid;
+
+    frame.m=m;
+    frame.memo=nullptr;
+    frame.is_expanded=false;
+    frame.pos=0;
+
+    if(m->kind==macro_kind::INNER_VAR)
+    {
+        frame.m=nullptr;
+        frame.tokens.push_back(inner_macro_var_replace(m));
+        context.is_context_free=false;
+        context.frames.push_back(move(frame));
+        return true;
+    }
+    if(m->kind==macro_kind::FUNC)
+    {
+        if(!is_next_left_parentheses(context))
+        {
+            return false;
+        }
+        if(!collect_macro_args(context,m,tokens,args))
+        {
+            //读取过的记号重新扫描
+            frame.m=nullptr;
+            frame.tokens=move(tokens);
+            context.frames.push_back(move(frame));
+            return false;
+        }
+    }
+    macro_expansion_num_++;
+
+    if(m->f_param_num==0)
+    {
+        is_memo_valid=(m->memo_version==macros_.get_version());
+        for(size_t i=0;is_memo_valid && i<m->memo_deps.size();i++)
+        {
+            is_memo_valid=!m->memo_deps[i]->is_expanding;
+        }
+        if(is_memo_valid)
+        {
+            macro_memo_hit_num_++;
+            frame.memo=&m->memo;
+            frame.is_expanded=true;
+            context.deps.insert(context.deps.end(),m->memo_deps.begin(),m->memo_deps.end());
+        }
+        else if(m->memo_version!=macros_.get_version())
+        {
+            //之前没有记忆或者宏表被修改了，重新完全展开一次
+            macro_substitute(context,m,tokens,args,substituted);
+            if(macro_expand_isolated(context,m,substituted.data(),substituted.size(),frame.tokens))
+            {
+                frame.is_expanded=true;
+                if(m->memo_version==macros_.get_version())
+                {
+                    frame.memo=&m->memo;
+                    frame.tokens.clear();
+                }
+            }
+            else
+            {
+                //内容中的宏函数调用的实参在宏的后面，只能正常替换，在外面的上下文中收集实参
+                frame.tokens=move(substituted);
+                context.deps.push_back(m);
+            }
+        }
+        else
+        {
+            //记忆的结果中展开过的宏正在展开，只能正常替换
+            macro_substitute(context,m,tokens,args,frame.tokens);
+            context.deps.push_back(m);
+        }
+    }
+    else
+    {
+        macro_substitute(context,m,tokens,args,frame.tokens);
+        context.deps.push_back(m);
+    }
+
+    m->is_expanding=true;
+    context.frames.push_back(move(frame));
+    return true;
+}
+
+/*
+收集宏函数调用的实参
+实参之间用最外层的逗号分隔，可变参数收集剩下的所有实参(包括逗号)
+读取过的记号都保存在一起，每个实参只记录它在其中的范围，不需要为每个实参分配内存
+实参可以跨过正在展开的宏的末尾，继续从下面的宏、记号或者源程序中读取
+
+Parameters
+----------
+context:宏展开的上下文，下一个记号是左括号
+m:宏函数
+tokens:读取过的所有记号(从左括号到右括号)
+args:每个实参在tokens中的开始和结束位置
+
+Return
+------
+收集成功返回true，括号不匹配或者实参个数不正确返回false
+*/
+bool Pre_processor::collect_macro_args(struct macro_expand_context & context,struct macro * m,vector<struct pp_token> & tokens,vector<pair<size_t,size_t> > & args)
+{
+    struct pp_token token;
+    struct macro * token_macro;
+    size_t depth=0;
+
+    tokens.reserve(MACRO_CALL_TOKEN_RESERVE_NUM);
+    args.reserve(m->f_param_num);
+    next_token(context,token,token_macro,true);
+    tokens.push_back(token);
+    args.push_back(make_pair(1,1));
+    while(next_token(context,token,token_macro,true))
+    {
+        tokens.push_back(token);
+        if(is_punctuator_token(token,"("))
+        {
+            depth++;
+        }
+        else if(is_punctuator_token(token,")"))
+        {
+            if(depth==0)
+            {
+                goto out;
+            }
+            depth--;
+        }
+        else if(depth==0 && is_punctuator_token(token,",") && !(m->is_variadic && args.size()==m->f_param_num))
+        {
+            args.push_back(make_pair(tokens.size(),tokens.size()));
+            continue;
+        }
+        args.back().second=tokens.size();
+    }
+    //单独展开没有实参的宏的时候，实参可能在外面的上下文中(宏的后面)，不是错误
+    if(!context.source && !context.base)
+    {
+        context.is_args_unterminated=true;
+        return false;
+    }
+    cout<<"Warning: Unterminated argument list invoking macro "<<m->name<<"!"<<endl;
+    return false;
+
+out:
+    if(m->f_param_num==0 && args.size()==1 && args[0].first==args[0].second)
+    {
+        args.clear();
+    }
+    else if(m->is_variadic && args.size()+1==m->f_param_num)
+    {
+        args.push_back(make_pair(tokens.size()-1,tokens.size()-1));
+    }
+    if(args.size()!=m->f_param_num)
+    {
+        cout<<"Warning: Macro "<<m->name<<" requires "<<m->f_param_num<<" arguments, but "<<args.size()<<" given!"<<endl;
+        return false;
+    }
+    return true;
+}
+
+/*
+把一串记号变成字符串常量(#形参)
+
+Parameters
+----------
+tokens:实参的记号
+token_num:实参的记号的个数
+space_before:#之前是否有空白符
+
+Return
+------
+字符串常量的记号
+*/
+struct pp_token Pre_processor::macro_stringify(const struct pp_token * tokens,size_t token_num,bool space_before)
+{
+    string str="\"";
+
+    for(size_t i=0;i<token_num;i++)
+    {
+        if(i>0 && tokens[i].space_before)
+        {
+            str.push_back(' ');
+        }
+        for(size_t j=0;j<tokens[i].len;j++)
+        {
+            //字符串和字符常量中的引号和反斜杠需要转义
+            if(tokens[i].kind==pp_token_kind::LITERAL && (is_double_quotation(tokens[i].str[j]) || is_backslash(tokens[i].str[j])))
+            {
+                str.push_back('\\');
+            }
+            str.push_back(tokens[i].str[j]);
+        }
+    }
+    str.push_back('\"');
+    return make_token(str,pp_token_kind::LITERAL,space_before);
+}
+
+/*
+把两个记号拼接成一个记号(##)
+
+Parameters
+----------
+lhs:左边的记号，拼接的结果也保存在这里
+rhs:右边的记号
+result:替换的结果，拼接的结果不是一个记号的时候右边的记号单独放在最后
+
+*/
+void Pre_processor::macro_paste(struct pp_token & lhs,const struct pp_token & rhs,vector<struct pp_token> & result)
+{
+    string str;
+    enum pp_token_kind kind;
+    bool space_before;
+
+    if(rhs.kind==pp_token_kind::PLACEMARKER)
+    {
+        return;
+    }
+    if(lhs.kind==pp_token_kind::PLACEMARKER)
+    {
+        space_before=lhs.space_before;
+        lhs=rhs;
+        lhs.space_before=space_before;
+        return;
+    }
+    str.append(lhs.str,lhs.len);
+    str.append(rhs.str,rhs.len);
+    if(scan_pp_token(str.data(),str.size(),0,kind)!=str.size())
+    {
+        cout<<"Warning: Pasting \""<<string(lhs.str,lhs.len)<<"\" and \""<<string(rhs.str,rhs.len)<<"\" does not give a valid preprocessing token!"<<endl;
+        result.push_back(rhs);
+        return;
+    }
+    lhs=make_token(str,kind,lhs.space_before);
+}
+
+/*
+判断一串记号中是否有可以替换的宏(正在展开的宏也算，展开的时候再标记为不再替换)
+
+Parameters
+----------
+tokens:要判断的记号
+token_num:记号的个数
+
+Return
+------
+有返回true，否则返回false
+*/
+bool Pre_processor::has_macro(const struct pp_token * tokens,size_t token_num) const
+{
+    uint64_t hash;
+
+    for(size_t i=0;i<token_num;i++)
+    {
+        if(tokens[i].kind==pp_token_kind::IDENTIFIER && !tokens[i].no_expand)
+        {
+            hash=Macro_table::hash(tokens[i].str,tokens[i].len);
+            if(!macros_.is_definitely_not_macro(hash) && macros_.find(tokens[i].str,tokens[i].len,hash))
             {
-                macro_source_size=identifier.size()+1;
-                automata_state=8;
+                return true;
             }
-            else
-            {
-                if(macro_vars_.find(identifier)!=macro_vars_.end())
+        }
+    }
+    return false;
+}
+
+/*
+用实参替换宏的内容中的形参，并处理#和##
+#和##两边的形参直接用实参替换，其余的形参用完全展开之后的实参替换(每个实参只展开一次，没有宏的实参不需要展开)
+
+Parameters
+----------
+context:宏展开的上下文
+m:要替换的宏
+tokens:宏函数调用中读取过的所有记号
+args:每个实参在tokens中的开始和结束位置
+result:替换的结果
+*/
+void Pre_processor::macro_substitute(struct macro_expand_context & context,struct macro * m,const vector<struct pp_token> & tokens,const vector<pair<size_t,size_t> > & args,vector<struct pp_token> & result)
+{
+    const vector<struct pp_token> & content=m->tokens;
+    vector<vector<struct pp_token> > expanded_args;
+    vector<pair<const struct pp_token *,size_t> > expanded(args.size(),make_pair(nullptr,0));
+    struct pp_token placemarker={"",0,0,pp_token_kind::PLACEMARKER,false,false},rhs;
+    const struct pp_token * arg;
+    size_t arg_num,index;
+
+    result.clear();
+    result.reserve(content.size()+tokens.size());
+    for(size_t i=0;i<content.size();i++)
+    {
+        switch(content[i].kind)
+        {
+            case pp_token_kind::STRINGIFY:
+                index=content[i].param_index;
+                result.push_back(macro_stringify(tokens.data()+args[index].first,args[index].second-args[index].first,content[i].space_before));
+                break;
+            case pp_token_kind::PARAM:
+                index=content[i].param_index;
+                if(i+1<content.size() && content[i+1].kind==pp_token_kind::PASTE)
                 {
-                    macro_var_replace(identifier);
-                    res=identifier.size();
+                    arg=tokens.data()+args[index].first;
+                    arg_num=args[index].second-args[index].first;
                 }
-                else if(inner_macro_vars_.find(identifier)!=inner_macro_vars_.end())
+                else
                 {
-                    inner_macro_var_replace(identifier);
-                    res=identifier.size();
+                    if(!expanded[index].first)
+                    {
+                        expanded[index]=make_pair(tokens.data()+args[index].first,args[index].second-args[index].first);
+                        //实参中有宏的时候才需要展开
+                        if(has_macro(expanded[index].first,expanded[index].second))
+                        {
+                            expanded_args.emplace_back();
+                            macro_expand_isolated(context,nullptr,expanded[index].first,expanded[index].second,expanded_args.back());
+                            expanded[index]=make_pair(expanded_args.back().data(),expanded_args.back().size());
+                        }
+                    }
+                    arg=expanded[index].first;
+                    arg_num=expanded[index].second;
                 }
-                automata_state=1;
-                identifier.clear();
-            }
-            break;
-        case 7:
-            if(is_whitespace(ch) || is_line_feed(ch))
-            {
-                macro_source_size++;
-            }
-            else if(is_left_parentheses(ch))
-            {
-                macro_source_size++;
-                automata_state=8;
-            }
-            else
-            {
-                automata_state=1;
-                identifier.clear();
-            }
-            break;
-        case 8:
-            if(is_whitespace(ch) || is_line_feed(ch))
-            {
-                macro_source_size++;
-            }
-            else if(is_right_parentheses(ch))
-            {
-                macro_source_size++;
-                automata_state=9;
-            }
-            else
-            {
-                automata_state=1;
-                identifier.clear();
-            }
-            break;
-        case 9:
-            res=macro_source_size;
-            no_f_params_macro_func_replace(identifier);
-            automata_state=1;
-            identifier.clear();
-            break;
-        default:
-            automata_state=1;
-            identifier.clear();
-            break;
+                if(arg_num==0)
+                {
+                    placemarker.space_before=content[i].space_before;
+                    result.push_back(placemarker);
+                    break;
+                }
+                result.insert(result.end(),arg,arg+arg_num);
+                result[result.size()-arg_num].space_before=content[i].space_before;
+                break;
+            case pp_token_kind::PASTE:
+                //##右边的记号，形参直接用实参替换
+                i++;
+                index=content[i].param_index;
+                if(content[i].kind==pp_token_kind::PARAM && args[index].first<args[index].second)
+                {
+                    macro_paste(result.back(),tokens[args[index].first],result);
+                    result.insert(result.end(),tokens.begin()+args[index].first+1,tokens.begin()+args[index].second);
+                    break;
+                }
+                if(content[i].kind==pp_token_kind::PARAM)
+                {
+                    rhs=placemarker;
+                }
+                else if(content[i].kind==pp_token_kind::STRINGIFY)
+                {
+                    rhs=macro_stringify(tokens.data()+args[index].first,args[index].second-args[index].first,content[i].space_before);
+                }
+                else
+                {
+                    rhs=content[i];
+                }
+                macro_paste(result.back(),rhs,result);
+                break;
+            default:
+                result.push_back(content[i]);
+                break;
+        }
     }
 
-    return res;
+    //删除空实参
+    result.erase(remove_if(result.begin(),result.end(),[](const struct pp_token & token){
+        return token.kind==pp_token_kind::PLACEMARKER;
+    }),result.end());
 }
 
 /*
-向写缓冲区写入一个字符
-同时检查是否能进行宏替换
-并在必要的时候将缓冲区的内容写入预处理之后的文件
+在一个单独的上下文中完全展开一串记号
+用于展开宏函数的实参，以及得到没有实参的宏的展开结果
+如果展开的结果只和这次展开的宏有关(没有因为外面正在展开的宏而停止替换，也没有内置宏变量)，那么记忆下来
 
 Parameters
 ----------
-ch:要向写缓冲区中写入的字符
+context:外面的上下文，这次展开过的宏也会记录到其中
+m:要展开的没有实参的宏(为nullptr表示展开的是宏函数的实参)
+tokens:要展开的记号(m不为nullptr的时候是m替换之后的内容)
+token_num:记号的个数
+result:展开的结果
+
+Return
+------
+展开完成返回true，m的内容中的宏函数调用的实参没有结束(实参在m的后面)返回false
 */
-void Pre_processor::write_char(char ch)
+bool Pre_processor::macro_expand_isolated(struct macro_expand_context & context,struct macro * m,const struct pp_token * tokens,size_t token_num,vector<struct pp_token> & result)
 {
-    bool do_macro_replace;
-    size_t write_buf_pop_times;
-    static bool is_identifier=false;
-    static size_t func_macro_step=0,i;
-    static string macro_func_source;
-    static list<string> macro_func_r_params;
+    struct macro_expand_context isolated;
+    struct macro_expand_frame frame;
+    bool is_memorable;
 
-    //尝试进行#define语句的识别
-    do_macro_replace=!macro_define_distinguish_automata(ch);
-
-    //尝试进行宏替换
-    write_buf_pop_times=macro_replace_automata(ch,do_macro_replace);
-
-    if(write_buf_pop_times)
+    isolated.base=nullptr;
+    isolated.base_num=0;
+    isolated.base_pos=0;
+    isolated.source=nullptr;
+    isolated.source_pos=0;
+    isolated.line_feed_num=0;
+    isolated.space_pending=false;
+    isolated.is_context_free=true;
+    isolated.is_args_unterminated=false;
+    if(m)
     {
-        while(write_buf_pop_times)
-        {
-            write_buf_.pop_back();
-            write_buf_pop_times--;
-        }
-        macro_bufs_.top().second.push_back(ch);
+        frame.m=m;
+        frame.tokens.assign(tokens,tokens+token_num);
+        frame.memo=nullptr;
+        frame.is_expanded=false;
+        frame.pos=0;
+        m->is_expanding=true;
+        isolated.frames.push_back(move(frame));
+        isolated.deps.push_back(m);
     }
     else
     {
-        write_buf_.push_back(ch);
+        isolated.base=tokens;
+        isolated.base_num=token_num;
+    }
+    result.clear();
+    result.reserve(token_num);
+    macro_expand(isolated,result);
+
+    sort(isolated.deps.begin(),isolated.deps.end());
+    isolated.deps.erase(unique(isolated.deps.begin(),isolated.deps.end()),isolated.deps.end());
+    is_memorable=(isolated.is_context_free && !isolated.is_args_unterminated);
+    for(size_t i=0;is_memorable && i<isolated.painted.size();i++)
+    {
+        is_memorable=binary_search(isolated.deps.begin(),isolated.deps.end(),isolated.painted[i]);
+    }
+    if(m && is_memorable)
+    {
+        m->memo=result;
+        m->memo_deps=isolated.deps;
+        m->memo_version=macros_.get_version();
     }
 
-    if(is_line_feed(ch))
+    context.deps.insert(context.deps.end(),isolated.deps.begin(),isolated.deps.end());
+    context.painted.insert(context.painted.end(),isolated.painted.begin(),isolated.painted.end());
+    context.is_context_free=(context.is_context_free && isolated.is_context_free);
+    return !isolated.is_args_unterminated;
+}
+
+/*
+把记号写到预处理之后的源程序中
+两个记号会被连在一起误认为一个记号的时候在中间加上空格
+
+Parameters
+----------
+tokens:要写的记号
+*/
+void Pre_processor::output_tokens(const vector<struct pp_token> & tokens)
+{
+    string & output=source_program_after_pre_process_;
+
+    for(auto & i:tokens)
     {
-        current_line_++;
+        if(!output.empty() && !is_whitespace(output.back()) && !is_line_feed(output.back()) && (i.space_before || may_paste(output.back(),i.str[0])))
+        {
+            output.push_back(' ');
+        }
+        output.append(i.str,i.len);
     }
 }
 
 /*
-将写缓冲区的内容写入文件
+对删除注释之后的源程序按照token进行宏替换
+源程序被分成标识符、数字、字符串和字符常量以及其余的字符，只有标识符才会查找宏表，
+不是宏的部分直接写到预处理之后的源程序中，宏在记号上展开
+
+结果追加到预处理之后的源程序中，这样#include的头文件可以直接在原来的位置展开
+
+Parameters
+----------
+source:删除注释之后的源程序
 */
-void Pre_processor::write_buf_to_file()
+void Pre_processor::macro_replace(const string & source)
 {
-    if(source_program_after_pre_proces_.is_open())
+    string & output=source_program_after_pre_process_;
+    size_t pos=0,start,end;
+    bool line_start=true;
+    uint64_t hash;
+    struct macro * m;
+    enum pp_token_kind kind;
+    char ch;
+
+    output.reserve(output.size()+source.size());
+
+    while(pos<source.size())
     {
-        source_program_after_pre_proces_<<write_buf_;
+        ch=source[pos];
+        if(is_letter(ch) || is_underline(ch))
+        {
+            //标识符，在扫描的同时计算哈希值
+            start=pos;
+            hash=FNV1A_64_OFFSET_BASIS;
+            while(pos<source.size() && is_identifier_char(source[pos]))
+            {
+                hash=(hash^(unsigned char)source[pos])*FNV1A_64_PRIME;
+                pos++;
+            }
+            m=macros_.is_definitely_not_macro(hash)?nullptr:macros_.find(source.data()+start,pos-start,hash);
+            if(m)
+            {
+                pos=macro_expand_from_source(source,start,pos,m);
+                //展开的结果不能和后面的字符连成一个记号
+                if(pos<source.size() && !output.empty() && may_paste(output.back(),source[pos]))
+                {
+                    output.push_back(' ');
+                }
+            }
+            else
+            {
+                output.append(source,start,pos-start);
+            }
+            line_start=false;
+        }
+        else if(is_digit(ch) || (ch=='.' && pos+1<source.size() && is_digit(source[pos+1])) || is_double_quotation(ch) || is_single_quotation(ch))
+        {
+            //数字(其中的字母不会被当作标识符)、字符串和字符常量(其中的内容不进行宏替换)
+            end=scan_pp_token(source.data(),source.size(),pos,kind);
+            output.append(source,pos,end-pos);
+            pos=end;
+            line_start=false;
+        }
+        else if(is_well_number(ch) && line_start && ((end=macro_define(source,pos))!=pos || (end=macro_include(source,pos))!=pos))
+        {
+            //#define和#include语句只输出换行符(#include "文件名"在这之前输出头文件的内容)
+            pos=end;
+            line_start=false;
+        }
+        else
+        {
+            output.push_back(ch);
+            pos++;
+            if(is_line_feed(ch))
+            {
+                current_line_++;
+                line_start=true;
+            }
+            else if(!is_whitespace(ch))
+            {
+                line_start=false;
+            }
+        }
     }
-    write_buf_.clear();
 }
 
 /*
-进行预处理
-主要是用于去除注释,以及进行简单的宏替换
+读取一个文件并删除其中的注释
+整个文件一次性读入读缓冲区，然后用指针扫描，不在注释中的连续的普通字符整段写入结果
 
 Parameters
 ----------
-source_program_filename:源程序文件名
-source_program_after_pre_processor_filename:预处理之后的源程序名
+filename:文件名
+result:删除注释之后的内容
 
 Return
 ------
-如果预处理成功返回true，否则返回false
+如果读取成功返回true，否则返回false
 */
-bool Pre_processor::pre_process(const char * source_program_filename,const char * source_program_after_pre_processor_filename)
+bool Pre_processor::remove_comments(const char * filename,string & result)
 {
-    char ch1,ch2;
-    bool singleline_comment=false,multiline_comment=false;
-    current_line_=1;
+    char buf[READ_BUF_SIZE];
+    size_t read_length;
+    struct stat file_stat;
+    FILE * file;
+    const char * p,* start,* end;
+    bool singleline_comment=false,multiline_comment=false,double_quotation_mark=false,single_quotation_mark=false;
 
-    //打开读文件
-    source_program_.open(source_program_filename);
-	if (!source_program_)
+    //打开文件，一次性读入整个文件
+    file=fopen(filename,"r");
+    if(file==nullptr)
     {
-        cout<<"File "<<source_program_filename<<" open error!"<<endl;
+        cout<<"File "<<filename<<" open error!"<<endl;
         return false;
-	}
-
-    //打开写文件
-	if(source_program_after_pre_processor_filename)
+    }
+    read_buf_.clear();
+    if(fstat(fileno(file),&file_stat)==0 && file_stat.st_size>0)
     {
-        source_program_after_pre_proces_.open(source_program_after_pre_processor_filename,ios::out);
-        if(!source_program_after_pre_proces_)
-        {
-            cout<<"File "<<source_program_after_pre_processor_filename<<" open error!"<<endl;
-            source_program_.close();
-            return false;
-        }
+        read_buf_.reserve(file_stat.st_size+1);
+    }
+    while((read_length=fread(buf,1,READ_BUF_SIZE,file))>0)
+    {
+        read_buf_.append(buf,read_length);
+    }
+    fclose(file);
+    //最后一行没有换行符的时候补上一个
+    if(!read_buf_.empty() && !is_line_feed(read_buf_.back()))
+    {
+        read_buf_.push_back('\n');
     }
 
-    //获取下一个字符，进行注释的删除
-    while((ch1=read_char())!=EOF)
+    result.clear();
+    result.reserve(read_buf_.size());
+    p=read_buf_.data();
+    end=p+read_buf_.size();
+    while(p<end)
     {
         if(singleline_comment)
         {
-            //如果此时已经在单行注释里了
-            switch(ch1)
+            //单行注释中只输出换行符，换行符之前是反斜杠的时候注释延续到下一行
+            while(p<end && !is_line_feed(*p))
+            {
+                p++;
+            }
+            if(p<end)
+            {
+                result.push_back(*p);
+                singleline_comment=is_backslash(*(p-1));
+                p++;
+            }
+        }
+        else if(multiline_comment)
+        {
+            //多行注释中只输出换行符
+            while(p<end && !(*p=='*' && p+1<end && *(p+1)=='/'))
+            {
+                if(is_line_feed(*p))
+                {
+                    result.push_back(*p);
+                }
+                p++;
+            }
+            if(p<end)
+            {
+                multiline_comment=false;
+                p+=2;
+            }
+        }
+        else
+        {
+            //引号中只有反斜杠和引号需要处理，引号外还需要处理注释的开始
+            start=p;
+            if(double_quotation_mark || single_quotation_mark)
+            {
+                while(p<end && !is_backslash(*p) && !is_double_quotation(*p) && !is_single_quotation(*p))
+                {
+                    p++;
+                }
+            }
+            else
+            {
+                while(p<end && *p!='/' && !is_backslash(*p) && !is_double_quotation(*p) && !is_single_quotation(*p))
+                {
+                    p++;
+                }
+            }
+            result.append(start,p-start);
+            if(p>=end)
             {
-                case '\n':
-                    write_char(ch1);
-                    singleline_comment=false;
+                break;
+            }
+            switch(*p)
+            {
+                case '/':
+                    if(p+1<end && *(p+1)=='/')
+                    {
+                        singleline_comment=true;
+                        p+=2;
+                    }
+                    else if(p+1<end && *(p+1)=='*')
+                    {
+                        multiline_comment=true;
+                        p+=2;
+                    }
+                    else
+                    {
+                        result.push_back(*p);
+                        p++;
+                    }
                     break;
                 case '\\':
-                    ch2=read_char();
-                    if(ch2=='\n')
+                    //反斜杠加换行符是续行，两个字符都删除，否则反斜杠和后面的字符原样输出
+                    if(p+1>=end)
                     {
-                        write_char(ch2);
+                        result.push_back(*p);
+                        p++;
                     }
-                    else if(ch2==EOF)
+                    else if(is_line_feed(*(p+1)))
                     {
-                        goto out;
+                        p+=2;
                     }
                     else
                     {
-                        singleline_comment=false;
+                        result.append(p,2);
+                        p+=2;
                     }
                     break;
-                case EOF:
-                    goto out;
-                default:
-                    break;
-            }
-        }
-        else if(multiline_comment)
-        {
-            //如果此时已经在多行注释里了
-            switch(ch1)
-            {
-                case '\n':
-                    write_char(ch1);
-                    break;
-                case '*':
-                    ch2=read_char();
-                    if(ch2=='/')
+                case '\"':
+                    result.push_back(*p);
+                    if(!single_quotation_mark)
                     {
-                        multiline_comment=false;
+                        double_quotation_mark=!double_quotation_mark;
                     }
-                    else
+                    p++;
+                    break;
+                case '\'':
+                    result.push_back(*p);
+                    if(!double_quotation_mark)
                     {
-                        if(ch2=='\n')
-                        {
-                            write_char(ch2);
-                        }
-                        else if(ch2==EOF)
-                        {
-                            goto out;
-                        }
+                        single_quotation_mark=!single_quotation_mark;
                     }
+                    p++;
                     break;
-                case EOF:
-                    goto out;
                 default:
                     break;
             }
         }
-        else
+    }
+    return true;
+}
+
+/*
+读取一个头文件删除注释之后的内容
+头文件没有被修改过的时候直接使用缓存，否则读取之后放到缓存中
+
+Parameters
+----------
+filename:头文件名
+
+Return
+------
+头文件，读取失败的时候返回nullptr
+*/
+shared_ptr<const struct include_file> Pre_processor::load_include_file(const string & filename)
+{
+    struct stat file_stat;
+    shared_ptr<const struct include_file> res;
+    shared_ptr<struct include_file> file;
+
+    if(stat(filename.c_str(),&file_stat)!=0)
+    {
+        cout<<"File "<<filename<<" open error!"<<endl;
+        return nullptr;
+    }
+    if((res=Include_cache::find(filename,file_stat)))
+    {
+        Time_report::add_counter("include cache hits",1);
+        return res;
+    }
+    file=make_shared<struct include_file>();
+    file->mtime=file_stat.st_mtim;
+    file->size=file_stat.st_size;
+    file->is_macros_recorded=false;
+    if(!remove_comments(filename.c_str(),file->text))
+    {
+        return nullptr;
+    }
+    Include_cache::add(filename,file);
+    return file;
+}
+
+/*
+进行预处理
+主要是用于去除注释,以及进行简单的宏替换
+
+Parameters
+----------
+source_program_filename:源程序文件名
+source_program_after_pre_processor_filename:预处理之后的源程序名，如果是nullptr就不写文件，只保存在内存中
+
+Return
+------
+如果预处理成功返回true，否则返回false
+*/
+bool Pre_processor::pre_process(const char * source_program_filename,const char * source_program_after_pre_processor_filename)
+{
+    string source;
+
+    //删除注释
+    if(!remove_comments(source_program_filename,source))
+    {
+        return false;
+    }
+
+    //打开写文件
+	if(source_program_after_pre_processor_filename)
+    {
+        source_program_after_pre_proces_.open(source_program_after_pre_processor_filename,ios::out);
+        if(!source_program_after_pre_proces_)
         {
-            if(double_quotation_mark_ || single_quotation_mark_)
-            {
-                //如果此时在单引号或者双引号中
-                switch(ch1)
-                {
-                    case '\\':
-                        ch2=read_char();
-                        if(ch2==EOF)
-                        {
-                            write_char(ch1);
-                            goto out;
-                        }
-                        else if(ch2!='\n')
-                        {
-                            write_char(ch1);
-                            write_char(ch2);
-                        }
-                        break;
-                    case '\"':
-                        write_char(ch1);
-                        if(double_quotation_mark_)
-                        {
-                            double_quotation_mark_=false;
-                        }
-                        break;
-                    case '\'':
-                        write_char(ch1);
-                        if(single_quotation_mark_)
-                        {
-                            single_quotation_mark_=false;
-                        }
-                        break;
-                    case EOF:
-                        goto out;
-                    default:
-                        write_char(ch1);
-                        break;
-                }
-            }
-            else
-            {
-                //如果此时不在注释中
-                switch(ch1)
-                {
-                    case '/':
-                        ch2=read_char();
-                        if(ch2=='/')
-                        {
-                            singleline_comment=true;
-                        }
-                        else if(ch2=='*')
-                        {
-                            multiline_comment=true;
-                        }
-                        else if(ch2==EOF)
-                        {
-                            write_char(ch1);
-                            goto out;
-                        }
-                        else
-                        {
-                            write_char(ch1);
-                            write_char(ch2);
-                        }
-                        break;
-                    case '\"':
-                        double_quotation_mark_=true;
-                        write_char(ch1);
-                        break;
-                    case '\'':
-                        single_quotation_mark_=true;
-                        write_char(ch1);
-                        break;
-                    case '\\':
-                        ch2=read_char();
-                        if(ch2==EOF)
-                        {
-                            write_char(ch1);
-                            goto out;
-                        }
-                        else if(ch2!='\n')
-                        {
-                            write_char(ch1);
-                            write_char(ch2);
-                        }
-                        break;
-                    case EOF:
-                        goto out;
-                        break;
-                    default:
-                        write_char(ch1);
-                        break;
-                }
-            }
+            cout<<"File "<<source_program_after_pre_processor_filename<<" open error!"<<endl;
+            return false;
         }
     }
 
-out:
-    //检查写缓冲区，将里面的内容写入文件
-    write_buf_to_file();
+    //进行宏替换
+    source_program_filename_=source_program_filename;
+    current_line_=1;
+    include_depth_=0;
+    macro_expansion_num_=0;
+    macro_memo_hit_num_=0;
+    source_program_after_pre_process_.clear();
+    macro_replace(source);
+    Time_report::add_counter("macro expansions",macro_expansion_num_);
+    Time_report::add_counter("macro memo hits",macro_memo_hit_num_);
 
-    //关闭文件
-    source_program_.close();
+    //如果打开了预处理之后的文件，就写入文件
     if(source_program_after_pre_proces_.is_open())
     {
+        source_program_after_pre_proces_<<source_program_after_pre_process_;
         source_program_after_pre_proces_.close();
     }
     return true;
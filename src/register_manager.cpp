@@ -7,6 +7,7 @@
  *
 */
 #include "register_manager.h"
+#include "time_report.h"
 
 /*
 构造函数
@@ -109,6 +110,7 @@ bool Register_manager::allocate_designated_reg(reg_index reg)
                 event_data->second=reg;
                 notify(event(event_type::PUSH_TEMP_VAR_FROM_REG_TO_STACK,(void *)event_data));
                 delete event_data;
+                Time_report::add_counter("spills",1);
             }
             else if(state==reg_state::DIRTY_VALUE)
             {
@@ -116,6 +118,7 @@ bool Register_manager::allocate_designated_reg(reg_index reg)
                 event_data=new pair<struct ic_data *,reg_index>(var,reg);
                 notify(event(event_type::STORE_VAR_TO_MEM,(void *)event_data));
                 delete event_data;
+                Time_report::add_counter("spills",1);
             }
             current_basic_block_info_.relieve_var_value_reg(var,reg);
         }
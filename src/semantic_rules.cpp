@@ -395,19 +395,111 @@ map<ic_op,ic_output> ic_outputs={
 /*================================================================================================================================================================*/
 /*================================================================================================================================================================*/
 
-//语法分析时的全局信息
-struct 
+//语法符号的名字和编号的对应表
+map<string,enum semantic_symbol> semantic_symbols={
+    semantic_symbols_entry(COMP_UNIT),
+    semantic_symbols_entry(DECL_or_FUNC_DEF),
+    semantic_symbols_entry(DECL),
+    semantic_symbols_entry(B_TYPE),
+    semantic_symbols_entry(CONST_DECL),
+    semantic_symbols_entry(one_or_more_CONST_DEF_divided_with_comma),
+    semantic_symbols_entry(CONST_DEF),
+    semantic_symbols_entry(zero_or_more_CONST_EXP_surrounded_by_bracket),
+    semantic_symbols_entry(CONST_INIT_VAL),
+    semantic_symbols_entry(zero_or_more_CONST_INIT_VAL_divided_with_comma),
+    semantic_symbols_entry(VAR_DECL),
+    semantic_symbols_entry(one_or_more_VAR_DEF_divided_with_comma),
+    semantic_symbols_entry(VAR_DEF),
+    semantic_symbols_entry(INIT_VAL),
+    semantic_symbols_entry(zero_or_more_INIT_VAL_divided_with_comma),
+    semantic_symbols_entry(FUNC_DEF),
+    semantic_symbols_entry(FUNC_F_PARAMS),
+    semantic_symbols_entry(one_or_more_FUNC_F_PARAM_divided_with_comma),
+    semantic_symbols_entry(FUNC_F_PARAM),
+    semantic_symbols_entry(zero_or_more_EXP_surrounded_by_bracket),
+    semantic_symbols_entry(BLOCK),
+    semantic_symbols_entry(zero_or_more_BLOCK_ITEM),
+    semantic_symbols_entry(BLOCK_ITEM),
+    semantic_symbols_entry(STMT),
+    semantic_symbols_entry(JMP_STMT),
+    semantic_symbols_entry(WHILE_STMT),
+    semantic_symbols_entry(IF_STMT),
+    semantic_symbols_entry(EXP),
+    semantic_symbols_entry(COND),
+    semantic_symbols_entry(L_VAL),
+    semantic_symbols_entry(PRIMARY_EXP),
+    semantic_symbols_entry(NUMBER),
+    semantic_symbols_entry(UNARY_EXP),
+    semantic_symbols_entry(UNARY_OP),
+    semantic_symbols_entry(FUNC_R_PARAMS),
+    semantic_symbols_entry(MUL_EXP),
+    semantic_symbols_entry(ADD_EXP),
+    semantic_symbols_entry(REL_EXP),
+    semantic_symbols_entry(EQ_EXP),
+    semantic_symbols_entry(L_AND_EXP),
+    semantic_symbols_entry(L_OR_EXP),
+    semantic_symbols_entry(CONST_EXP),
+    semantic_symbols_entry(id),
+    semantic_symbols_entry(const_int),
+    semantic_symbols_entry(const_float),
+    semantic_symbols_entry(while),
+    semantic_symbols_entry(else),
+};
+
+/*
+记录某一个语法符号在语义栈中的位置距离栈顶的偏移量（只有语义动作中会用到的语法符号才需要记录）
+语法变量都应该在语法符号表中，否则语义动作无法访问它，这种情况直接报错；终结符和新建的语法变量(以__开头)不需要记录
+
+Parameters
+----------
+descriptor:要填写的语义动作的描述
+syntax_symbol_string:语法符号的名字
+offset:偏移量
+terminators:文法的终结符字典
+*/
+static void add_syntax_symbol_offset(struct semantic_rule_descriptor * descriptor,const string & syntax_symbol_string,stack_index offset,const map<string,int> & terminators)
 {
-    enum language_data_type data_type;
-} global_info;
+    map<string,enum semantic_symbol>::iterator symbol=semantic_symbols.find(syntax_symbol_string);
 
-//每一个语义动作规约完成之前和之后，栈顶的指针的差值+1（规约前栈顶指针减去规约后栈顶指针+1）
-map<string,stack_index> stack_top_offset_between_before_and_after_reduce_map;
+    if(symbol!=semantic_symbols.end())
+    {
+        descriptor->syntax_symbol_offsets_from_stack_top[(size_t)symbol->second].push_back(offset);
+    }
+    else if(terminators.find(syntax_symbol_string)==terminators.end() && syntax_symbol_string.compare(0,2,"__")!=0)
+    {
+        cout<<"Error: Syntax symbol "<<syntax_symbol_string<<" is not in semantic_symbols, semantic rules can not access it!"<<endl;
+    }
+}
 
-//每一个语义动作用到的语法符号和它们所在的语义栈中的位置距离栈顶的偏移量
-//该map的键是语义动作的名称
-//值是另一个map，这个map的键是该语义动作可能会用到的语义符号的名称，值是这个语义符号距离栈顶的偏移量
-map<string,map<string,vector<int> > > syntax_symbol_offset_from_stack_top_map;
+/*
+注册语义动作，计算该语义动作用到的语法符号在语义栈中的位置距离栈顶的偏移量
+
+Parameters
+----------
+descriptor:要填写的语义动作的描述
+left_string:产生式的左部
+right_string:产生式的右部（在该语义动作之前的部分，不包括空符号）
+right_next_string:如果该语义动作位于产生式的中间，那么就是紧跟在该语义动作之后的语法符号，否则为空
+terminators:文法的终结符字典
+*/
+void register_semantic_rule(struct semantic_rule_descriptor * descriptor,const string & left_string,const vector<string> & right_string,const string & right_next_string,const map<string,int> & terminators)
+{
+    if(right_next_string=="")
+    {
+        add_syntax_symbol_offset(descriptor,left_string,right_string.size(),terminators);
+        descriptor->stack_top_offset_between_before_and_after_reduce=right_string.size();
+    }
+    else
+    {
+        add_syntax_symbol_offset(descriptor,left_string,right_string.size()+1,terminators);
+        add_syntax_symbol_offset(descriptor,right_next_string,0,terminators);
+        descriptor->stack_top_offset_between_before_and_after_reduce=0;
+    }
+    for(vector<string>::const_iterator i=right_string.begin();i!=right_string.end();i++)
+    {
+        add_syntax_symbol_offset(descriptor,*i,right_string.end()-i,terminators);
+    }
+}
 
 //ic_data的数据类型转换
 #define ic_data_type_conversion(value,to_data_type) \
@@ -440,14 +532,14 @@ Parameters
 ----------
 op:操作符
 arg:操作数
+symbol_table:符号表
 
 Return
 ------
 返回计算结果
 */
-struct ic_data * unary_compute(ic_op op,struct ic_data * arg)
+struct ic_data * unary_compute(ic_op op,struct ic_data * arg,Symbol_table * symbol_table)
 {
-    Symbol_table * symbol_table=Symbol_table::get_instance();
     struct ic_data * res=nullptr;
     OAA value;
     enum language_data_type data_type;
@@ -505,17 +597,17 @@ Parameters
 op:操作符
 arg1:操作数1
 arg2:操作数2
+symbol_table:符号表
 
 Return
 ------
 返回计算结果
 */
-struct ic_data * binary_compute(ic_op op,struct ic_data * arg1,struct ic_data * arg2)
+struct ic_data * binary_compute(ic_op op,struct ic_data * arg1,struct ic_data * arg2,Symbol_table * symbol_table)
 {
     struct ic_data * res=nullptr;
     enum language_data_type arg1_data_type,arg2_data_type;
     OAA arg1_value,arg2_value;
-    Symbol_table * symbol_table=Symbol_table::get_instance();
     if(!arg1->is_const() || !arg2->is_const())
     {
         return res;
@@ -826,7 +918,7 @@ define_semantic_rule(semantic_rule_name)\
     }\
     if(is_result_const)\
     {\
-        set_syntax_symbol_attribute_by_index(arg1_semantic_symbol,value,pointer,0,binary_compute(op,arg1,arg2));\
+        set_syntax_symbol_attribute_by_index(arg1_semantic_symbol,value,pointer,0,binary_compute(op,arg1,arg2,symbol_table));\
     }\
     else\
     {\
@@ -1016,10 +1108,9 @@ long const_assign_var_to_array_member(struct ic_data * single_value,vector<OAA>
     return push_times;
 }
 
-long const_array_init_assignment(vector<OAA> * init_value,stack<list<pair<bool,void * > > * > & init_values_stack,stack<size_t> & dimensions_len_stack,list<struct ic_data * > * dimensions_len,list<struct ic_data * >::iterator & dimensions_len_pointer,enum language_data_type array_data_type)
+long const_array_init_assignment(vector<OAA> * init_value,stack<list<pair<bool,void * > > * > & init_values_stack,stack<size_t> & dimensions_len_stack,list<struct ic_data * > * dimensions_len,list<struct ic_data * >::iterator & dimensions_len_pointer,enum language_data_type array_data_type,Symbol_table * symbol_table)
 {
     long push_times=0;
-    Symbol_table * symbol_table=Symbol_table::get_instance();
     if(init_values_stack.empty() || init_values_stack.top()->size()==0 || (init_values_stack.top()->front().first==false && init_values_stack.top()->front().second==nullptr))
     {
         if(!init_values_stack.empty() && !init_values_stack.top()->size()==0 && (init_values_stack.top()->front().first==false && init_values_stack.top()->front().second==nullptr))
@@ -1067,7 +1158,7 @@ long const_array_init_assignment(vector<OAA> * init_value,stack<list<pair<bool,v
                     dimensions_len_stack.push((*dimensions_len_pointer)->get_value().int_data);
                     dimensions_len_pointer++;
                     push_times++;
-                    push_times+=const_array_init_assignment(init_value,init_values_stack,dimensions_len_stack,dimensions_len,dimensions_len_pointer,array_data_type);
+                    push_times+=const_array_init_assignment(init_value,init_values_stack,dimensions_len_stack,dimensions_len,dimensions_len_pointer,array_data_type,symbol_table);
                 }
                 else
                 {
@@ -1122,7 +1213,7 @@ define_semantic_rule(___CONST_DEF___)
             dimensions_len_stack.push(1);
             array_assignment=(list<pair<bool,void * > > *)get_syntax_symbol_attribute(CONST_INIT_VAL,const_init_values,pointer);
             init_values_stack.push(array_assignment);
-            const_array_init_assignment(array_init_value,init_values_stack,dimensions_len_stack,dimensions_len,dimensions_len_pointer,get_global_info(data_type));
+            const_array_init_assignment(array_init_value,init_values_stack,dimensions_len_stack,dimensions_len,dimensions_len_pointer,get_global_info(data_type),symbol_table);
             delete_const_array_assignment(array_assignment);
             const_var=def_const_array((*(string *)get_syntax_symbol_attribute(id,id_string,pointer)),get_global_info(data_type),dimensions_len,array_init_value);
         }
@@ -1401,10 +1492,9 @@ define_semantic_rule(___VAR_DEF_1___)
     set_syntax_symbol_attribute(VAR_DEF,var_def,pointer,ic_data);
 end_define_semantic_rule
 
-struct ic_data * get_first_in_depth_first(list<pair<bool,void * > > * tree,enum language_data_type array_data_type)
+struct ic_data * get_first_in_depth_first(list<pair<bool,void * > > * tree,enum language_data_type array_data_type,Symbol_table * symbol_table)
 {
     struct ic_data * res;
-    Symbol_table * symbol_table=Symbol_table::get_instance();
     if(tree==nullptr)
     {
         res=def_const(array_data_type,0);
@@ -1415,12 +1505,12 @@ struct ic_data * get_first_in_depth_first(list<pair<bool,void * > > * tree,enum
     }
     else
     {
-        res=get_first_in_depth_first((list<pair<bool,void * > > *)(tree->front().second),array_data_type);
+        res=get_first_in_depth_first((list<pair<bool,void * > > *)(tree->front().second),array_data_type,symbol_table);
     }
     return res;
 }
 
-long assign_array_to_array_member(list<pair<bool,void * > > * array,vector<struct ic_data * > * init_value,stack<size_t> & dimensions_len_stack,list<struct ic_data * > * dimensions_len,list<struct ic_data * >::iterator & dimensions_len_pointer,enum language_data_type array_data_type)
+long assign_array_to_array_member(list<pair<bool,void * > > * array,vector<struct ic_data * > * init_value,stack<size_t> & dimensions_len_stack,list<struct ic_data * > * dimensions_len,list<struct ic_data * >::iterator & dimensions_len_pointer,enum language_data_type array_data_type,Symbol_table * symbol_table)
 {
     long push_times=0;
     if(dimensions_len_stack.empty())
@@ -1433,7 +1523,7 @@ long assign_array_to_array_member(list<pair<bool,void * > > * array,vector<struc
         dimensions_len_pointer++;
         push_times++;
     }
-    init_value->push_back(get_first_in_depth_first(array,array_data_type));
+    init_value->push_back(get_first_in_depth_first(array,array_data_type,symbol_table));
     dimensions_len_stack.top()--;
     while(dimensions_len_stack.top()==0)
     {
@@ -1478,10 +1568,9 @@ long assign_var_to_array_member(struct ic_data * single_value,vector<struct ic_d
     return push_times;
 }
 
-long array_init_assignment(vector<struct ic_data * > * init_value,stack<list<pair<bool,void * > > * > & init_values_stack,stack<size_t> & dimensions_len_stack,list<struct ic_data * > * dimensions_len,list<struct ic_data * >::iterator & dimensions_len_pointer,enum language_data_type array_data_type)
+long array_init_assignment(vector<struct ic_data * > * init_value,stack<list<pair<bool,void * > > * > & init_values_stack,stack<size_t> & dimensions_len_stack,list<struct ic_data * > * dimensions_len,list<struct ic_data * >::iterator & dimensions_len_pointer,enum language_data_type array_data_type,Symbol_table * symbol_table)
 {
     long push_times=0;
-    Symbol_table * symbol_table=Symbol_table::get_instance();
     if(init_values_stack.empty() || init_values_stack.top()->size()==0 || (init_values_stack.top()->front().first==false && init_values_stack.top()->front().second==nullptr))
     {
         if(!init_values_stack.empty() && !init_values_stack.top()->size()==0 && (init_values_stack.top()->front().first==false && init_values_stack.top()->front().second==nullptr))
@@ -1507,7 +1596,7 @@ long array_init_assignment(vector<struct ic_data * > * init_value,stack<list<pai
             }
             else
             {
-                push_times+=assign_array_to_array_member((list<pair<bool,void * > > *)(init_values_stack.top()->front().second),init_value,dimensions_len_stack,dimensions_len,dimensions_len_pointer,array_data_type);
+                push_times+=assign_array_to_array_member((list<pair<bool,void * > > *)(init_values_stack.top()->front().second),init_value,dimensions_len_stack,dimensions_len,dimensions_len_pointer,array_data_type,symbol_table);
             }
             init_values_stack.top()->pop_front();
         }
@@ -1529,11 +1618,11 @@ long array_init_assignment(vector<struct ic_data * > * init_value,stack<list<pai
                     dimensions_len_stack.push((*dimensions_len_pointer)->get_value().int_data);
                     dimensions_len_pointer++;
                     push_times++;
-                    push_times+=array_init_assignment(init_value,init_values_stack,dimensions_len_stack,dimensions_len,dimensions_len_pointer,array_data_type);
+                    push_times+=array_init_assignment(init_value,init_values_stack,dimensions_len_stack,dimensions_len,dimensions_len_pointer,array_data_type,symbol_table);
                 }
                 else
                 {
-                    push_times+=assign_array_to_array_member((list<pair<bool,void * > > * )(init_values_stack.top()->front().second),init_value,dimensions_len_stack,dimensions_len,dimensions_len_pointer,array_data_type);
+                    push_times+=assign_array_to_array_member((list<pair<bool,void * > > * )(init_values_stack.top()->front().second),init_value,dimensions_len_stack,dimensions_len,dimensions_len_pointer,array_data_type,symbol_table);
                 }
             }
             init_values_stack.top()->pop_front();
@@ -1584,7 +1673,7 @@ define_semantic_rule(___VAR_DEF_2___)
             dimensions_len_stack.push(1);
             array_assignment=(list<pair<bool,void * > > *)get_syntax_symbol_attribute(INIT_VAL,init_values,pointer);
             init_values_stack.push(array_assignment);
-            array_init_assignment(array_init_value,init_values_stack,dimensions_len_stack,dimensions_len,dimensions_len_pointer,get_global_info(data_type));
+            array_init_assignment(array_init_value,init_values_stack,dimensions_len_stack,dimensions_len,dimensions_len_pointer,get_global_info(data_type),symbol_table);
             delete_array_assignment(array_assignment);
             ic_data=def_array_with_init_value((*(string *)get_syntax_symbol_attribute(id,id_string,pointer)),get_global_info(data_type),dimensions_len,array_init_value);
         }
@@ -2619,7 +2708,7 @@ define_semantic_rule(___UNARY_EXP_4___)
         else
         {
             //结果是一个常数
-            set_syntax_symbol_attribute_by_index(UNARY_EXP,value,pointer,0,(void *)unary_compute(ic_op(get_syntax_symbol_attribute(UNARY_OP,unary_op,int)),arg));
+            set_syntax_symbol_attribute_by_index(UNARY_EXP,value,pointer,0,(void *)unary_compute(ic_op(get_syntax_symbol_attribute(UNARY_OP,unary_op,int)),arg,symbol_table));
         }
     }
 end_define_semantic_rule
@@ -3013,115 +3102,6 @@ end_define_semantic_rule
 
 
 
-//语义动作注册函数表
-map<string,semantic_rule_register> semantic_rule_registers={
-    semantic_rule_registers_entry(___COMP_UNIT_1___),
-    semantic_rule_registers_entry(___COMP_UNIT_2___),
-    semantic_rule_registers_entry(___DECL_or_FUNC_DEF_1___),
-    semantic_rule_registers_entry(___DECL_or_FUNC_DEF_2___),
-    semantic_rule_registers_entry(___DECL_1___),
-    semantic_rule_registers_entry(___DECL_2___),
-    semantic_rule_registers_entry(___B_TYPE_1___),
-    semantic_rule_registers_entry(___B_TYPE_2___),
-    semantic_rule_registers_entry(___CONST_DECL___),
-    semantic_rule_registers_entry(___one_or_more_CONST_DEF_divided_with_comma_1___),
-    semantic_rule_registers_entry(___one_or_more_CONST_DEF_divided_with_comma_2___),
-    semantic_rule_registers_entry(___CONST_DEF___),
-    semantic_rule_registers_entry(___zero_or_more_CONST_EXP_surrounded_by_bracket_1___),
-    semantic_rule_registers_entry(___zero_or_more_CONST_EXP_surrounded_by_bracket_2___),
-    semantic_rule_registers_entry(___CONST_INIT_VAL_1___),
-    semantic_rule_registers_entry(___CONST_INIT_VAL_2___),
-    semantic_rule_registers_entry(___zero_or_more_CONST_INIT_VAL_divided_with_comma_1___),
-    semantic_rule_registers_entry(___zero_or_more_CONST_INIT_VAL_divided_with_comma_2___),
-    semantic_rule_registers_entry(___zero_or_more_CONST_INIT_VAL_divided_with_comma_3___),
-    semantic_rule_registers_entry(___VAR_DECL___),
-    semantic_rule_registers_entry(___one_or_more_VAR_DEF_divided_with_comma_1___),
-    semantic_rule_registers_entry(___one_or_more_VAR_DEF_divided_with_comma_2___),
-    semantic_rule_registers_entry(___VAR_DEF_1___),
-    semantic_rule_registers_entry(___VAR_DEF_2___),
-    semantic_rule_registers_entry(___INIT_VAL_1___),
-    semantic_rule_registers_entry(___INIT_VAL_2___),
-    semantic_rule_registers_entry(___zero_or_more_INIT_VAL_divided_with_comma_1___),
-    semantic_rule_registers_entry(___zero_or_more_INIT_VAL_divided_with_comma_2___),
-    semantic_rule_registers_entry(___zero_or_more_INIT_VAL_divided_with_comma_3___),
-    semantic_rule_registers_entry(___FUNC_F_PARAMS___),
-    semantic_rule_registers_entry(___one_or_more_FUNC_F_PARAM_divided_with_comma_1___),
-    semantic_rule_registers_entry(___one_or_more_FUNC_F_PARAM_divided_with_comma_2___),
-    semantic_rule_registers_entry(___FUNC_F_PARAM_1___),
-    semantic_rule_registers_entry(___FUNC_F_PARAM_2___),
-    semantic_rule_registers_entry(___zero_or_more_EXP_surrounded_by_bracket_1___),
-    semantic_rule_registers_entry(___zero_or_more_EXP_surrounded_by_bracket_2___),
-    semantic_rule_registers_entry(___FUNC_DEF_1___),
-    semantic_rule_registers_entry(___FUNC_DEF_2___),
-    semantic_rule_registers_entry(___FUNC_DEF_3___),
-    semantic_rule_registers_entry(___FUNC_DEF_4___),
-    semantic_rule_registers_entry(___FUNC_DEF_5___),
-    semantic_rule_registers_entry(___FUNC_DEF_6___),
-    semantic_rule_registers_entry(___FUNC_DEF_7___),
-    semantic_rule_registers_entry(___FUNC_DEF_8___),
-    semantic_rule_registers_entry(___BLOCK_1___),
-    semantic_rule_registers_entry(___BLOCK_2___),
-    semantic_rule_registers_entry(___zero_or_more_BLOCK_ITEM_1___),
-    semantic_rule_registers_entry(___zero_or_more_BLOCK_ITEM_2___),
-    semantic_rule_registers_entry(___BLOCK_ITEM_1___),
-    semantic_rule_registers_entry(___BLOCK_ITEM_2___),
-    semantic_rule_registers_entry(___STMT_1___),
-    semantic_rule_registers_entry(___STMT_2___),
-    semantic_rule_registers_entry(___STMT_3___),
-    semantic_rule_registers_entry(___STMT_4___),
-    semantic_rule_registers_entry(___STMT_5___),
-    semantic_rule_registers_entry(___STMT_6___),
-    semantic_rule_registers_entry(___STMT_7___),
-    semantic_rule_registers_entry(___JMP_STMT_1___),
-    semantic_rule_registers_entry(___JMP_STMT_2___),
-    semantic_rule_registers_entry(___JMP_STMT_3___),
-    semantic_rule_registers_entry(___JMP_STMT_4___),
-    semantic_rule_registers_entry(___WHILE_STMT_1___),
-    semantic_rule_registers_entry(___WHILE_STMT_2___),
-    semantic_rule_registers_entry(___IF_STMT_1___),
-    semantic_rule_registers_entry(___IF_STMT_2___),
-    semantic_rule_registers_entry(___IF_STMT_3___),
-    semantic_rule_registers_entry(___EXP___),
-    semantic_rule_registers_entry(___COND___),
-    semantic_rule_registers_entry(___L_VAL___),
-    semantic_rule_registers_entry(___PRIMARY_EXP_1___),
-    semantic_rule_registers_entry(___PRIMARY_EXP_2___),
-    semantic_rule_registers_entry(___PRIMARY_EXP_3___),
-    semantic_rule_registers_entry(___NUMBER_1___),
-    semantic_rule_registers_entry(___NUMBER_2___),
-    semantic_rule_registers_entry(___UNARY_EXP_1___),
-    semantic_rule_registers_entry(___UNARY_EXP_2___),
-    semantic_rule_registers_entry(___UNARY_EXP_3___),
-    semantic_rule_registers_entry(___UNARY_EXP_4___),
-    semantic_rule_registers_entry(___UNARY_OP_1___),
-    semantic_rule_registers_entry(___UNARY_OP_2___),
-    semantic_rule_registers_entry(___UNARY_OP_3___),
-    semantic_rule_registers_entry(___FUNC_R_PARAMS_1___),
-    semantic_rule_registers_entry(___FUNC_R_PARAMS_2___),
-    semantic_rule_registers_entry(___MUL_EXP_1___),
-    semantic_rule_registers_entry(___MUL_EXP_2___),
-    semantic_rule_registers_entry(___MUL_EXP_3___),
-    semantic_rule_registers_entry(___MUL_EXP_4___),
-    semantic_rule_registers_entry(___ADD_EXP_1___),
-    semantic_rule_registers_entry(___ADD_EXP_2___),
-    semantic_rule_registers_entry(___ADD_EXP_3___),
-    semantic_rule_registers_entry(___REL_EXP_1___),
-    semantic_rule_registers_entry(___REL_EXP_2___),
-    semantic_rule_registers_entry(___REL_EXP_3___),
-    semantic_rule_registers_entry(___REL_EXP_4___),
-    semantic_rule_registers_entry(___REL_EXP_5___),
-    semantic_rule_registers_entry(___EQ_EXP_1___),
-    semantic_rule_registers_entry(___EQ_EXP_2___),
-    semantic_rule_registers_entry(___EQ_EXP_3___),
-    semantic_rule_registers_entry(___L_AND_EXP_1___),
-    semantic_rule_registers_entry(___L_AND_EXP_2___),
-    semantic_rule_registers_entry(___L_AND_EXP_3___),
-    semantic_rule_registers_entry(___L_OR_EXP_1___),
-    semantic_rule_registers_entry(___L_OR_EXP_2___),
-    semantic_rule_registers_entry(___L_OR_EXP_3___),
-    semantic_rule_registers_entry(___CONST_EXP___),
-};
-
 //语义动作函数表
 map<string,semantic_rule> semantic_rules={
     semantic_rules_entry(___COMP_UNIT_1___),
@@ -13,84 +13,58 @@
 
 using namespace std;
 
-//单例对象
-Symbol_table * Symbol_table::instance_=nullptr;
-
 /*
-Symbol_table的私有构造函数
+Symbol_table的构造函数
 */
 Symbol_table::Symbol_table():tmp_vars_num_(0),labels_num_(0),current_scope_(nullptr),current_func_(nullptr)
 {
     list<struct ic_data * > * dimensions_len;
-    //把库中的函数进行定义
+    //把库中的函数进行定义(形参名都是字符串常量，不需要复制)
     //int getint()
-    functions_.insert(make_pair("getint",new struct ic_func("getint",language_data_type::INT,(size_t)0)));
+    functions_.insert(make_pair("getint",arena_.create<struct ic_func>("getint",language_data_type::INT,arena_.create<list<struct ic_data * > >(),(size_t)0)));
     //int getch()
-    functions_.insert(make_pair("getch",new struct ic_func("getch",language_data_type::INT,(size_t)0)));
+    functions_.insert(make_pair("getch",arena_.create<struct ic_func>("getch",language_data_type::INT,arena_.create<list<struct ic_data * > >(),(size_t)0)));
     //int getarray(int a[])
-    dimensions_len=new list<struct ic_data * >;
+    dimensions_len=arena_.create<list<struct ic_data * > >();
     dimensions_len->push_back(const_entry(language_data_type::INT,OAA((int)0)));
-    functions_.insert(make_pair("getarray",new struct ic_func("getarray",language_data_type::INT,(size_t)1,new struct ic_data("a",language_data_type::INT,dimensions_len,false))));
+    functions_.insert(make_pair("getarray",arena_.create<struct ic_func>("getarray",language_data_type::INT,arena_.create<list<struct ic_data * > >(),(size_t)1,arena_.create<struct ic_data>("a",language_data_type::INT,dimensions_len,false))));
     //int getfarray(float a[])
-    dimensions_len=new list<struct ic_data * >;
+    dimensions_len=arena_.create<list<struct ic_data * > >();
     dimensions_len->push_back(const_entry(language_data_type::INT,OAA((int)0)));
-    functions_.insert(make_pair("getfarray",new struct ic_func("getfarray",language_data_type::INT,(size_t)1,new struct ic_data("a",language_data_type::FLOAT,dimensions_len,false))));
+    functions_.insert(make_pair("getfarray",arena_.create<struct ic_func>("getfarray",language_data_type::INT,arena_.create<list<struct ic_data * > >(),(size_t)1,arena_.create<struct ic_data>("a",language_data_type::FLOAT,dimensions_len,false))));
     //float getfloat()
-    functions_.insert(make_pair("getfloat",new struct ic_func("getfloat",language_data_type::FLOAT,(size_t)0)));
+    functions_.insert(make_pair("getfloat",arena_.create<struct ic_func>("getfloat",language_data_type::FLOAT,arena_.create<list<struct ic_data * > >(),(size_t)0)));
     //void putint(int a)
-    functions_.insert(make_pair("putint",new struct ic_func("putint",language_data_type::VOID,(size_t)1,new struct ic_data("a",language_data_type::INT,nullptr,false))));
+    functions_.insert(make_pair("putint",arena_.create<struct ic_func>("putint",language_data_type::VOID,arena_.create<list<struct ic_data * > >(),(size_t)1,arena_.create<struct ic_data>("a",language_data_type::INT,nullptr,false))));
     //void putch(int a)
-    functions_.insert(make_pair("putch",new struct ic_func("putch",language_data_type::VOID,(size_t)1,new struct ic_data("a",language_data_type::INT,nullptr,false))));
+    functions_.insert(make_pair("putch",arena_.create<struct ic_func>("putch",language_data_type::VOID,arena_.create<list<struct ic_data * > >(),(size_t)1,arena_.create<struct ic_data>("a",language_data_type::INT,nullptr,false))));
     //void putarray(int n,int a[])
-    dimensions_len=new list<struct ic_data * >;
+    dimensions_len=arena_.create<list<struct ic_data * > >();
     dimensions_len->push_back(const_entry(language_data_type::INT,OAA((int)0)));
-    functions_.insert(make_pair("putarray",new struct ic_func("putarray",language_data_type::VOID,(size_t)2,new struct ic_data("n",language_data_type::INT,nullptr,false),new struct ic_data("a",language_data_type::INT,dimensions_len,false))));
+    functions_.insert(make_pair("putarray",arena_.create<struct ic_func>("putarray",language_data_type::VOID,arena_.create<list<struct ic_data * > >(),(size_t)2,arena_.create<struct ic_data>("n",language_data_type::INT,nullptr,false),arena_.create<struct ic_data>("a",language_data_type::INT,dimensions_len,false))));
     //void putfloat()
-    functions_.insert(make_pair("putfloat",new struct ic_func("putfloat",language_data_type::VOID,(size_t)0)));
+    functions_.insert(make_pair("putfloat",arena_.create<struct ic_func>("putfloat",language_data_type::VOID,arena_.create<list<struct ic_data * > >(),(size_t)0)));
     //void putfarray(int n,float a[])
-    dimensions_len=new list<struct ic_data * >;
+    dimensions_len=arena_.create<list<struct ic_data * > >();
     dimensions_len->push_back(const_entry(language_data_type::INT,OAA((int)0)));
-    functions_.insert(make_pair("putfarray",new struct ic_func("putfarray",language_data_type::VOID,(size_t)2,new struct ic_data("n",language_data_type::INT,nullptr,false),new struct ic_data("a",language_data_type::FLOAT,dimensions_len,false))));
+    functions_.insert(make_pair("putfarray",arena_.create<struct ic_func>("putfarray",language_data_type::VOID,arena_.create<list<struct ic_data * > >(),(size_t)2,arena_.create<struct ic_data>("n",language_data_type::INT,nullptr,false),arena_.create<struct ic_data>("a",language_data_type::FLOAT,dimensions_len,false))));
     //void _sysy_starttime(int lineno)
-    functions_.insert(make_pair("_sysy_starttime",new struct ic_func("_sysy_starttime",language_data_type::VOID,(size_t)1,new struct ic_data("lineno",language_data_type::INT,nullptr,false))));
+    functions_.insert(make_pair("_sysy_starttime",arena_.create<struct ic_func>("_sysy_starttime",language_data_type::VOID,arena_.create<list<struct ic_data * > >(),(size_t)1,arena_.create<struct ic_data>("lineno",language_data_type::INT,nullptr,false))));
     //void _sysy_stoptime(int lineno)
-    functions_.insert(make_pair("_sysy_stoptime",new struct ic_func("_sysy_stoptime",language_data_type::VOID,(size_t)1,new struct ic_data("lineno",language_data_type::INT,nullptr,false))));
+    functions_.insert(make_pair("_sysy_stoptime",arena_.create<struct ic_func>("_sysy_stoptime",language_data_type::VOID,arena_.create<list<struct ic_data * > >(),(size_t)1,arena_.create<struct ic_data>("lineno",language_data_type::INT,nullptr,false))));
     //开始一个全局作用域
     start_scope();
 }
 
 /*
-Symbol_table的私有析构函数
+Symbol_table的析构函数
+所有的表项都在分配器中，分配器销毁的时候一起释放
 */
 Symbol_table::~Symbol_table()
 {
     
 }
 
-/*
-获取Symbol_table单例类的方法
-*/
-Symbol_table * Symbol_table::get_instance()
-{
-    if(instance_==nullptr)
-    {
-        instance_=new Symbol_table();
-    }
-    return instance_;
-}
-
-/*
-销毁Symbol_table单例类的方法
-*/
-void Symbol_table::delete_instance()
-{
-    if(instance_!=nullptr)
-    {
-        delete instance_;
-        instance_=nullptr;
-    }
-}
-
 /*
 获取符号表中的某一变量表项的指针
 
@@ -152,10 +126,11 @@ Return
 */
 struct ic_data * Symbol_table::const_entry(enum language_data_type data_type,OAA data_value)
 {
+    lock_guard<mutex> lock(entries_mutex_);
     map<OAA,struct ic_data * > & designated_data_type_consts=consts_[data_type];
     if(designated_data_type_consts.find(data_value)==designated_data_type_consts.end())
     {
-        designated_data_type_consts.insert(make_pair(data_value,new struct ic_data(data_type,data_value)));
+        designated_data_type_consts.insert(make_pair(data_value,arena_.create<struct ic_data>(data_type,data_value)));
     }
     return designated_data_type_consts[data_value];
 }
@@ -181,10 +156,11 @@ struct ic_data * Symbol_table::array_member_entry(struct ic_data * array_var,siz
         return const_entry(array_var->get_data_type(),((vector<OAA> * )array_var->get_value().pointer_data)->at(offset->get_value().int_data));
     }
     //否则的话就只能使用数组取元素变量
+    lock_guard<mutex> lock(entries_mutex_);
     index=make_pair(array_var,make_pair(offset_dimension_lens,offset));
     if(array_members_.find(index)==array_members_.end())
     {
-        array_members_.insert(make_pair(index,new struct ic_data(array_var,offset_dimension_lens,offset)));
+        array_members_.insert(make_pair(index,arena_.create<struct ic_data>(array_var,offset_dimension_lens,offset,arena_)));
     }
     return array_members_.at(index);
 }
@@ -209,12 +185,32 @@ struct ic_data * Symbol_table::new_var(string name,enum language_data_type data_
     struct ic_data * res=nullptr;
     if(current_scope_)
     {
-        res=new struct ic_data(name,data_type,dimensions_len,const_or_init_value,is_const);
+        res=arena_.create<struct ic_data>(arena_.copy_string(name),data_type,dimensions_len,const_or_init_value,is_const);
         current_scope_->add_var(res);
     }
     return res;
 }
 
+/*
+新建一个函数形参
+形参在定义函数的时候才会加入函数的作用域，所以这里只是新建表项
+
+Parameters
+----------
+name:形参名
+data_type:形参类型
+dimensions_len:数组形参的各个维度的长度，如果是nullptr说明是基本变量形参
+is_const:是否是const形参
+
+Return
+------
+新建的形参
+*/
+struct ic_data * Symbol_table::new_f_param(string name,enum language_data_type data_type,list<struct ic_data * > * dimensions_len,bool is_const)
+{
+    return arena_.create<struct ic_data>(arena_.copy_string(name),data_type,dimensions_len,is_const);
+}
+
 /*
 往符号表中添加一个临时变量
 
@@ -224,7 +220,7 @@ Return
 */
 struct ic_data * Symbol_table::new_tmp_var(enum language_data_type data_type,list<struct ic_data * > * dimensions_len,OAA const_or_init_value,bool is_const)
 {
-    return new struct ic_data(tmp_vars_num_++,data_type,dimensions_len,const_or_init_value,is_const);
+    return arena_.create<struct ic_data>(tmp_vars_num_++,data_type,dimensions_len,const_or_init_value,is_const);
 }
 
 /*
@@ -236,7 +232,7 @@ Return
 */
 struct ic_label * Symbol_table::new_label()
 {
-    return new struct ic_label("."+to_string(labels_num_++));
+    return arena_.create<struct ic_label>("."+to_string(labels_num_++));
 }
 
 /*
@@ -260,7 +256,7 @@ struct ic_func * Symbol_table::new_func(string name,enum language_data_type retu
     {
         return nullptr;
     }
-    current_func_=new struct ic_func(name,return_type,f_params);
+    current_func_=arena_.create<struct ic_func>(name,return_type,f_params);
     functions_[name]=current_func_;
     return current_func_;
 }
@@ -289,17 +285,17 @@ void Symbol_table::start_scope()
     struct ic_scope * new_scope=nullptr;
     if(!current_scope_)
     {
-        new_scope=new struct ic_scope();
+        new_scope=arena_.create<struct ic_scope>();
     }
     else
     {
         if(current_scope_->is_global())
         {
-            new_scope=new struct ic_scope(current_scope_,current_func_);
+            new_scope=arena_.create<struct ic_scope>(current_scope_,current_func_);
         }
         else
         {
-            new_scope=new struct ic_scope(current_scope_);
+            new_scope=arena_.create<struct ic_scope>(current_scope_);
         }
     }
     current_scope_=new_scope;
@@ -8,6 +8,7 @@
 */
 
 #include "syntax_directed_translator.h"
+#include "time_report.h"
 #include<fstream>
 #include<sstream>
 
@@ -26,23 +27,52 @@ Syntax_directed_translator::Syntax_directed_translator()
 /*
 初始化
 */
-bool Syntax_directed_translator::init(const char * productions_filename,const char * parser_table_filename,list<struct token * > * tokens,bool print_warning)
+bool Syntax_directed_translator::init(const char * productions_filename,const char * parser_table_filename,struct token_stream * tokens,bool print_warning,enum parser_table_type table_type)
 {
-    //先调用父类LR1_parser的init函数
-    bool res=LR1_parser::init(productions_filename,parser_table_filename,tokens,print_warning);
+    //先调用父类LR1_parser的init函数，再进行自身的init
+    return init_semantic_stack(LR1_parser::init(productions_filename,parser_table_filename,tokens,print_warning,table_type));
+}
 
-    //再进行自身的init
-    if(res)
+/*
+初始化，语义翻译的时候从词法分析器中逐个获取token
+*/
+bool Syntax_directed_translator::init(const char * productions_filename,const char * parser_table_filename,Lexical_analyzer * lexical_analyzer,bool print_warning,enum parser_table_type table_type)
+{
+    return init_semantic_stack(LR1_parser::init(productions_filename,parser_table_filename,lexical_analyzer,print_warning,table_type));
+}
+
+/*
+初始化，和一个已经初始化好的翻译器共享文法和语法分析表(语义栈是每一个翻译器自己的)
+*/
+bool Syntax_directed_translator::init(const Syntax_directed_translator & prototype)
+{
+    return init_semantic_stack(LR1_parser::init(prototype));
+}
+
+/*
+在父类LR1_parser初始化之后初始化语义栈
+
+Parameters
+----------
+is_parser_init_success:父类LR1_parser是否初始化成功
+
+Return
+------
+初始化成功返回true，否则返回false
+*/
+bool Syntax_directed_translator::init_semantic_stack(bool is_parser_init_success)
+{
+    if(is_parser_init_success)
     {
         stack_top_=0;
-        semantic_stack_=new vector<map<string,union semantic_stack_node_member> >;
+        semantic_stack_=new vector<struct semantic_stack_node>;
     }
     else
     {
         semantic_stack_=nullptr;
     }
 
-    return res;
+    return is_parser_init_success;
 }
 
 /*
@@ -61,7 +91,7 @@ Syntax_directed_translator::~Syntax_directed_translator()
 */
 void Syntax_directed_translator::check_semantic_stack()
 {
-    map<string,union semantic_stack_node_member> empty;
+    struct semantic_stack_node empty;
     while(stack_top_ >= semantic_stack_->size())
     {
         semantic_stack_->push_back(empty);
@@ -75,10 +105,10 @@ Parameters
 ----------
 semantic_node:要插入的元素
 */
-void Syntax_directed_translator::push_semantic_stack(map<string,union semantic_stack_node_member> semantic_stack_node_member)
+void Syntax_directed_translator::push_semantic_stack(const struct semantic_stack_node & semantic_stack_node)
 {
     check_semantic_stack();
-    semantic_stack_->at(stack_top_++)=semantic_stack_node_member;
+    semantic_stack_->at(stack_top_++)=semantic_stack_node;
 }
 
 /*
@@ -86,10 +116,10 @@ void Syntax_directed_translator::push_semantic_stack(map<string,union semantic_s
 
 Parameters
 ----------
-key:要插入的键
+key:要插入的属性
 value:要插入的值
 */
-void Syntax_directed_translator::push_semantic_stack(string key,union semantic_stack_node_member value)
+void Syntax_directed_translator::push_semantic_stack(enum semantic_attribute key,union semantic_stack_node_member value)
 {
     check_semantic_stack();
     semantic_stack_->at(stack_top_++)[key]=value;
@@ -106,20 +136,31 @@ void Syntax_directed_translator::push_semantic_stack()
 
 /*
 从语义栈中弹出
+
+Parameters
+----------
+pop_num:要弹出的元素个数
 */
-void Syntax_directed_translator::pop_semantic_stack()
+void Syntax_directed_translator::pop_semantic_stack(stack_index pop_num)
 {
-    semantic_stack_->at(--stack_top_).clear();
+    while(pop_num--)
+    {
+        (*semantic_stack_)[--stack_top_].clear();
+    }
 }
 
 /*
 进行语义分析
 
+Parameters
+----------
+symbol_table:本次翻译使用的符号表
+
 Return
 ------
 返回生成的中间代码序列(用四元式表示)对应的流图
 */
-list<struct quaternion> * Syntax_directed_translator::translate()
+list<struct quaternion> * Syntax_directed_translator::translate(Symbol_table * symbol_table)
 {
     int tag=-1;
     list<struct quaternion> * intermediate_codes;
@@ -128,13 +169,18 @@ list<struct quaternion> * Syntax_directed_translator::translate()
     terminator_index input_token_code_of_kind=input_token?(terminator_index)input_token->code_of_kind:((tag==-1)?tag=grammer_->stack_bottom_symbol_:-1);
     vector<struct production * > * productions=grammer_->productions_;
     struct production * production;
+    unsigned int right_size;
     state next_state;
     semantic_rule rule;
-    map<string,union semantic_stack_node_member> new_semantic_stack_node;
-    Symbol_table * symbol_table=Symbol_table::get_instance();
+    struct semantic_stack_node new_semantic_stack_node;
+    size_t reduction_num=0;
+    //语义分析过程中的全局信息只在本次翻译中有效
+    struct semantic_global_info global_info;
 
-    //先给符号栈和状态栈赋初始值
-    state_stack_.push(0);
+    //先给符号栈和状态栈赋初始值(上一次翻译出错的时候栈中可能还有残留)
+    pop_semantic_stack(stack_top_);
+    state_stack_.clear();
+    state_stack_.push_back(0);
 
     //然后开始按照action表和goto表进行语法分析
     if(input_token_code_of_kind==-1)
@@ -145,7 +191,7 @@ list<struct quaternion> * Syntax_directed_translator::translate()
 
     while(true)
     {
-        entry=get_action_entry(state_stack_.top(),input_token_code_of_kind);
+        entry=get_packed_action_entry(state_stack_.back(),input_token_code_of_kind);
         switch(entry.movement)
         {
             case action_movement::SHIFT:
@@ -154,26 +200,26 @@ list<struct quaternion> * Syntax_directed_translator::translate()
                 switch(code_of_kind(input_token_code_of_kind))
                 {
                     case code_of_kind::ID:
-                        push_semantic_stack("id_string",{.pointer_value=(input_token->attribute_value.p_string_value)});
+                        push_semantic_stack(semantic_attribute::id_string,{.pointer_value=(strings_->get_string(input_token->attribute_value.string_id))});
                         break;
                     case code_of_kind::CONST_INT:
-                        push_semantic_stack("int_value",{.int_value=(input_token->attribute_value.int_value)});
+                        push_semantic_stack(semantic_attribute::int_value,{.int_value=(input_token->attribute_value.int_value)});
                         break;
                     case code_of_kind::CONST_FLOAT:
-                        push_semantic_stack("float_value",{.float_value=(input_token->attribute_value.float_value)});
+                        push_semantic_stack(semantic_attribute::float_value,{.float_value=(input_token->attribute_value.float_value)});
                         break;
                     case code_of_kind::CONST_CHAR:
-                        push_semantic_stack("char_value",{.char_value=(input_token->attribute_value.char_value)});
+                        push_semantic_stack(semantic_attribute::char_value,{.char_value=(input_token->attribute_value.char_value)});
                         break;
                     case code_of_kind::CONST_STRING:
-                        push_semantic_stack("string_value",{.pointer_value=(input_token->attribute_value.p_string_value)});
+                        push_semantic_stack(semantic_attribute::string_value,{.pointer_value=(strings_->get_string(input_token->attribute_value.string_id))});
                         break;
                     default:
                         push_semantic_stack();
                         break;
                 }
 
-                state_stack_.push(entry.index);
+                state_stack_.push_back(entry.index);
                 input_token=next_token();
                 input_token_code_of_kind=input_token?(terminator_index)input_token->code_of_kind:((tag==-1)?tag=grammer_->stack_bottom_symbol_:-1);
                 if(input_token_code_of_kind==-1)
@@ -185,35 +231,28 @@ list<struct quaternion> * Syntax_directed_translator::translate()
             case action_movement::REDUCE:
             //cout<<"REDUCE:"<<endl;
                 production=productions->at(entry.index);
+                reduction_num++;
             //cout<<production->production_string<<endl;
                 //执行语义动作
                 rule=grammer_->production_semantic_rule_.at(entry.index);
+                new_semantic_stack_node.clear();
                 if(rule)
                 {
                     check_semantic_stack();
-                    new_semantic_stack_node=rule(intermediate_codes,semantic_stack_,stack_top_,symbol_table);
-                }
-                else
-                {
-                    new_semantic_stack_node.clear();
+                    rule(&grammer_->production_semantic_rule_descriptors_.at(entry.index),intermediate_codes,semantic_stack_,stack_top_,symbol_table,&global_info,&new_semantic_stack_node);
                 }
 
-                for(vector<syntax_symbol_index>::iterator i=production->right.begin();i!=production->right.end();i++)
-                {
-                    if((*i)!=grammer_->empty_symbol_)
-                    {
-                        pop_semantic_stack();
-                        state_stack_.pop();
-                    }
-                }
+                right_size=production_right_sizes_[entry.index];
+                pop_semantic_stack(right_size);
+                state_stack_.resize(state_stack_.size()-right_size);
 
                 push_semantic_stack(new_semantic_stack_node);
 
-                next_state=get_goto_entry(state_stack_.top(),production->left);
+                next_state=get_packed_goto_entry(state_stack_.back(),production->left);
                 
                 if(next_state!=-1)
                 {
-                    state_stack_.push(next_state);
+                    state_stack_.push_back(next_state);
                 }
                 else
                 {
@@ -224,11 +263,12 @@ list<struct quaternion> * Syntax_directed_translator::translate()
             case action_movement::ACCEPT:
             //cout<<"ACCEPT: ";
             //cout<<intermediate_codes->size()<<endl;
+                Time_report::add_counter("reductions",reduction_num);
                 return intermediate_codes;
             case action_movement::ERROR:
             //cout<<"ERROR"<<endl;
             //cout<<input_token_code_of_kind<<endl;
-            //cout<<state_stack_.top()<<endl;
+            //cout<<state_stack_.back()<<endl;
                 delete intermediate_codes;
                 return nullptr;
         }
@@ -243,18 +283,19 @@ list<struct quaternion> * Syntax_directed_translator::translate()
 Parameters
 ----------
 filename:要进行中间代码输出的文件
+symbol_table:本次翻译使用的符号表
 
 Return
 ------
 返回生成的中间代码序列(用四元式表示)对应的流图
 */
-list<struct quaternion> * Syntax_directed_translator::translate_then_output(const char * filename)
+list<struct quaternion> * Syntax_directed_translator::translate_then_output(const char * filename,Symbol_table * symbol_table)
 {
 	ofstream outFile;
     list<struct quaternion> * res;
     
     //进行语义翻译
-    res=translate();
+    res=translate(symbol_table);
     
     if(res)
     {
@@ -0,0 +1,182 @@
+/*
+ *
+ *  thread_pool.cpp
+ *  并行执行任务的工具
+ *  Creator:Sichao Chen
+ *  Create time:2026/10/18
+ *
+*/
+#include "thread_pool.h"
+#include<thread>
+#include<atomic>
+#include<vector>
+
+//当前线程的输出要写到的字符串
+thread_local string * Thread_output_buf::thread_output_=nullptr;
+
+/*
+工作线程不断地领取下一个还没有执行的任务，直到所有的任务都被领取完
+
+Parameters
+----------
+next_task:下一个还没有被领取的任务的编号
+task_num:任务的个数
+task:要执行的任务
+data:所有任务共享的数据
+*/
+static void parallel_worker(atomic<size_t> * next_task,size_t task_num,parallel_task task,void * data)
+{
+    size_t index;
+
+    while((index=next_task->fetch_add(1))<task_num)
+    {
+        task(index,data);
+    }
+}
+
+/*
+用多个线程并行执行一组任务，所有任务都执行完成之后才返回
+任务是按照编号从小到大被领取的，但是完成的顺序是不确定的
+
+Parameters
+----------
+task_num:任务的个数
+thread_num:线程的个数
+task:要执行的任务
+data:所有任务共享的数据
+*/
+void parallel_for(size_t task_num,size_t thread_num,parallel_task task,void * data)
+{
+    atomic<size_t> next_task(0);
+    vector<thread> workers;
+
+    if(thread_num>task_num)
+    {
+        thread_num=task_num;
+    }
+    if(thread_num<=1)
+    {
+        parallel_worker(&next_task,task_num,task,data);
+        return;
+    }
+
+    //当前线程也作为一个工作线程
+    for(size_t i=1;i<thread_num;i++)
+    {
+        workers.push_back(thread(parallel_worker,&next_task,task_num,task,data));
+    }
+    parallel_worker(&next_task,task_num,task,data);
+    for(auto & i:workers)
+    {
+        i.join();
+    }
+}
+
+/*
+获取机器上可以同时运行的线程个数
+
+Return
+------
+可以同时运行的线程个数(获取不到的时候返回1)
+*/
+size_t get_hardware_thread_num()
+{
+    size_t res=thread::hardware_concurrency();
+    return res?res:1;
+}
+
+/*
+构造函数
+
+Parameters
+----------
+default_buf:没有重定向的线程的输出所写到的缓冲区
+*/
+Thread_output_buf::Thread_output_buf(streambuf * default_buf):default_buf_(default_buf)
+{
+    //不使用streambuf自己的写缓冲区，这样每一次写入都会调用overflow或者xsputn，从而可以按照线程进行分发
+    setp(nullptr,nullptr);
+}
+
+/*
+析构函数
+*/
+Thread_output_buf::~Thread_output_buf()
+{
+
+}
+
+/*
+把当前线程的输出重定向到一个字符串中
+
+Parameters
+----------
+output:要写到的字符串，为nullptr表示恢复写到原来的缓冲区中
+*/
+void Thread_output_buf::redirect(string * output)
+{
+    thread_output_=output;
+}
+
+/*
+写入一个字符
+
+Parameters
+----------
+ch:要写入的字符
+
+Return
+------
+成功返回写入的字符，否则返回EOF
+*/
+int Thread_output_buf::overflow(int ch)
+{
+    if(ch==traits_type::eof())
+    {
+        return traits_type::not_eof(ch);
+    }
+    if(thread_output_)
+    {
+        thread_output_->push_back((char)ch);
+        return ch;
+    }
+    return default_buf_->sputc((char)ch);
+}
+
+/*
+写入一个字符串
+
+Parameters
+----------
+s:要写入的字符串
+n:要写入的字符个数
+
+Return
+------
+实际写入的字符个数
+*/
+streamsize Thread_output_buf::xsputn(const char * s,streamsize n)
+{
+    if(thread_output_)
+    {
+        thread_output_->append(s,n);
+        return n;
+    }
+    return default_buf_->sputn(s,n);
+}
+
+/*
+刷新缓冲区
+
+Return
+------
+成功返回0，否则返回-1
+*/
+int Thread_output_buf::sync()
+{
+    if(thread_output_)
+    {
+        return 0;
+    }
+    return default_buf_->pubsync();
+}
@@ -0,0 +1,327 @@
+/*
+ *
+ *  time_report.cpp
+ *  编译各个阶段的耗时、内存和计数统计
+ *  Creator:Sichao Chen
+ *  Create time:2026/10/18
+ *
+*/
+#include "time_report.h"
+#include<fstream>
+#include<iomanip>
+#include<stdio.h>
+#include<time.h>
+#include<sys/resource.h>
+
+//当前线程正在记录的报告
+thread_local Time_report * Time_report::current_=nullptr;
+
+/*
+获取进程到目前为止使用的CPU时间(包括所有线程)
+
+Return
+------
+CPU时间(秒)
+*/
+static double get_cpu_seconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID,&ts);
+    return ts.tv_sec+ts.tv_nsec/1e9;
+}
+
+/*
+获取进程到目前为止的内存峰值
+
+Return
+------
+内存峰值(KB)
+*/
+static long get_peak_rss_kb()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF,&usage);
+    return usage.ru_maxrss;
+}
+
+/*
+把字符串转换成JSON中的字符串
+
+Parameters
+----------
+str:要转换的字符串
+
+Return
+------
+加上引号并转义之后的字符串
+*/
+static string to_json_string(const string & str)
+{
+    string res="\"";
+    char buf[8];
+
+    for(auto ch:str)
+    {
+        switch(ch)
+        {
+            case '"':
+                res+="\\\"";
+                break;
+            case '\\':
+                res+="\\\\";
+                break;
+            case '\n':
+                res+="\\n";
+                break;
+            case '\t':
+                res+="\\t";
+                break;
+            default:
+                if((unsigned char)ch<0x20)
+                {
+                    snprintf(buf,sizeof(buf),"\\u%04x",ch);
+                    res+=buf;
+                }
+                else
+                {
+                    res.push_back(ch);
+                }
+                break;
+        }
+    }
+    res.push_back('"');
+    return res;
+}
+
+/*
+构造函数，整个报告从此时开始计时
+*/
+Time_report::Time_report():total_("total",0)
+{
+    total_.wall_start=chrono::steady_clock::now();
+    total_.cpu_start=get_cpu_seconds();
+}
+
+/*
+析构函数
+*/
+Time_report::~Time_report()
+{
+    if(current_==this)
+    {
+        current_=nullptr;
+    }
+}
+
+/*
+把当前线程的统计记录到一个报告中
+
+Parameters
+----------
+report:要记录到的报告，为nullptr表示不再记录
+*/
+void Time_report::install(Time_report * report)
+{
+    current_=report;
+}
+
+/*
+获取当前线程正在记录的报告
+
+Return
+------
+当前线程正在记录的报告，没有的时候返回nullptr
+*/
+Time_report * Time_report::get_current()
+{
+    return current_;
+}
+
+/*
+开始一个阶段
+
+Parameters
+----------
+name:阶段名
+*/
+void Time_report::begin_stage(const char * name)
+{
+    Time_report * report=current_;
+
+    if(!report)
+    {
+        return;
+    }
+    report->open_stages_.push_back(report->stages_.size());
+    report->stages_.push_back(time_report_stage(name,report->open_stages_.size()-1));
+    report->stages_.back().cpu_start=get_cpu_seconds();
+    report->stages_.back().wall_start=chrono::steady_clock::now();
+}
+
+/*
+结束一个阶段
+
+Parameters
+----------
+stage:要结束的阶段
+*/
+void Time_report::end_stage(struct time_report_stage & stage)
+{
+    stage.wall_seconds=chrono::duration<double>(chrono::steady_clock::now()-stage.wall_start).count();
+    stage.cpu_seconds=get_cpu_seconds()-stage.cpu_start;
+    stage.peak_rss_kb=get_peak_rss_kb();
+    stage.is_done=true;
+}
+
+/*
+结束最近开始的阶段
+*/
+void Time_report::end_stage()
+{
+    Time_report * report=current_;
+
+    if(!report || report->open_stages_.empty())
+    {
+        return;
+    }
+    report->end_stage(report->stages_[report->open_stages_.back()]);
+    report->open_stages_.pop_back();
+}
+
+/*
+给计数器加上一个值，计数器不存在的时候新建一个
+
+Parameters
+----------
+name:计数器名
+value:要加上的值
+*/
+void Time_report::add_counter(const char * name,size_t value)
+{
+    Time_report * report=current_;
+
+    if(!report)
+    {
+        return;
+    }
+    //计数器只有十几个，直接顺序查找
+    for(auto & i:report->counters_)
+    {
+        if(i.first==name)
+        {
+            i.second+=value;
+            return;
+        }
+    }
+    report->counters_.push_back(make_pair(string(name),value));
+}
+
+/*
+把另一个报告的计数器加到这个报告中
+并行生成汇编代码的时候每一个线程都记录到自己的报告中，最后再合并到一起
+
+Parameters
+----------
+other:要合并的报告
+*/
+void Time_report::merge_counters(const Time_report & other)
+{
+    Time_report * old_report=current_;
+
+    current_=this;
+    for(auto & i:other.counters_)
+    {
+        add_counter(i.first.c_str(),i.second);
+    }
+    current_=old_report;
+}
+
+/*
+结束所有的阶段和整个报告
+编译出错提前返回的时候可能还有没有结束的阶段
+*/
+void Time_report::finish()
+{
+    while(!open_stages_.empty())
+    {
+        end_stage(stages_[open_stages_.back()]);
+        open_stages_.pop_back();
+    }
+    if(!total_.is_done)
+    {
+        end_stage(total_);
+    }
+}
+
+/*
+以表格的形式输出
+
+Parameters
+----------
+out:输出流
+*/
+void Time_report::output_table(ostream & out) const
+{
+    ios::fmtflags flags=out.flags();
+    streamsize precision=out.precision();
+
+    out<<left<<setw(48)<<"stage"<<right<<setw(12)<<"wall(ms)"<<setw(12)<<"cpu(ms)"<<setw(16)<<"peak rss(KB)"<<endl;
+    out<<fixed<<setprecision(3);
+    for(auto & i:stages_)
+    {
+        out<<left<<setw(48)<<(string(i.depth*2,' ')+i.name)<<right<<setw(12)<<i.wall_seconds*1000<<setw(12)<<i.cpu_seconds*1000<<setw(16)<<i.peak_rss_kb<<endl;
+    }
+    out<<left<<setw(48)<<total_.name<<right<<setw(12)<<total_.wall_seconds*1000<<setw(12)<<total_.cpu_seconds*1000<<setw(16)<<total_.peak_rss_kb<<endl;
+    out<<endl;
+    out<<left<<setw(48)<<"counter"<<right<<setw(12)<<"value"<<endl;
+    for(auto & i:counters_)
+    {
+        out<<left<<setw(48)<<i.first<<right<<setw(12)<<i.second<<endl;
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+/*
+以JSON的形式输出到文件中
+
+Parameters
+----------
+filename:要输出的文件名
+source_program_filename:源程序文件名
+
+Return
+------
+成功返回true，否则返回false
+*/
+bool Time_report::output_json(const char * filename,string source_program_filename) const
+{
+    ofstream outFile;
+
+    outFile.open(filename,ios::out);
+    if(!outFile)
+    {
+        cout<<"Open file "<<filename<<" error!"<<endl;
+        return false;
+    }
+    outFile<<fixed<<setprecision(3);
+    outFile<<"{"<<endl;
+    outFile<<"  \"source\": "<<to_json_string(source_program_filename)<<","<<endl;
+    outFile<<"  \"total\": {\"wall_ms\": "<<total_.wall_seconds*1000<<", \"cpu_ms\": "<<total_.cpu_seconds*1000<<", \"peak_rss_kb\": "<<total_.peak_rss_kb<<"},"<<endl;
+    outFile<<"  \"stages\": ["<<endl;
+    for(size_t i=0;i<stages_.size();i++)
+    {
+        outFile<<"    {\"name\": "<<to_json_string(stages_[i].name)<<", \"depth\": "<<stages_[i].depth<<", \"wall_ms\": "<<stages_[i].wall_seconds*1000<<", \"cpu_ms\": "<<stages_[i].cpu_seconds*1000<<", \"peak_rss_kb\": "<<stages_[i].peak_rss_kb<<"}"<<(i+1<stages_.size()?",":"")<<endl;
+    }
+    outFile<<"  ],"<<endl;
+    outFile<<"  \"counters\": {"<<endl;
+    for(size_t i=0;i<counters_.size();i++)
+    {
+        outFile<<"    "<<to_json_string(counters_[i].first)<<": "<<counters_[i].second<<(i+1<counters_.size()?",":"")<<endl;
+    }
+    outFile<<"  }"<<endl;
+    outFile<<"}"<<endl;
+    outFile.close();
+
+    return true;
+}